@@ -0,0 +1,721 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     analyze.c
+   \brief    Functions to gather statistics of a collection of midi files
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "midi.h"
+#include "midi_event.h"
+#include "sound.h"
+#include "analyze.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define ANALYZE_DEFAULT_TEMPO_US (500000) //120 beats per minute
+
+#define ANALYZE_ERROR_LOAD       (-1)
+#define ANALYZE_ERROR_DATA       (-2)
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   char * pc_File;
+   int32_t s32_Error;                     //0, ANALYZE_ERROR_LOAD or ANALYZE_ERROR_DATA
+   uint16_t u16_FormatType;
+   uint16_t u16_NumOfTracks;
+   T_midi_event_statistic t_Statistic;    //all tracks (max. polyphony: notes of all tracks sounding at the same time)
+   uint32_t u32_Duration1ms;
+   uint32_t u32_TableSize1By;             //upper bound of the largest signal table (table format)
+   uint8_t u8_Fits;                       //table fits into flash budget
+} T_analyze_result;
+
+
+typedef struct
+{
+   uint32_t u32_NumOfFiles;
+   uint32_t u32_NumOfErrors;
+   uint32_t u32_NumOfFits;
+   T_midi_event_statistic t_Statistic;
+   uint64_t u64_Duration1ms;
+   uint32_t u32_MaxDuration1ms;
+} T_analyze_summary;
+
+
+typedef struct
+{
+   T_analyze_result * pat_Result;
+   uint32_t u32_NumOfFiles;
+   uint32_t u32_MaxFiles;
+   uint32_t u32_NextFile;                 //next file to be analyzed (shared by all threads)
+   uint32_t u32_FlashBudget1By;
+   uint32_t u32_NumOfThreads;
+   T_analyze_summary t_Summary;
+} T_analyze_instance;
+
+
+typedef struct
+{
+   pthread_t t_Thread;
+   T_analyze_instance * pt_AnalyzeInstance;
+   T_analyze_summary t_Summary;           //accumulator of this thread
+} T_analyze_worker;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+static const char * const mapcn_EventName[8] =
+{
+   "note_off",
+   "note_on",
+   "key_aftertouch",
+   "control_change",
+   "program_change",
+   "channel_aftertouch",
+   "pitch_wheel",
+   "meta_sysex"
+};
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void scan_directory(T_analyze_instance * const opt_AnalyzeInstance, const char * const opc_Directory);
+static int compare_result_file(const void * opv_A, const void * opv_B);
+static void * worker(void * opv_Worker);
+static void analyze_file(T_analyze_result * const opt_Result, const uint32_t ou32_FlashBudget1By);
+static uint32_t get_duration_ms(const uint16_t ou16_TimeDivision, const uint32_t ou32_DurationTicks, T_midi_event_tempo * const opat_Tempo, const uint32_t ou32_NumOfTempos);
+static int compare_tempo_tick(const void * opv_A, const void * opv_B);
+static uint16_t get_max_polyphony(T_midi_event_polyphony * const opat_Polyphony, const uint32_t ou32_NumOfChanges);
+static int compare_polyphony_tick(const void * opv_A, const void * opv_B);
+static void merge_statistic(T_midi_event_statistic * const opt_Target, const T_midi_event_statistic * const opt_Source);
+static void merge_summary(T_analyze_summary * const opt_Target, const T_analyze_summary * const opt_Source);
+static void write_json_string(FILE * const opv_File, const char * opc_String);
+static void write_json_statistic(FILE * const opv_File, const T_midi_event_statistic * const opt_Statistic);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_ANALYZE_HANDLE analyze_open(const char * const opc_Directory, const uint32_t ou32_NumOfThreads, const uint32_t ou32_FlashBudget1By)
+{
+   T_analyze_instance * pt_AnalyzeInstance;
+   T_analyze_worker * pt_Worker;
+   uint32_t u32_Thread;
+   uint32_t u32_NumOfStarted;
+
+   //------------------------------------------------------------//
+   // allocate analyze instance                                  //
+   //------------------------------------------------------------//
+   pt_AnalyzeInstance = calloc(1, sizeof(T_analyze_instance));
+   pt_AnalyzeInstance->u32_FlashBudget1By = ou32_FlashBudget1By;
+   pt_AnalyzeInstance->t_Summary.t_Statistic.u8_MinNote = 0x7F;
+
+   //------------------------------------------------------------//
+   // collect midi files (sorted, so the output is deterministic)//
+   //------------------------------------------------------------//
+   scan_directory(pt_AnalyzeInstance, opc_Directory);
+   qsort(pt_AnalyzeInstance->pat_Result, pt_AnalyzeInstance->u32_NumOfFiles, sizeof(T_analyze_result), compare_result_file);
+
+   //------------------------------------------------------------//
+   // analyze files in parallel                                  //
+   //------------------------------------------------------------//
+   pt_AnalyzeInstance->u32_NumOfThreads = ou32_NumOfThreads;
+   if (pt_AnalyzeInstance->u32_NumOfThreads == 0)
+   {
+      const long s32_Cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+      pt_AnalyzeInstance->u32_NumOfThreads = ((s32_Cpus > 0) ? (uint32_t)s32_Cpus : 1);
+   }
+   pt_Worker = calloc(pt_AnalyzeInstance->u32_NumOfThreads, sizeof(T_analyze_worker));
+   for (u32_Thread = 0; u32_Thread < pt_AnalyzeInstance->u32_NumOfThreads; ++u32_Thread)
+   {
+      pt_Worker[u32_Thread].pt_AnalyzeInstance = pt_AnalyzeInstance;
+      pt_Worker[u32_Thread].t_Summary.t_Statistic.u8_MinNote = 0x7F;
+      if (pthread_create(&pt_Worker[u32_Thread].t_Thread, NULL, worker, &pt_Worker[u32_Thread]) != 0)
+      {
+         printf("[W] Cannot start analyze thread %d!\n", u32_Thread);
+         break;
+      }
+   }
+   //the threads already started take the remaining files (none started -> this thread)
+   u32_NumOfStarted = u32_Thread;
+   if (u32_NumOfStarted == 0)
+   {
+      worker(&pt_Worker[0]);
+   }
+   pt_AnalyzeInstance->u32_NumOfThreads = ((u32_NumOfStarted > 0) ? u32_NumOfStarted : 1);
+   //merge accumulators of all threads
+   for (u32_Thread = 0; u32_Thread < pt_AnalyzeInstance->u32_NumOfThreads; ++u32_Thread)
+   {
+      if (u32_Thread < u32_NumOfStarted)
+      {
+         pthread_join(pt_Worker[u32_Thread].t_Thread, NULL);
+      }
+      merge_summary(&pt_AnalyzeInstance->t_Summary, &pt_Worker[u32_Thread].t_Summary);
+   }
+   free(pt_Worker);
+   if (pt_AnalyzeInstance->t_Summary.t_Statistic.u32_NumOfNotes == 0)
+   {
+      pt_AnalyzeInstance->t_Summary.t_Statistic.u8_MinNote = 0;
+   }
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return analyze instance handle
+   return pt_AnalyzeInstance;
+}
+
+
+void analyze_close(T_ANALYZE_HANDLE opv_Handle)
+{
+   T_analyze_instance * const pt_AnalyzeInstance = (T_analyze_instance *)opv_Handle;
+   uint32_t u32_File;
+
+   //release results and instance itself
+   for (u32_File = 0; u32_File < pt_AnalyzeInstance->u32_NumOfFiles; ++u32_File)
+   {
+      free(pt_AnalyzeInstance->pat_Result[u32_File].pc_File);
+   }
+   free(pt_AnalyzeInstance->pat_Result);
+   free(pt_AnalyzeInstance);
+}
+
+
+void analyze_print_summary(T_ANALYZE_HANDLE opv_Handle)
+{
+   T_analyze_instance * const pt_AnalyzeInstance = (T_analyze_instance *)opv_Handle;
+   const T_analyze_summary * const pt_Summary = &pt_AnalyzeInstance->t_Summary;
+   uint32_t u32_Event;
+
+   printf("Analysis (%d threads)\n", pt_AnalyzeInstance->u32_NumOfThreads);
+   printf("\tFiles: %d\n", pt_Summary->u32_NumOfFiles);
+   printf("\tErrors: %d\n", pt_Summary->u32_NumOfErrors);
+   if (pt_AnalyzeInstance->u32_FlashBudget1By > 0)
+   {
+      printf("\tFit into %d bytes: %d\n", pt_AnalyzeInstance->u32_FlashBudget1By, pt_Summary->u32_NumOfFits);
+   }
+   printf("\tNotes: %d (range %d..%d)\n", pt_Summary->t_Statistic.u32_NumOfNotes, pt_Summary->t_Statistic.u8_MinNote, pt_Summary->t_Statistic.u8_MaxNote);
+   printf("\tMax. Polyphony: %d\n", pt_Summary->t_Statistic.u16_MaxPolyphony);
+   printf("\tTempo: %d..%d us per beat\n", pt_Summary->t_Statistic.u32_MinTempoUs, pt_Summary->t_Statistic.u32_MaxTempoUs);
+   printf("\tDuration: %llu ms total, %d ms max.\n", (unsigned long long)pt_Summary->u64_Duration1ms, pt_Summary->u32_MaxDuration1ms);
+   for (u32_Event = 0; u32_Event < 8; ++u32_Event)
+   {
+      printf("\t%s: %d\n", mapcn_EventName[u32_Event], pt_Summary->t_Statistic.au32_NumOfEvents[u32_Event]);
+   }
+}
+
+
+void analyze_write_csv(const char * const opc_File, T_ANALYZE_HANDLE opv_Handle)
+{
+   T_analyze_instance * const pt_AnalyzeInstance = (T_analyze_instance *)opv_Handle;
+   FILE * pv_File;
+   uint32_t u32_File;
+   uint32_t u32_Event;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = ((opc_File != NULL) ? fopen(opc_File, "w") : stdout);
+
+   //------------------------------------------------------------//
+   // write to file (one line per midi file)                     //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "file,error,format,tracks,notes,min_note,max_note,max_polyphony,tempo_changes,min_tempo_us,max_tempo_us,duration_ms");
+   for (u32_Event = 0; u32_Event < 8; ++u32_Event)
+   {
+      fprintf(pv_File, ",%s", mapcn_EventName[u32_Event]);
+   }
+   fprintf(pv_File, ",table_bytes,fits\n");
+   for (u32_File = 0; u32_File < pt_AnalyzeInstance->u32_NumOfFiles; ++u32_File)
+   {
+      const T_analyze_result * const pt_Result = &pt_AnalyzeInstance->pat_Result[u32_File];
+      const T_midi_event_statistic * const pt_Statistic = &pt_Result->t_Statistic;
+      const char * pc_Char;
+
+      //file name quoted, quotes doubled
+      fprintf(pv_File, "\"");
+      for (pc_Char = pt_Result->pc_File; *pc_Char != 0; ++pc_Char)
+      {
+         fprintf(pv_File, ((*pc_Char == '"') ? "\"\"" : "%c"), *pc_Char);
+      }
+      fprintf(pv_File, "\",%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d", pt_Result->s32_Error, pt_Result->u16_FormatType, pt_Result->u16_NumOfTracks,
+              pt_Statistic->u32_NumOfNotes, pt_Statistic->u8_MinNote, pt_Statistic->u8_MaxNote, pt_Statistic->u16_MaxPolyphony,
+              pt_Statistic->u32_NumOfTempos, pt_Statistic->u32_MinTempoUs, pt_Statistic->u32_MaxTempoUs, pt_Result->u32_Duration1ms);
+      for (u32_Event = 0; u32_Event < 8; ++u32_Event)
+      {
+         fprintf(pv_File, ",%d", pt_Statistic->au32_NumOfEvents[u32_Event]);
+      }
+      fprintf(pv_File, ",%d,%d\n", pt_Result->u32_TableSize1By, pt_Result->u8_Fits);
+   }
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   if (opc_File != NULL)
+   {
+      fclose(pv_File);
+   }
+}
+
+
+void analyze_write_json(const char * const opc_File, T_ANALYZE_HANDLE opv_Handle)
+{
+   T_analyze_instance * const pt_AnalyzeInstance = (T_analyze_instance *)opv_Handle;
+   const T_analyze_summary * const pt_Summary = &pt_AnalyzeInstance->t_Summary;
+   FILE * pv_File;
+   uint32_t u32_File;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = ((opc_File != NULL) ? fopen(opc_File, "w") : stdout);
+
+   //------------------------------------------------------------//
+   // write to file                                              //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "{\n  \"summary\": {\"files\": %d, \"errors\": %d, \"flash_budget\": %d, \"fits\": %d, \"duration_ms\": %llu, \"max_duration_ms\": %d, ",
+           pt_Summary->u32_NumOfFiles, pt_Summary->u32_NumOfErrors, pt_AnalyzeInstance->u32_FlashBudget1By, pt_Summary->u32_NumOfFits,
+           (unsigned long long)pt_Summary->u64_Duration1ms, pt_Summary->u32_MaxDuration1ms);
+   write_json_statistic(pv_File, &pt_Summary->t_Statistic);
+   fprintf(pv_File, "},\n  \"files\": [\n");
+   for (u32_File = 0; u32_File < pt_AnalyzeInstance->u32_NumOfFiles; ++u32_File)
+   {
+      const T_analyze_result * const pt_Result = &pt_AnalyzeInstance->pat_Result[u32_File];
+
+      fprintf(pv_File, "    {\"file\": ");
+      write_json_string(pv_File, pt_Result->pc_File);
+      fprintf(pv_File, ", \"error\": %d, \"format\": %d, \"tracks\": %d, \"duration_ms\": %d, \"table_bytes\": %d, \"fits\": %s, ",
+              pt_Result->s32_Error, pt_Result->u16_FormatType, pt_Result->u16_NumOfTracks, pt_Result->u32_Duration1ms,
+              pt_Result->u32_TableSize1By, ((pt_Result->u8_Fits != 0) ? "true" : "false"));
+      write_json_statistic(pv_File, &pt_Result->t_Statistic);
+      fprintf(pv_File, "}%s\n", (((u32_File + 1) < pt_AnalyzeInstance->u32_NumOfFiles) ? "," : ""));
+   }
+   fprintf(pv_File, "  ]\n}\n");
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   if (opc_File != NULL)
+   {
+      fclose(pv_File);
+   }
+}
+
+
+
+
+
+
+
+
+
+static void scan_directory(T_analyze_instance * const opt_AnalyzeInstance, const char * const opc_Directory)
+{
+   DIR * pv_Directory;
+   struct dirent * pt_Entry;
+
+   pv_Directory = opendir(opc_Directory);
+   if (pv_Directory == NULL)
+   {
+      printf("cannot open directory %s\n", opc_Directory);
+      return;
+   }
+
+   while ((pt_Entry = readdir(pv_Directory)) != NULL)
+   {
+      struct stat t_Stat;
+      const char * pc_Extension;
+      char * pc_Path;
+      size_t u32_Length;
+
+      if ((strcmp(pt_Entry->d_name, ".") == 0) || (strcmp(pt_Entry->d_name, "..") == 0))
+      {
+         continue;
+      }
+      u32_Length = strlen(opc_Directory) + strlen(pt_Entry->d_name) + 2;
+      pc_Path = malloc(u32_Length);
+      snprintf(pc_Path, u32_Length, "%s/%s", opc_Directory, pt_Entry->d_name);
+      //symbolic links are not followed (neither directory nor regular file -> skipped), a link loop would recurse forever
+      if (lstat(pc_Path, &t_Stat) < 0)
+      {
+         free(pc_Path);
+         continue;
+      }
+
+      //sub directory
+      if (S_ISDIR(t_Stat.st_mode))
+      {
+         scan_directory(opt_AnalyzeInstance, pc_Path);
+         free(pc_Path);
+         continue;
+      }
+
+      //midi file (*.mid, *.midi)
+      pc_Extension = strrchr(pt_Entry->d_name, '.');
+      if ((!S_ISREG(t_Stat.st_mode)) || (pc_Extension == NULL) || ((strcasecmp(pc_Extension, ".mid") != 0) && (strcasecmp(pc_Extension, ".midi") != 0)))
+      {
+         free(pc_Path);
+         continue;
+      }
+      if (opt_AnalyzeInstance->u32_NumOfFiles >= opt_AnalyzeInstance->u32_MaxFiles)
+      {
+         opt_AnalyzeInstance->u32_MaxFiles = ((opt_AnalyzeInstance->u32_MaxFiles > 0) ? (2 * opt_AnalyzeInstance->u32_MaxFiles) : 256);
+         opt_AnalyzeInstance->pat_Result = realloc(opt_AnalyzeInstance->pat_Result, opt_AnalyzeInstance->u32_MaxFiles * sizeof(T_analyze_result));
+      }
+      memset(&opt_AnalyzeInstance->pat_Result[opt_AnalyzeInstance->u32_NumOfFiles], 0, sizeof(T_analyze_result));
+      opt_AnalyzeInstance->pat_Result[opt_AnalyzeInstance->u32_NumOfFiles++].pc_File = pc_Path;
+   }
+   closedir(pv_Directory);
+}
+
+
+static int compare_result_file(const void * opv_A, const void * opv_B)
+{
+   return strcmp(((const T_analyze_result *)opv_A)->pc_File, ((const T_analyze_result *)opv_B)->pc_File);
+}
+
+
+/*
+   Each thread takes the next file, that is not yet analyzed. The result of a file is
+   written by that thread only; the summary is accumulated per thread and merged at the end.
+*/
+static void * worker(void * opv_Worker)
+{
+   T_analyze_worker * const pt_Worker = (T_analyze_worker *)opv_Worker;
+   T_analyze_instance * const pt_AnalyzeInstance = pt_Worker->pt_AnalyzeInstance;
+   T_analyze_summary * const pt_Summary = &pt_Worker->t_Summary;
+
+   for (;;)
+   {
+      const uint32_t u32_File = __atomic_fetch_add(&pt_AnalyzeInstance->u32_NextFile, 1, __ATOMIC_RELAXED);
+      T_analyze_result * pt_Result;
+
+      if (u32_File >= pt_AnalyzeInstance->u32_NumOfFiles)
+      {
+         break;
+      }
+      pt_Result = &pt_AnalyzeInstance->pat_Result[u32_File];
+      analyze_file(pt_Result, pt_AnalyzeInstance->u32_FlashBudget1By);
+
+      //accumulate
+      ++pt_Summary->u32_NumOfFiles;
+      if (pt_Result->s32_Error != 0)
+      {
+         ++pt_Summary->u32_NumOfErrors;
+      }
+      if (pt_Result->u8_Fits != 0)
+      {
+         ++pt_Summary->u32_NumOfFits;
+      }
+      merge_statistic(&pt_Summary->t_Statistic, &pt_Result->t_Statistic);
+      pt_Summary->u64_Duration1ms += pt_Result->u32_Duration1ms;
+      if (pt_Result->u32_Duration1ms > pt_Summary->u32_MaxDuration1ms)
+      {
+         pt_Summary->u32_MaxDuration1ms = pt_Result->u32_Duration1ms;
+      }
+   }
+   return NULL;
+}
+
+
+/*
+   The tempo changes and the polyphony changes of all tracks are collected, the buffers grow
+   with each track to the number of events, that fit into its chunk (no change is dropped).
+*/
+static void analyze_file(T_analyze_result * const opt_Result, const uint32_t ou32_FlashBudget1By)
+{
+   T_midi_event_tempo * pat_Tempo;
+   T_midi_event_polyphony * pat_Polyphony;
+   T_midi_header_chunk t_HeaderChunk;
+   T_midi_track_chunk t_TrackChunk;
+   T_MIDI_HANDLE pv_Midi;
+   uint32_t u32_NumOfTempos;
+   uint32_t u32_NumOfChanges;
+   uint32_t u32_Track;
+   uint16_t u16_MaxPolyphony;
+
+   opt_Result->t_Statistic.u8_MinNote = 0x7F;
+   pv_Midi = midi_open(opt_Result->pc_File);
+   if (pv_Midi == 0)
+   {
+      opt_Result->s32_Error = ANALYZE_ERROR_LOAD;
+      opt_Result->t_Statistic.u8_MinNote = 0;
+      return;
+   }
+   midi_get_header_chunk(pv_Midi, &t_HeaderChunk);
+   opt_Result->u16_FormatType = t_HeaderChunk.u16_FormatType;
+   opt_Result->u16_NumOfTracks = t_HeaderChunk.u16_NumOfTracks;
+
+   //for each track
+   pat_Tempo = NULL;
+   pat_Polyphony = NULL;
+   u32_NumOfTempos = 0;
+   u32_NumOfChanges = 0;
+   for (u32_Track = 0; u32_Track < t_HeaderChunk.u16_NumOfTracks; ++u32_Track)
+   {
+      T_midi_event_statistic t_Statistic;
+      T_MIDI_EVENT_HANDLE pv_MidiEvent;
+      T_midi_event_tempo * pt_Tempo;
+      T_midi_event_polyphony * pt_Polyphony;
+      uint32_t u32_MaxTempos;
+      uint32_t u32_MaxChanges;
+      uint32_t u32_TableSize1By;
+      int32_t s32_NumOfChanges;
+
+      if (midi_get_track_chunk(pv_Midi, u32_Track, &t_TrackChunk) < 0)
+      {
+         opt_Result->s32_Error = ANALYZE_ERROR_DATA;
+         break;
+      }
+
+      //a tempo event takes at least 7 bytes, a note event at least 3 bytes (running status)
+      u32_MaxTempos = (t_TrackChunk.u32_ChunkSize / 7) + 1;
+      u32_MaxChanges = (t_TrackChunk.u32_ChunkSize / 3) + 1;
+      pt_Tempo = realloc(pat_Tempo, (u32_NumOfTempos + u32_MaxTempos) * sizeof(T_midi_event_tempo));
+      pat_Tempo = ((pt_Tempo != NULL) ? pt_Tempo : pat_Tempo);
+      pt_Polyphony = realloc(pat_Polyphony, (u32_NumOfChanges + u32_MaxChanges) * sizeof(T_midi_event_polyphony));
+      pat_Polyphony = ((pt_Polyphony != NULL) ? pt_Polyphony : pat_Polyphony);
+      if ((pt_Tempo == NULL) || (pt_Polyphony == NULL))
+      {
+         opt_Result->s32_Error = ANALYZE_ERROR_LOAD;
+         break;
+      }
+
+      pv_MidiEvent = midi_event_open(&t_TrackChunk);
+      s32_NumOfChanges = midi_event_get_statistic(pv_MidiEvent, &t_Statistic, &pat_Tempo[u32_NumOfTempos], u32_MaxTempos,
+                                                  &pat_Polyphony[u32_NumOfChanges], u32_MaxChanges);
+      if (s32_NumOfChanges < 0)
+      {
+         //the polyphony changes of this track are unknown, only its own max. polyphony is merged
+         opt_Result->s32_Error = ANALYZE_ERROR_DATA;
+      }
+      else
+      {
+         u32_NumOfChanges += (((uint32_t)s32_NumOfChanges < u32_MaxChanges) ? (uint32_t)s32_NumOfChanges : u32_MaxChanges);
+      }
+      midi_event_close(pv_MidiEvent);
+
+      u32_NumOfTempos += ((t_Statistic.u32_NumOfTempos < u32_MaxTempos) ? t_Statistic.u32_NumOfTempos : u32_MaxTempos);
+      merge_statistic(&opt_Result->t_Statistic, &t_Statistic);
+
+      //each track becomes a table of its own: max. one signal per note event, plus the terminating ones (4 bytes each)
+      u32_TableSize1By = (t_Statistic.au32_NumOfEvents[0] + t_Statistic.au32_NumOfEvents[1] + 2) * 4;
+      if ((t_Statistic.au32_NumOfEvents[0] + t_Statistic.au32_NumOfEvents[1]) == 0)
+      {
+         u32_TableSize1By = 0;
+      }
+      if (u32_TableSize1By > opt_Result->u32_TableSize1By)
+      {
+         opt_Result->u32_TableSize1By = u32_TableSize1By;
+      }
+   }
+   if (opt_Result->t_Statistic.u32_NumOfNotes == 0)
+   {
+      opt_Result->t_Statistic.u8_MinNote = 0;
+   }
+   //notes of different tracks sound at the same time as well (merge_statistic takes the max. of a single track)
+   u16_MaxPolyphony = get_max_polyphony(pat_Polyphony, u32_NumOfChanges);
+   if (u16_MaxPolyphony > opt_Result->t_Statistic.u16_MaxPolyphony)
+   {
+      opt_Result->t_Statistic.u16_MaxPolyphony = u16_MaxPolyphony;
+   }
+   opt_Result->u32_Duration1ms = get_duration_ms(t_HeaderChunk.u16_TimeDivision, opt_Result->t_Statistic.u32_DurationTicks, pat_Tempo, u32_NumOfTempos);
+   opt_Result->u8_Fits = (((opt_Result->s32_Error == 0) && ((ou32_FlashBudget1By == 0) || (opt_Result->u32_TableSize1By <= ou32_FlashBudget1By))) ? 1 : 0);
+   free(pat_Polyphony);
+   free(pat_Tempo);
+   midi_close(pv_Midi);
+}
+
+
+/*
+   Duration by the tempo map of all tracks (usually the first track of a format 1 file).
+   SMPTE time division does not depend on tempo.
+*/
+static uint32_t get_duration_ms(const uint16_t ou16_TimeDivision, const uint32_t ou32_DurationTicks, T_midi_event_tempo * const opat_Tempo, const uint32_t ou32_NumOfTempos)
+{
+   uint64_t u64_DurationUs;
+   uint32_t u32_TempoUs;
+   uint32_t u32_Tick;
+   uint32_t u32_Tempo;
+
+   if (ou16_TimeDivision > 0x7FFFu)
+   {
+      return (uint32_t)(ou32_DurationTicks * sound_get_ms_per_tick(ou16_TimeDivision));
+   }
+   if (ou16_TimeDivision == 0)
+   {
+      return 0;
+   }
+
+   if (ou32_NumOfTempos > 1)
+   {
+      qsort(opat_Tempo, ou32_NumOfTempos, sizeof(T_midi_event_tempo), compare_tempo_tick);
+   }
+   u64_DurationUs = 0;
+   u32_TempoUs = ANALYZE_DEFAULT_TEMPO_US;
+   u32_Tick = 0;
+   for (u32_Tempo = 0; (u32_Tempo < ou32_NumOfTempos) && (opat_Tempo[u32_Tempo].u32_Tick < ou32_DurationTicks); ++u32_Tempo)
+   {
+      u64_DurationUs += ((uint64_t)(opat_Tempo[u32_Tempo].u32_Tick - u32_Tick) * u32_TempoUs) / ou16_TimeDivision;
+      u32_Tick = opat_Tempo[u32_Tempo].u32_Tick;
+      u32_TempoUs = opat_Tempo[u32_Tempo].u32_TempoUs;
+   }
+   u64_DurationUs += ((uint64_t)(ou32_DurationTicks - u32_Tick) * u32_TempoUs) / ou16_TimeDivision;
+   return (uint32_t)(u64_DurationUs / 1000);
+}
+
+
+static int compare_tempo_tick(const void * opv_A, const void * opv_B)
+{
+   const T_midi_event_tempo * const pt_A = (const T_midi_event_tempo *)opv_A;
+   const T_midi_event_tempo * const pt_B = (const T_midi_event_tempo *)opv_B;
+
+   return ((pt_A->u32_Tick < pt_B->u32_Tick) ? -1 : ((pt_A->u32_Tick > pt_B->u32_Tick) ? 1 : 0));
+}
+
+
+/*
+   Max. number of notes sounding at the same time. At the same tick notes stop before others start.
+*/
+static uint16_t get_max_polyphony(T_midi_event_polyphony * const opat_Polyphony, const uint32_t ou32_NumOfChanges)
+{
+   uint32_t u32_Change;
+   int32_t s32_Polyphony;
+   int32_t s32_MaxPolyphony;
+
+   if (ou32_NumOfChanges == 0)
+   {
+      return 0;
+   }
+   qsort(opat_Polyphony, ou32_NumOfChanges, sizeof(T_midi_event_polyphony), compare_polyphony_tick);
+   s32_Polyphony = 0;
+   s32_MaxPolyphony = 0;
+   for (u32_Change = 0; u32_Change < ou32_NumOfChanges; ++u32_Change)
+   {
+      s32_Polyphony += opat_Polyphony[u32_Change].s32_Change;
+      if (s32_Polyphony > s32_MaxPolyphony)
+      {
+         s32_MaxPolyphony = s32_Polyphony;
+      }
+   }
+   return (uint16_t)((s32_MaxPolyphony < 0xFFFF) ? s32_MaxPolyphony : 0xFFFF);
+}
+
+
+static int compare_polyphony_tick(const void * opv_A, const void * opv_B)
+{
+   const T_midi_event_polyphony * const pt_A = (const T_midi_event_polyphony *)opv_A;
+   const T_midi_event_polyphony * const pt_B = (const T_midi_event_polyphony *)opv_B;
+
+   if (pt_A->u32_Tick != pt_B->u32_Tick)
+   {
+      return ((pt_A->u32_Tick < pt_B->u32_Tick) ? -1 : 1);
+   }
+   return ((pt_A->s32_Change < pt_B->s32_Change) ? -1 : ((pt_A->s32_Change > pt_B->s32_Change) ? 1 : 0));
+}
+
+
+static void merge_statistic(T_midi_event_statistic * const opt_Target, const T_midi_event_statistic * const opt_Source)
+{
+   uint32_t u32_Event;
+
+   for (u32_Event = 0; u32_Event < 8; ++u32_Event)
+   {
+      opt_Target->au32_NumOfEvents[u32_Event] += opt_Source->au32_NumOfEvents[u32_Event];
+   }
+   if (opt_Source->u32_NumOfNotes > 0)
+   {
+      if (opt_Source->u8_MinNote < opt_Target->u8_MinNote)
+      {
+         opt_Target->u8_MinNote = opt_Source->u8_MinNote;
+      }
+      if (opt_Source->u8_MaxNote > opt_Target->u8_MaxNote)
+      {
+         opt_Target->u8_MaxNote = opt_Source->u8_MaxNote;
+      }
+      opt_Target->u32_NumOfNotes += opt_Source->u32_NumOfNotes;
+   }
+   if (opt_Source->u16_MaxPolyphony > opt_Target->u16_MaxPolyphony)
+   {
+      opt_Target->u16_MaxPolyphony = opt_Source->u16_MaxPolyphony;
+   }
+   if (opt_Source->u32_NumOfTempos > 0)
+   {
+      if ((opt_Target->u32_NumOfTempos == 0) || (opt_Source->u32_MinTempoUs < opt_Target->u32_MinTempoUs))
+      {
+         opt_Target->u32_MinTempoUs = opt_Source->u32_MinTempoUs;
+      }
+      if (opt_Source->u32_MaxTempoUs > opt_Target->u32_MaxTempoUs)
+      {
+         opt_Target->u32_MaxTempoUs = opt_Source->u32_MaxTempoUs;
+      }
+      opt_Target->u32_NumOfTempos += opt_Source->u32_NumOfTempos;
+   }
+   if (opt_Source->u32_DurationTicks > opt_Target->u32_DurationTicks)
+   {
+      opt_Target->u32_DurationTicks = opt_Source->u32_DurationTicks;
+   }
+}
+
+
+static void merge_summary(T_analyze_summary * const opt_Target, const T_analyze_summary * const opt_Source)
+{
+   opt_Target->u32_NumOfFiles += opt_Source->u32_NumOfFiles;
+   opt_Target->u32_NumOfErrors += opt_Source->u32_NumOfErrors;
+   opt_Target->u32_NumOfFits += opt_Source->u32_NumOfFits;
+   merge_statistic(&opt_Target->t_Statistic, &opt_Source->t_Statistic);
+   opt_Target->u64_Duration1ms += opt_Source->u64_Duration1ms;
+   if (opt_Source->u32_MaxDuration1ms > opt_Target->u32_MaxDuration1ms)
+   {
+      opt_Target->u32_MaxDuration1ms = opt_Source->u32_MaxDuration1ms;
+   }
+}
+
+
+static void write_json_string(FILE * const opv_File, const char * opc_String)
+{
+   fprintf(opv_File, "\"");
+   for (; *opc_String != 0; ++opc_String)
+   {
+      const uint8_t u8_Char = (uint8_t)*opc_String;
+
+      if ((u8_Char == '"') || (u8_Char == '\\'))
+      {
+         fprintf(opv_File, "\\%c", u8_Char);
+      }
+      else if (u8_Char < 0x20)
+      {
+         fprintf(opv_File, "\\u%04x", u8_Char);
+      }
+      else
+      {
+         fprintf(opv_File, "%c", u8_Char);
+      }
+   }
+   fprintf(opv_File, "\"");
+}
+
+
+static void write_json_statistic(FILE * const opv_File, const T_midi_event_statistic * const opt_Statistic)
+{
+   uint32_t u32_Event;
+
+   fprintf(opv_File, "\"notes\": %d, \"min_note\": %d, \"max_note\": %d, \"max_polyphony\": %d, \"tempo_changes\": %d, \"min_tempo_us\": %d, \"max_tempo_us\": %d, \"events\": {",
+           opt_Statistic->u32_NumOfNotes, opt_Statistic->u8_MinNote, opt_Statistic->u8_MaxNote, opt_Statistic->u16_MaxPolyphony,
+           opt_Statistic->u32_NumOfTempos, opt_Statistic->u32_MinTempoUs, opt_Statistic->u32_MaxTempoUs);
+   for (u32_Event = 0; u32_Event < 8; ++u32_Event)
+   {
+      fprintf(opv_File, "\"%s\": %d%s", mapcn_EventName[u32_Event], opt_Statistic->au32_NumOfEvents[u32_Event], ((u32_Event < 7) ? ", " : ""));
+   }
+   fprintf(opv_File, "}");
+}
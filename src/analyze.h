@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     analyze.h
+   \brief    Functions to gather statistics of a collection of midi files
+
+   All midi files of a directory (including sub directories, symbolic links
+   are not followed) are scanned in parallel. Only the events are decoded;
+   neither note events nor signal sequences are generated.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _ANALYZE_H
+#define _ANALYZE_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_ANALYZE_HANDLE;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//ou32_NumOfThreads: 0 -> number of online CPUs; ou32_FlashBudget1By: max. size of a signal table (0 -> no limit)
+extern T_ANALYZE_HANDLE analyze_open(const char * const opc_Directory, const uint32_t ou32_NumOfThreads, const uint32_t ou32_FlashBudget1By);
+extern void analyze_close(T_ANALYZE_HANDLE opv_Handle);
+
+extern void analyze_print_summary(T_ANALYZE_HANDLE opv_Handle);
+//opc_File: NULL -> stdout
+extern void analyze_write_csv(const char * const opc_File, T_ANALYZE_HANDLE opv_Handle);
+extern void analyze_write_json(const char * const opc_File, T_ANALYZE_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
@@ -0,0 +1,370 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     checkpoint.c
+   \brief    Functions to build, store and look up the checkpoint index of a midi file
+
+   Sidecar file (little endian):
+      "MCKP", version (u32), number of tracks (u32), interval [ticks] (u32), hash of the track data (u32)
+      per track: chunk size (u32), number of checkpoints (u32), checkpoints
+      per checkpoint: offset (u32), tick (u32), running status, last on/off, last channel, last note (u8),
+                      sounding notes (16 * 8 * u16)
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "checkpoint.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define CHECKPOINT_VERSION       (1u)
+#define CHECKPOINT_SIZE1BY       (4 + 4 + 4 + (16 * 8 * 2))
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   uint32_t u32_ChunkSize;
+   T_midi_event_checkpoint * pat_Checkpoints;
+   int32_t s32_NumOfCheckpoints;
+} T_checkpoint_track;
+
+
+typedef struct
+{
+   uint32_t u32_IntervalTicks;
+   uint32_t u32_Hash;
+   T_checkpoint_track * pat_Track;
+   uint32_t u32_NumOfTracks;
+} T_checkpoint_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static uint32_t get_hash(T_MIDI_HANDLE opv_Midi, const uint32_t ou32_NumOfTracks);
+static void write_u32(FILE * const opv_File, const uint32_t ou32_Value);
+static uint32_t read_u32(const uint8_t * const opu8_Data);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_CHECKPOINT_HANDLE checkpoint_open(T_MIDI_HANDLE opv_Midi, const uint32_t ou32_IntervalTicks)
+{
+   T_checkpoint_instance * pt_CheckpointInstance;
+   T_midi_header_chunk t_HeaderChunk;
+   uint32_t u32_Track;
+
+   //preconditional check
+   if ((ou32_IntervalTicks == 0) || (midi_get_header_chunk(opv_Midi, &t_HeaderChunk) < 0))
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // allocate checkpoint instance                               //
+   //------------------------------------------------------------//
+   pt_CheckpointInstance = calloc(1, sizeof(T_checkpoint_instance));
+   pt_CheckpointInstance->u32_IntervalTicks = ou32_IntervalTicks;
+   pt_CheckpointInstance->u32_Hash = get_hash(opv_Midi, t_HeaderChunk.u16_NumOfTracks);
+   pt_CheckpointInstance->pat_Track = calloc(t_HeaderChunk.u16_NumOfTracks + 1, sizeof(T_checkpoint_track));
+
+   //------------------------------------------------------------//
+   // scan each track                                            //
+   //------------------------------------------------------------//
+   for (u32_Track = 0; u32_Track < t_HeaderChunk.u16_NumOfTracks; ++u32_Track)
+   {
+      T_checkpoint_track * const pt_Track = &pt_CheckpointInstance->pat_Track[u32_Track];
+      T_midi_track_chunk t_TrackChunk;
+      T_MIDI_EVENT_HANDLE pv_MidiEvent;
+      T_midi_event_checkpoint * pt_Checkpoints;
+      int32_t s32_Count;
+
+      if (midi_get_track_chunk(opv_Midi, u32_Track, &t_TrackChunk) < 0)
+      {
+         break;
+      }
+      pt_Track->u32_ChunkSize = t_TrackChunk.u32_ChunkSize;
+      pv_MidiEvent = midi_event_open(&t_TrackChunk);
+      s32_Count = midi_event_get_checkpoints(pv_MidiEvent, ou32_IntervalTicks, &pt_Checkpoints);
+      if (s32_Count < 0)
+      {
+         midi_event_close(pv_MidiEvent);
+         pt_CheckpointInstance->u32_NumOfTracks = u32_Track;
+         checkpoint_close(pt_CheckpointInstance);
+         return 0;
+      }
+      pt_Track->pat_Checkpoints = malloc(s32_Count * sizeof(T_midi_event_checkpoint));
+      memcpy(pt_Track->pat_Checkpoints, pt_Checkpoints, s32_Count * sizeof(T_midi_event_checkpoint));
+      pt_Track->s32_NumOfCheckpoints = s32_Count;
+      midi_event_close(pv_MidiEvent);
+   }
+   pt_CheckpointInstance->u32_NumOfTracks = u32_Track;
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return checkpoint instance handle
+   return pt_CheckpointInstance;
+}
+
+
+T_CHECKPOINT_HANDLE checkpoint_load(const char * const opc_File, T_MIDI_HANDLE opv_Midi, const uint32_t ou32_IntervalTicks)
+{
+   T_checkpoint_instance * pt_CheckpointInstance;
+   T_midi_header_chunk t_HeaderChunk;
+   FILE * pv_File;
+   uint8_t au8_Header[20];
+   uint8_t au8_Checkpoint[CHECKPOINT_SIZE1BY];
+   uint32_t u32_Track;
+
+   //preconditional check
+   if ((ou32_IntervalTicks == 0) || (midi_get_header_chunk(opv_Midi, &t_HeaderChunk) < 0))
+   {
+      return 0;
+   }
+   pv_File = fopen(opc_File, "rb");
+   if (pv_File == NULL)
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // header has to match the midi file and the interval         //
+   //------------------------------------------------------------//
+   if ((fread(au8_Header, sizeof(au8_Header), 1, pv_File) != 1) || (memcmp(au8_Header, "MCKP", 4) != 0) ||
+       (read_u32(&au8_Header[4]) != CHECKPOINT_VERSION) || (read_u32(&au8_Header[8]) != t_HeaderChunk.u16_NumOfTracks) ||
+       (read_u32(&au8_Header[12]) != ou32_IntervalTicks) || (read_u32(&au8_Header[16]) != get_hash(opv_Midi, t_HeaderChunk.u16_NumOfTracks)))
+   {
+      fclose(pv_File);
+      return 0;
+   }
+   pt_CheckpointInstance = calloc(1, sizeof(T_checkpoint_instance));
+   pt_CheckpointInstance->u32_IntervalTicks = read_u32(&au8_Header[12]);
+   pt_CheckpointInstance->u32_Hash = read_u32(&au8_Header[16]);
+   pt_CheckpointInstance->pat_Track = calloc(t_HeaderChunk.u16_NumOfTracks + 1, sizeof(T_checkpoint_track));
+
+   //------------------------------------------------------------//
+   // checkpoints of each track                                  //
+   //------------------------------------------------------------//
+   for (u32_Track = 0; u32_Track < t_HeaderChunk.u16_NumOfTracks; ++u32_Track)
+   {
+      T_checkpoint_track * const pt_Track = &pt_CheckpointInstance->pat_Track[u32_Track];
+      T_midi_track_chunk t_TrackChunk;
+      int32_t s32_Count;
+
+      pt_CheckpointInstance->u32_NumOfTracks = u32_Track + 1;
+      if ((midi_get_track_chunk(opv_Midi, u32_Track, &t_TrackChunk) < 0) || (fread(au8_Header, 8, 1, pv_File) != 1) ||
+          (read_u32(&au8_Header[0]) != t_TrackChunk.u32_ChunkSize) || (read_u32(&au8_Header[4]) == 0) ||
+          (read_u32(&au8_Header[4]) > (t_TrackChunk.u32_ChunkSize + 1)))
+      {
+         break;
+      }
+      pt_Track->u32_ChunkSize = t_TrackChunk.u32_ChunkSize;
+      pt_Track->s32_NumOfCheckpoints = (int32_t)read_u32(&au8_Header[4]);
+      pt_Track->pat_Checkpoints = malloc(pt_Track->s32_NumOfCheckpoints * sizeof(T_midi_event_checkpoint));
+      for (s32_Count = 0; s32_Count < pt_Track->s32_NumOfCheckpoints; ++s32_Count)
+      {
+         T_midi_event_checkpoint * const pt_Checkpoint = &pt_Track->pat_Checkpoints[s32_Count];
+
+         if (fread(au8_Checkpoint, sizeof(au8_Checkpoint), 1, pv_File) != 1)
+         {
+            break;
+         }
+         pt_Checkpoint->u32_Offset = read_u32(&au8_Checkpoint[0]);
+         pt_Checkpoint->u32_Tick = read_u32(&au8_Checkpoint[4]);
+         pt_Checkpoint->u8_RunningStatus = au8_Checkpoint[8];
+         pt_Checkpoint->u8_LastOnOff = au8_Checkpoint[9];
+         pt_Checkpoint->u8_LastChannel = au8_Checkpoint[10] & 0x0F;
+         pt_Checkpoint->u8_LastNote = au8_Checkpoint[11] & 0x7F;
+         for (uint32_t u32_Index = 0; u32_Index < (16 * 8); ++u32_Index)
+         {
+            pt_Checkpoint->au16_ActiveNotes[u32_Index / 8][u32_Index % 8] =
+               (uint16_t)(au8_Checkpoint[12 + (2 * u32_Index)] | (au8_Checkpoint[13 + (2 * u32_Index)] << 8));
+         }
+      }
+      if (s32_Count < pt_Track->s32_NumOfCheckpoints)
+      {
+         break;
+      }
+   }
+   fclose(pv_File);
+
+   //truncated file
+   if (u32_Track < t_HeaderChunk.u16_NumOfTracks)
+   {
+      checkpoint_close(pt_CheckpointInstance);
+      return 0;
+   }
+
+   //return checkpoint instance handle
+   return pt_CheckpointInstance;
+}
+
+
+void checkpoint_close(T_CHECKPOINT_HANDLE opv_Handle)
+{
+   T_checkpoint_instance * const pt_CheckpointInstance = (T_checkpoint_instance *)opv_Handle;
+   uint32_t u32_Track;
+
+   //release checkpoints of each track and instance itself
+   for (u32_Track = 0; u32_Track < pt_CheckpointInstance->u32_NumOfTracks; ++u32_Track)
+   {
+      free(pt_CheckpointInstance->pat_Track[u32_Track].pat_Checkpoints);
+   }
+   free(pt_CheckpointInstance->pat_Track);
+   free(pt_CheckpointInstance);
+}
+
+
+int32_t checkpoint_save(const char * const opc_File, T_CHECKPOINT_HANDLE opv_Handle)
+{
+   T_checkpoint_instance * const pt_CheckpointInstance = (T_checkpoint_instance *)opv_Handle;
+   FILE * pv_File;
+   uint32_t u32_Track;
+   int32_t s32_Result;
+
+   pv_File = fopen(opc_File, "wb");
+   if (pv_File == NULL)
+   {
+      return -1;
+   }
+   fwrite("MCKP", 4, 1, pv_File);
+   write_u32(pv_File, CHECKPOINT_VERSION);
+   write_u32(pv_File, pt_CheckpointInstance->u32_NumOfTracks);
+   write_u32(pv_File, pt_CheckpointInstance->u32_IntervalTicks);
+   write_u32(pv_File, pt_CheckpointInstance->u32_Hash);
+   for (u32_Track = 0; u32_Track < pt_CheckpointInstance->u32_NumOfTracks; ++u32_Track)
+   {
+      const T_checkpoint_track * const pt_Track = &pt_CheckpointInstance->pat_Track[u32_Track];
+
+      write_u32(pv_File, pt_Track->u32_ChunkSize);
+      write_u32(pv_File, (uint32_t)pt_Track->s32_NumOfCheckpoints);
+      for (int32_t s32_Count = 0; s32_Count < pt_Track->s32_NumOfCheckpoints; ++s32_Count)
+      {
+         const T_midi_event_checkpoint * const pt_Checkpoint = &pt_Track->pat_Checkpoints[s32_Count];
+
+         write_u32(pv_File, pt_Checkpoint->u32_Offset);
+         write_u32(pv_File, pt_Checkpoint->u32_Tick);
+         fputc(pt_Checkpoint->u8_RunningStatus, pv_File);
+         fputc(pt_Checkpoint->u8_LastOnOff, pv_File);
+         fputc(pt_Checkpoint->u8_LastChannel, pv_File);
+         fputc(pt_Checkpoint->u8_LastNote, pv_File);
+         for (uint32_t u32_Index = 0; u32_Index < (16 * 8); ++u32_Index)
+         {
+            const uint16_t u16_Bits = pt_Checkpoint->au16_ActiveNotes[u32_Index / 8][u32_Index % 8];
+
+            fputc(u16_Bits & 0xFF, pv_File);
+            fputc(u16_Bits >> 8, pv_File);
+         }
+      }
+   }
+   s32_Result = ((ferror(pv_File) != 0) ? -1 : 0);
+   if (fclose(pv_File) != 0)
+   {
+      s32_Result = -1;
+   }
+   if (s32_Result < 0)
+   {
+      remove(opc_File);
+   }
+   return s32_Result;
+}
+
+
+/*
+   Binary search for the last checkpoint, whose time is not behind ou32_Tick.
+*/
+const T_midi_event_checkpoint * checkpoint_find(T_CHECKPOINT_HANDLE opv_Handle, const uint32_t ou32_Track, const uint32_t ou32_Tick)
+{
+   T_checkpoint_instance * const pt_CheckpointInstance = (T_checkpoint_instance *)opv_Handle;
+   const T_checkpoint_track * pt_Track;
+   int32_t s32_Low;
+   int32_t s32_High;
+
+   if ((pt_CheckpointInstance == NULL) || (ou32_Track >= pt_CheckpointInstance->u32_NumOfTracks))
+   {
+      return NULL;
+   }
+   pt_Track = &pt_CheckpointInstance->pat_Track[ou32_Track];
+   s32_Low = 0;
+   s32_High = pt_Track->s32_NumOfCheckpoints - 1;
+   while (s32_Low < s32_High)
+   {
+      const int32_t s32_Mid = (s32_Low + s32_High + 1) / 2;
+
+      if (pt_Track->pat_Checkpoints[s32_Mid].u32_Tick <= ou32_Tick)
+      {
+         s32_Low = s32_Mid;
+      }
+      else
+      {
+         s32_High = s32_Mid - 1;
+      }
+   }
+   return &pt_Track->pat_Checkpoints[s32_Low];
+}
+
+
+void checkpoint_print_statistic(T_CHECKPOINT_HANDLE opv_Handle)
+{
+   T_checkpoint_instance * const pt_CheckpointInstance = (T_checkpoint_instance *)opv_Handle;
+   uint32_t u32_NumOfCheckpoints;
+   uint32_t u32_Track;
+
+   u32_NumOfCheckpoints = 0;
+   for (u32_Track = 0; u32_Track < pt_CheckpointInstance->u32_NumOfTracks; ++u32_Track)
+   {
+      u32_NumOfCheckpoints += (uint32_t)pt_CheckpointInstance->pat_Track[u32_Track].s32_NumOfCheckpoints;
+   }
+   printf("Checkpoints: %d tracks, %d checkpoints, interval %d ticks\n", pt_CheckpointInstance->u32_NumOfTracks,
+          u32_NumOfCheckpoints, pt_CheckpointInstance->u32_IntervalTicks);
+}
+
+
+
+
+
+
+
+
+
+//FNV-1a over all track chunks (detects a modified midi file)
+static uint32_t get_hash(T_MIDI_HANDLE opv_Midi, const uint32_t ou32_NumOfTracks)
+{
+   T_midi_track_chunk t_TrackChunk;
+   uint32_t u32_Hash;
+
+   u32_Hash = 2166136261u;
+   for (uint32_t u32_Track = 0; u32_Track < ou32_NumOfTracks; ++u32_Track)
+   {
+      if (midi_get_track_chunk(opv_Midi, u32_Track, &t_TrackChunk) < 0)
+      {
+         break;
+      }
+      for (uint32_t u32_Index = 0; u32_Index < t_TrackChunk.u32_ChunkSize; ++u32_Index)
+      {
+         u32_Hash = (u32_Hash ^ t_TrackChunk.pu8_Chunk[u32_Index]) * 16777619u;
+      }
+   }
+   return u32_Hash;
+}
+
+
+static void write_u32(FILE * const opv_File, const uint32_t ou32_Value)
+{
+   const uint8_t au8_Value[4] = { (uint8_t)ou32_Value, (uint8_t)(ou32_Value >> 8), (uint8_t)(ou32_Value >> 16), (uint8_t)(ou32_Value >> 24) };
+
+   fwrite(au8_Value, sizeof(au8_Value), 1, opv_File);
+}
+
+
+static uint32_t read_u32(const uint8_t * const opu8_Data)
+{
+   return (uint32_t)opu8_Data[0] | ((uint32_t)opu8_Data[1] << 8) | ((uint32_t)opu8_Data[2] << 16) | ((uint32_t)opu8_Data[3] << 24);
+}
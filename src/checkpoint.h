@@ -0,0 +1,57 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     checkpoint.h
+   \brief    Functions to build, store and look up the checkpoint index of a midi file
+
+   A checkpoint holds the decoder state (position, running status, time and
+   sounding notes) of a track at a regular interval, so a time window of a song
+   can be decoded without decoding the track from its beginning.
+   The index is stored in a sidecar file next to the midi file.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _CHECKPOINT_H
+#define _CHECKPOINT_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "midi.h"
+#include "midi_event.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_CHECKPOINT_HANDLE;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//build index of all tracks (a checkpoint every ou32_IntervalTicks)
+extern T_CHECKPOINT_HANDLE checkpoint_open(T_MIDI_HANDLE opv_Midi, const uint32_t ou32_IntervalTicks);
+//load index from sidecar file; returns 0 if the file is missing or does not match the midi file respectively the interval
+extern T_CHECKPOINT_HANDLE checkpoint_load(const char * const opc_File, T_MIDI_HANDLE opv_Midi, const uint32_t ou32_IntervalTicks);
+extern void checkpoint_close(T_CHECKPOINT_HANDLE opv_Handle);
+
+extern int32_t checkpoint_save(const char * const opc_File, T_CHECKPOINT_HANDLE opv_Handle);
+//latest checkpoint of the track at or before the given time (NULL: track start)
+extern const T_midi_event_checkpoint * checkpoint_find(T_CHECKPOINT_HANDLE opv_Handle, const uint32_t ou32_Track, const uint32_t ou32_Tick);
+extern void checkpoint_print_statistic(T_CHECKPOINT_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
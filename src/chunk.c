@@ -0,0 +1,157 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     chunk.c
+   \brief    Functions to split a signal sequence into page aligned blocks (external SPI flash)
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "chunk.h"
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void put_u16(uint8_t * const opu8_Data, const uint16_t ou16_Value);
+static void put_u32(uint8_t * const opu8_Data, const uint32_t ou32_Value);
+static uint16_t get_u16(const uint8_t * const opu8_Data);
+static uint32_t get_u32(const uint8_t * const opu8_Data);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+int32_t chunk_get_image(const uint16_t ou16_BlockSize, const int32_t os32_Length, const T_sound_signal * opt_SignalSequence,
+                        uint8_t ** const oppu8_Image)
+{
+   const uint32_t u32_SignalsPerBlock = ((uint32_t)ou16_BlockSize - CHUNK_BLOCK_HEADER_SIZE) / sizeof(T_sound_signal);
+   uint8_t * pu8_Image;
+   uint32_t u32_NumOfSignals;
+   uint32_t u32_NumOfBlocks;
+   uint32_t u32_IndexBlocks;
+   uint32_t u32_Time1ms;
+   uint64_t u64_Size1By;
+
+   //preconditional check: power of two
+   *oppu8_Image = NULL;
+   if ((ou16_BlockSize < CHUNK_MIN_BLOCK_SIZE) || (ou16_BlockSize > CHUNK_MAX_BLOCK_SIZE) || ((ou16_BlockSize & (ou16_BlockSize - 1u)) != 0) ||
+       (os32_Length <= 0))
+   {
+      return -1;
+   }
+
+   //------------------------------------------------------------//
+   // layout                                                     //
+   //------------------------------------------------------------//
+   //the terminating signal is not stored (flag of the last block)
+   u32_NumOfSignals = (uint32_t)os32_Length;
+   if ((opt_SignalSequence[u32_NumOfSignals - 1].u16_Duration1ms == 0) && (opt_SignalSequence[u32_NumOfSignals - 1].u16_Frequency1Hz == 0))
+   {
+      --u32_NumOfSignals;
+   }
+   u32_NumOfBlocks = ((u32_NumOfSignals > 0) ? ((u32_NumOfSignals + u32_SignalsPerBlock - 1) / u32_SignalsPerBlock) : 1);
+   u32_IndexBlocks = (CHUNK_INDEX_HEADER_SIZE + (4 * u32_NumOfBlocks) + ou16_BlockSize - 1) / ou16_BlockSize;
+   u64_Size1By = (uint64_t)(u32_IndexBlocks + u32_NumOfBlocks) * ou16_BlockSize;
+   if ((u32_NumOfBlocks > UINT16_MAX) || (u32_IndexBlocks > UINT16_MAX) || (u64_Size1By > INT32_MAX))
+   {
+      printf("[E] Too many blocks (%d), use a larger block size!\n", u32_NumOfBlocks);
+      return -1;
+   }
+
+   //------------------------------------------------------------//
+   // index and data blocks (unused bytes erased)                //
+   //------------------------------------------------------------//
+   pu8_Image = malloc((size_t)u64_Size1By);
+   memset(pu8_Image, 0xFF, (size_t)u64_Size1By);
+   put_u32(&pu8_Image[0], CHUNK_MAGIC);
+   put_u16(&pu8_Image[4], CHUNK_VERSION);
+   put_u16(&pu8_Image[6], ou16_BlockSize);
+   put_u16(&pu8_Image[8], (uint16_t)u32_IndexBlocks);
+   put_u16(&pu8_Image[10], (uint16_t)u32_NumOfBlocks);
+   u32_Time1ms = 0;
+   for (uint32_t u32_Block = 0; u32_Block < u32_NumOfBlocks; ++u32_Block)
+   {
+      uint8_t * const pu8_Block = &pu8_Image[(u32_IndexBlocks + u32_Block) * ou16_BlockSize];
+      const uint32_t u32_First = u32_Block * u32_SignalsPerBlock;
+      const uint32_t u32_Signals = (((u32_NumOfSignals - u32_First) < u32_SignalsPerBlock) ? (u32_NumOfSignals - u32_First) : u32_SignalsPerBlock);
+
+      put_u32(&pu8_Image[CHUNK_INDEX_HEADER_SIZE + (4 * u32_Block)], u32_Time1ms);
+      put_u32(&pu8_Block[0], u32_Time1ms);
+      put_u16(&pu8_Block[4], (uint16_t)u32_Signals);
+      put_u16(&pu8_Block[6], ((u32_Block == (u32_NumOfBlocks - 1)) ? CHUNK_FLAG_LAST : 0));
+      for (uint32_t u32_Signal = 0; u32_Signal < u32_Signals; ++u32_Signal)
+      {
+         const T_sound_signal * const pt_Signal = &opt_SignalSequence[u32_First + u32_Signal];
+
+         put_u16(&pu8_Block[CHUNK_BLOCK_HEADER_SIZE + (4 * u32_Signal)], pt_Signal->u16_Duration1ms);
+         put_u16(&pu8_Block[CHUNK_BLOCK_HEADER_SIZE + (4 * u32_Signal) + 2], pt_Signal->u16_Frequency1Hz);
+         u32_Time1ms += pt_Signal->u16_Duration1ms;
+      }
+   }
+   put_u32(&pu8_Image[12], u32_Time1ms);
+
+   //return size of image
+   *oppu8_Image = pu8_Image;
+   return (int32_t)u64_Size1By;
+}
+
+
+void chunk_print_image(const uint8_t * const opu8_Image)
+{
+   const uint16_t u16_BlockSize = get_u16(&opu8_Image[6]);
+   const uint16_t u16_IndexBlocks = get_u16(&opu8_Image[8]);
+   const uint16_t u16_NumOfBlocks = get_u16(&opu8_Image[10]);
+   uint32_t u32_NumOfSignals = 0;
+
+   for (uint32_t u32_Block = 0; u32_Block < u16_NumOfBlocks; ++u32_Block)
+   {
+      u32_NumOfSignals += get_u16(&opu8_Image[((u16_IndexBlocks + u32_Block) * u16_BlockSize) + 4]);
+   }
+   printf("Chunks: %d bytes per block, %d index block(s), %d data blocks, %d bytes\n", u16_BlockSize, u16_IndexBlocks, u16_NumOfBlocks,
+          (u16_IndexBlocks + u16_NumOfBlocks) * u16_BlockSize);
+   printf("\tSignals: %d (%d per block), duration: %d ms\n", u32_NumOfSignals, (u16_BlockSize - CHUNK_BLOCK_HEADER_SIZE) / 4,
+          get_u32(&opu8_Image[12]));
+}
+
+
+
+
+
+
+
+
+
+static void put_u16(uint8_t * const opu8_Data, const uint16_t ou16_Value)
+{
+   opu8_Data[0] = (uint8_t)ou16_Value;
+   opu8_Data[1] = (uint8_t)(ou16_Value >> 8);
+}
+
+
+static void put_u32(uint8_t * const opu8_Data, const uint32_t ou32_Value)
+{
+   put_u16(&opu8_Data[0], (uint16_t)ou32_Value);
+   put_u16(&opu8_Data[2], (uint16_t)(ou32_Value >> 16));
+}
+
+
+static uint16_t get_u16(const uint8_t * const opu8_Data)
+{
+   return (uint16_t)(opu8_Data[0] | (opu8_Data[1] << 8));
+}
+
+
+static uint32_t get_u32(const uint8_t * const opu8_Data)
+{
+   return (uint32_t)get_u16(&opu8_Data[0]) | ((uint32_t)get_u16(&opu8_Data[2]) << 16);
+}
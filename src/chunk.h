@@ -0,0 +1,59 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     chunk.h
+   \brief    Functions to split a signal sequence into page aligned blocks (external SPI flash)
+
+   The image consists of index blocks and data blocks of equal size (power of two,
+   e.g. the page or sector size of the flash), all values little endian:
+   index:      magic "SNDC", version, block size, number of index and data blocks (16-bit each),
+               total duration [ms] (32-bit), start time of each data block [ms] (32-bit)
+   data block: start time [ms] (32-bit), number of signals, flags (16-bit each),
+               signals (duration [ms], frequency [Hz], 16-bit each)
+   Unused bytes are 0xFF (erased flash). A player reads one block while playing the
+   previous one and finds the block of any time by a binary search in the index.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _CHUNK_H
+#define _CHUNK_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "sound.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define CHUNK_MAGIC                 (0x43444E53u)  //"SNDC"
+#define CHUNK_VERSION               (1)
+#define CHUNK_INDEX_HEADER_SIZE     (16)
+#define CHUNK_BLOCK_HEADER_SIZE     (8)
+#define CHUNK_FLAG_LAST             (0x0001u)      //last data block
+#define CHUNK_MIN_BLOCK_SIZE        (64)
+#define CHUNK_MAX_BLOCK_SIZE        (32768)
+
+/* -- Types --------------------------------------------------------------- */
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//returns the size of the image [bytes] (allocated, to be freed by the caller), -1: invalid block size or too many blocks
+extern int32_t chunk_get_image(const uint16_t ou16_BlockSize, const int32_t os32_Length, const T_sound_signal * opt_SignalSequence,
+                               uint8_t ** const oppu8_Image);
+extern void chunk_print_image(const uint8_t * const opu8_Image);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
@@ -0,0 +1,368 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     footprint.c
+   \brief    Functions to compare the encodings of signal sequences
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "footprint.h"
+#include "motif.h"
+#include "pool.h"
+#include "palette.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define FOOTPRINT_NUM_OF_FORMATS    (3)
+
+/* -- Types --------------------------------------------------------------- */
+/*
+   Decoder of a format on a 32-bit target, per signal (see target/): size of the
+   player state, worst case number of flash reads and number of divisions.
+   table: duration, frequency
+   motif: entry offset and length, duration, frequency, entry length and loops at the end of a motif
+   palette: 1 respectively 2 bytes index, duration and frequency palette; grid -> 1ms division
+*/
+typedef struct
+{
+   const char * pc_Format;
+   uint32_t u32_Ram1By;
+   uint32_t u32_Reads;
+   uint32_t u32_Divisions;
+} T_footprint_decoder;
+
+
+typedef struct
+{
+   char * pc_Name;
+   int32_t s32_Signals;
+   int32_t as32_Size1By[FOOTPRINT_NUM_OF_FORMATS];    //-1: not encodable
+   uint32_t au32_Cycles[FOOTPRINT_NUM_OF_FORMATS];
+   int32_t s32_Best;                                  //smallest format within the budget, -1: none
+} T_footprint_song;
+
+
+typedef struct
+{
+   uint16_t u16_GridNumerator;
+   uint16_t u16_GridDenominator;
+   uint8_t u8_Batch;
+   T_footprint_song * pat_Song;
+   int32_t s32_NumOfSongs;
+   int32_t s32_MaxSongs;
+   T_POOL_HANDLE pv_Pool;                             //batch only
+   T_PALETTE_HANDLE pv_Palette;                       //common palette of all songs
+   int32_t as32_Size1By[FOOTPRINT_NUM_OF_FORMATS];    //all songs as written (-1: not encodable)
+   uint32_t au32_Cycles[FOOTPRINT_NUM_OF_FORMATS];
+   int32_t s32_Selected;
+   uint32_t u32_MaxCycles;
+} T_footprint_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+static const T_footprint_decoder mat_Decoder[FOOTPRINT_NUM_OF_FORMATS] =
+{
+   { "table",   4,  2, 0 },
+   { "motif",   12, 6, 0 },
+   { "palette", 28, 4, 1 },
+};
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static uint32_t get_cycles(const int32_t os32_Format, const uint8_t ou8_BytesPerSignal);
+static int32_t get_smallest(const int32_t * const opas32_Size1By, const uint32_t * const opau32_Cycles, const uint32_t ou32_MaxCycles);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_FOOTPRINT_HANDLE footprint_open(const uint16_t ou16_GridNumerator, const uint16_t ou16_GridDenominator, const uint8_t ou8_Batch)
+{
+   T_footprint_instance * pt_FootprintInstance;
+
+   //preconditional check
+   if ((ou16_GridNumerator == 0) || (ou16_GridDenominator == 0))
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // allocate footprint instance                                //
+   //------------------------------------------------------------//
+   pt_FootprintInstance = calloc(1, sizeof(T_footprint_instance));
+   pt_FootprintInstance->u16_GridNumerator = ou16_GridNumerator;
+   pt_FootprintInstance->u16_GridDenominator = ou16_GridDenominator;
+   pt_FootprintInstance->u8_Batch = ou8_Batch;
+   pt_FootprintInstance->pv_Pool = ((ou8_Batch != 0) ? pool_open() : NULL);
+   pt_FootprintInstance->pv_Palette = palette_open(ou16_GridNumerator, ou16_GridDenominator);
+   pt_FootprintInstance->s32_Selected = -1;
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return footprint instance handle
+   return pt_FootprintInstance;
+}
+
+
+void footprint_close(T_FOOTPRINT_HANDLE opv_Handle)
+{
+   T_footprint_instance * const pt_FootprintInstance = (T_footprint_instance *)opv_Handle;
+   int32_t s32_Song;
+
+   //release songs, encoders and instance itself
+   for (s32_Song = 0; s32_Song < pt_FootprintInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      free(pt_FootprintInstance->pat_Song[s32_Song].pc_Name);
+   }
+   free(pt_FootprintInstance->pat_Song);
+   if (pt_FootprintInstance->pv_Pool != NULL)
+   {
+      pool_close(pt_FootprintInstance->pv_Pool);
+   }
+   palette_close(pt_FootprintInstance->pv_Palette);
+   free(pt_FootprintInstance);
+}
+
+
+/*
+   Encode the song by each format on its own (sizes as written for a single song) and add it
+   to the pool and the common palette.
+*/
+int32_t footprint_add_signal_sequence(T_FOOTPRINT_HANDLE opv_Handle, const char * const opc_Name, const uint64_t ou64_Order,
+                                      const int32_t os32_Length, const T_sound_signal * opt_SignalSequence)
+{
+   T_footprint_instance * const pt_FootprintInstance = (T_footprint_instance *)opv_Handle;
+   T_footprint_song * pt_Song;
+   T_MOTIF_HANDLE pv_Motif;
+   T_PALETTE_HANDLE pv_Palette;
+   uint8_t u8_BytesPerSignal;
+
+   //preconditional check
+   if (os32_Length <= 0)
+   {
+      return -1;
+   }
+
+   //grow song list
+   if (pt_FootprintInstance->s32_NumOfSongs >= pt_FootprintInstance->s32_MaxSongs)
+   {
+      pt_FootprintInstance->s32_MaxSongs = ((pt_FootprintInstance->s32_MaxSongs > 0) ? (2 * pt_FootprintInstance->s32_MaxSongs) : 16);
+      pt_FootprintInstance->pat_Song = realloc(pt_FootprintInstance->pat_Song, pt_FootprintInstance->s32_MaxSongs * sizeof(T_footprint_song));
+   }
+   pt_Song = &pt_FootprintInstance->pat_Song[pt_FootprintInstance->s32_NumOfSongs];
+   pt_Song->pc_Name = strdup(opc_Name);
+   pt_Song->s32_Signals = os32_Length;
+   pt_Song->s32_Best = -1;
+
+   //------------------------------------------------------------//
+   // table: signals and terminating 0, 0                        //
+   //------------------------------------------------------------//
+   pt_Song->as32_Size1By[0] = (os32_Length + 1) * (int32_t)sizeof(T_sound_signal);
+   pt_Song->au32_Cycles[0] = get_cycles(0, 0);
+
+   //------------------------------------------------------------//
+   // motif: pool and play list (terminated by 0, 0, 0)          //
+   //------------------------------------------------------------//
+   pt_Song->as32_Size1By[1] = -1;
+   pt_Song->au32_Cycles[1] = get_cycles(1, 0);
+   pv_Motif = motif_open(os32_Length, opt_SignalSequence);
+   if (pv_Motif != 0)
+   {
+      const T_sound_signal * pt_Pool;
+      const T_motif_entry * pt_PlayList;
+
+      pt_Song->as32_Size1By[1] = (motif_get_pool(pv_Motif, &pt_Pool) * (int32_t)sizeof(T_sound_signal)) +
+                                 ((motif_get_play_list(pv_Motif, &pt_PlayList) + 1) * (int32_t)sizeof(T_motif_entry));
+      motif_close(pv_Motif);
+   }
+
+   //------------------------------------------------------------//
+   // palette of the song only                                   //
+   //------------------------------------------------------------//
+   pt_Song->as32_Size1By[2] = -1;
+   pt_Song->au32_Cycles[2] = get_cycles(2, 2);
+   pv_Palette = palette_open(pt_FootprintInstance->u16_GridNumerator, pt_FootprintInstance->u16_GridDenominator);
+   palette_add_signal_sequence(pv_Palette, opc_Name, 0, os32_Length, opt_SignalSequence);
+   if (palette_build(pv_Palette) > 0)
+   {
+      pt_Song->as32_Size1By[2] = palette_get_size(pv_Palette, &u8_BytesPerSignal);
+      pt_Song->au32_Cycles[2] = get_cycles(2, u8_BytesPerSignal);
+   }
+   palette_close(pv_Palette);
+
+   //------------------------------------------------------------//
+   // all songs                                                  //
+   //------------------------------------------------------------//
+   if (pt_FootprintInstance->pv_Pool != NULL)
+   {
+      pool_add_signal_sequence(pt_FootprintInstance->pv_Pool, opc_Name, ou64_Order, os32_Length, opt_SignalSequence);
+   }
+   palette_add_signal_sequence(pt_FootprintInstance->pv_Palette, opc_Name, ou64_Order, os32_Length, opt_SignalSequence);
+
+   //return number of songs
+   return ++pt_FootprintInstance->s32_NumOfSongs;
+}
+
+
+/*
+   Size of all songs as written: single input -> each song in its own table respectively
+   motif play list, several inputs -> pool (no motif). Palette: common palette of all songs.
+*/
+const char * footprint_build(T_FOOTPRINT_HANDLE opv_Handle, const uint32_t ou32_MaxCycles)
+{
+   T_footprint_instance * const pt_FootprintInstance = (T_footprint_instance *)opv_Handle;
+   uint8_t u8_BytesPerSignal;
+   int32_t s32_Song;
+   int32_t s32_Format;
+
+   //preconditional check
+   if (pt_FootprintInstance->s32_NumOfSongs <= 0)
+   {
+      return NULL;
+   }
+   pt_FootprintInstance->u32_MaxCycles = ou32_MaxCycles;
+
+   //------------------------------------------------------------//
+   // per song                                                   //
+   //------------------------------------------------------------//
+   for (s32_Format = 0; s32_Format < FOOTPRINT_NUM_OF_FORMATS; ++s32_Format)
+   {
+      pt_FootprintInstance->as32_Size1By[s32_Format] = 0;
+      pt_FootprintInstance->au32_Cycles[s32_Format] = 0;
+   }
+   for (s32_Song = 0; s32_Song < pt_FootprintInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      T_footprint_song * const pt_Song = &pt_FootprintInstance->pat_Song[s32_Song];
+
+      pt_Song->s32_Best = get_smallest(pt_Song->as32_Size1By, pt_Song->au32_Cycles, ou32_MaxCycles);
+      for (s32_Format = 0; s32_Format < 2; ++s32_Format)
+      {
+         if ((pt_FootprintInstance->as32_Size1By[s32_Format] >= 0) && (pt_Song->as32_Size1By[s32_Format] >= 0))
+         {
+            pt_FootprintInstance->as32_Size1By[s32_Format] += pt_Song->as32_Size1By[s32_Format];
+         }
+         else
+         {
+            pt_FootprintInstance->as32_Size1By[s32_Format] = -1;
+         }
+         if (pt_Song->au32_Cycles[s32_Format] > pt_FootprintInstance->au32_Cycles[s32_Format])
+         {
+            pt_FootprintInstance->au32_Cycles[s32_Format] = pt_Song->au32_Cycles[s32_Format];
+         }
+      }
+   }
+
+   //------------------------------------------------------------//
+   // all songs                                                  //
+   //------------------------------------------------------------//
+   if (pt_FootprintInstance->pv_Pool != NULL)
+   {
+      const int32_t s32_PoolLength = pool_build(pt_FootprintInstance->pv_Pool);
+
+      //pool and index
+      pt_FootprintInstance->as32_Size1By[0] = ((s32_PoolLength > 0) ? ((s32_PoolLength * (int32_t)sizeof(T_sound_signal)) +
+                                                                        (pt_FootprintInstance->s32_NumOfSongs * (int32_t)sizeof(uint32_t))) : -1);
+      pt_FootprintInstance->as32_Size1By[1] = -1;
+   }
+   pt_FootprintInstance->as32_Size1By[2] = -1;
+   pt_FootprintInstance->au32_Cycles[2] = get_cycles(2, 2);
+   if (palette_build(pt_FootprintInstance->pv_Palette) > 0)
+   {
+      pt_FootprintInstance->as32_Size1By[2] = palette_get_size(pt_FootprintInstance->pv_Palette, &u8_BytesPerSignal);
+      pt_FootprintInstance->au32_Cycles[2] = get_cycles(2, u8_BytesPerSignal);
+   }
+
+   //smallest format within the budget
+   pt_FootprintInstance->s32_Selected = get_smallest(pt_FootprintInstance->as32_Size1By, pt_FootprintInstance->au32_Cycles, ou32_MaxCycles);
+   return ((pt_FootprintInstance->s32_Selected >= 0) ? mat_Decoder[pt_FootprintInstance->s32_Selected].pc_Format : NULL);
+}
+
+
+void footprint_print(T_FOOTPRINT_HANDLE opv_Handle)
+{
+   T_footprint_instance * const pt_FootprintInstance = (T_footprint_instance *)opv_Handle;
+   int32_t s32_Song;
+   int32_t s32_Format;
+
+   printf("Footprint: %d songs, grid %d/%d ms, budget %d cycles per signal%s\n", pt_FootprintInstance->s32_NumOfSongs,
+          pt_FootprintInstance->u16_GridNumerator, pt_FootprintInstance->u16_GridDenominator, pt_FootprintInstance->u32_MaxCycles,
+          ((pt_FootprintInstance->u32_MaxCycles == 0) ? " (no limit)" : ""));
+
+   //decoder cost
+   printf("\tDecoder (per signal): RAM [bytes], flash reads, divisions, cycles (%d per read, %d per division)\n",
+          FOOTPRINT_CYCLES_PER_READ, FOOTPRINT_CYCLES_PER_DIVISION);
+   for (s32_Format = 0; s32_Format < FOOTPRINT_NUM_OF_FORMATS; ++s32_Format)
+   {
+      const T_footprint_decoder * const pt_Decoder = &mat_Decoder[s32_Format];
+
+      printf("\t\t%-8s %4d %4d %4d %4d\n", pt_Decoder->pc_Format, pt_Decoder->u32_Ram1By, pt_Decoder->u32_Reads, pt_Decoder->u32_Divisions,
+             get_cycles(s32_Format, 2));
+   }
+
+   //flash size of each song on its own
+   printf("\tSongs: flash [bytes] table, motif, palette (-1: not encodable), smallest within budget\n");
+   for (s32_Song = 0; s32_Song < pt_FootprintInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      const T_footprint_song * const pt_Song = &pt_FootprintInstance->pat_Song[s32_Song];
+
+      printf("\t\t%8d %8d %8d  %-8s %d signals, %s\n", pt_Song->as32_Size1By[0], pt_Song->as32_Size1By[1], pt_Song->as32_Size1By[2],
+             ((pt_Song->s32_Best >= 0) ? mat_Decoder[pt_Song->s32_Best].pc_Format : "-"), pt_Song->s32_Signals, pt_Song->pc_Name);
+   }
+
+   //all songs as written
+   printf("\t%s: flash [bytes], max. cycles per signal\n", ((pt_FootprintInstance->u8_Batch != 0) ? "Batch (pool, common palette)" :
+                                                                                                     "All songs (tables, play lists, common palette)"));
+   for (s32_Format = 0; s32_Format < FOOTPRINT_NUM_OF_FORMATS; ++s32_Format)
+   {
+      printf("\t\t%-8s %8d %4d%s\n", mat_Decoder[s32_Format].pc_Format, pt_FootprintInstance->as32_Size1By[s32_Format],
+             pt_FootprintInstance->au32_Cycles[s32_Format], ((s32_Format == pt_FootprintInstance->s32_Selected) ? "  <- selected" : ""));
+   }
+}
+
+
+
+
+
+
+
+
+
+/*
+   Cycles per signal of a format (palette: number of bytes per signal).
+*/
+static uint32_t get_cycles(const int32_t os32_Format, const uint8_t ou8_BytesPerSignal)
+{
+   uint32_t u32_Reads = mat_Decoder[os32_Format].u32_Reads;
+
+   //one byte holds both indices
+   if ((os32_Format == 2) && (ou8_BytesPerSignal == 1))
+   {
+      --u32_Reads;
+   }
+   return (u32_Reads * FOOTPRINT_CYCLES_PER_READ) + (mat_Decoder[os32_Format].u32_Divisions * FOOTPRINT_CYCLES_PER_DIVISION);
+}
+
+
+/*
+   Smallest encodable format within the budget; on equal size the cheaper decoder (lower index).
+*/
+static int32_t get_smallest(const int32_t * const opas32_Size1By, const uint32_t * const opau32_Cycles, const uint32_t ou32_MaxCycles)
+{
+   int32_t s32_Best = -1;
+
+   for (int32_t s32_Format = 0; s32_Format < FOOTPRINT_NUM_OF_FORMATS; ++s32_Format)
+   {
+      if ((opas32_Size1By[s32_Format] >= 0) && ((ou32_MaxCycles == 0) || (opau32_Cycles[s32_Format] <= ou32_MaxCycles)) &&
+          ((s32_Best < 0) || (opas32_Size1By[s32_Format] < opas32_Size1By[s32_Best])))
+      {
+         s32_Best = s32_Format;
+      }
+   }
+   return s32_Best;
+}
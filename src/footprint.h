@@ -0,0 +1,58 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     footprint.h
+   \brief    Functions to compare the encodings of signal sequences
+
+   Every song is encoded by all available encoders (table, motif, palette),
+   additionally all songs are combined into a pool respectively a common
+   palette. The exact flash size is reported together with the RAM and
+   CPU cost of the target decoder per signal. The smallest encoding within
+   a decode budget can be selected.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _FOOTPRINT_H
+#define _FOOTPRINT_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "sound.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define FOOTPRINT_CYCLES_PER_READ      (2)     //flash access (32-bit target without wait states)
+#define FOOTPRINT_CYCLES_PER_DIVISION  (40)    //32-bit software division (no hardware divider)
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_FOOTPRINT_HANDLE;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//ou8_Batch: 0 -> songs of a single input (written one by one), 1 -> songs of several inputs (written as pool)
+extern T_FOOTPRINT_HANDLE footprint_open(const uint16_t ou16_GridNumerator, const uint16_t ou16_GridDenominator, const uint8_t ou8_Batch);
+extern void footprint_close(T_FOOTPRINT_HANDLE opv_Handle);
+
+extern int32_t footprint_add_signal_sequence(T_FOOTPRINT_HANDLE opv_Handle, const char * const opc_Name, const uint64_t ou64_Order,
+                                             const int32_t os32_Length, const T_sound_signal * opt_SignalSequence);
+//ou32_MaxCycles: decode budget per signal (0 -> no limit); returns the smallest format within the budget, NULL if there is none
+extern const char * footprint_build(T_FOOTPRINT_HANDLE opv_Handle, const uint32_t ou32_MaxCycles);
+extern void footprint_print(T_FOOTPRINT_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
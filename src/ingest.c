@@ -0,0 +1,604 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     ingest.c
+   \brief    Functions to load many files at once (batched, asynchronous I/O)
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#ifdef HAVE_IO_URING
+#define _GNU_SOURCE  //struct statx
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+#include "ingest.h"
+
+
+
+/* -- Defines ------------------------------------------------------------- */
+#define INGEST_RING_ENTRIES   (4 * INGEST_MAX_FILES_IN_FLIGHT)  //open, statx, read, close per file
+
+//operation, encoded in the lower bits of the user data
+#define INGEST_OP_OPEN        (0u)
+#define INGEST_OP_STATX       (1u)
+#define INGEST_OP_READ        (2u)
+#define INGEST_OP_CLOSE       (3u)
+#define INGEST_OP_BITS        (2u)
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   int32_t s32_File;                //index of file, -1: slot is free
+   int32_t s32_Fd;
+   int32_t s32_Error;
+   uint32_t u32_Pending;            //number of outstanding operations
+   uint8_t * pu8_Buffer;
+   uint32_t u32_Size;
+   uint32_t u32_Done;               //number of bytes read
+#ifdef HAVE_IO_URING
+   struct statx t_Statx;
+#endif
+} T_ingest_slot;
+
+
+typedef struct
+{
+   const char * const * papc_Files;
+   int32_t s32_NumOfFiles;
+   int32_t s32_NextFile;            //next file to be submitted
+   int32_t s32_InFlight;            //number of busy slots
+   T_ingest_slot at_Slot[INGEST_MAX_FILES_IN_FLIGHT];
+   int32_t as32_Completed[INGEST_MAX_FILES_IN_FLIGHT];  //FIFO of completed slots
+   uint32_t u32_CompletedHead;
+   uint32_t u32_CompletedTail;
+   //io_uring (s32_RingFd < 0: synchronous fallback)
+   int32_t s32_RingFd;
+#ifdef HAVE_IO_URING
+   void * pv_SqRing;
+   uint32_t u32_SqRingSize;
+   void * pv_CqRing;
+   uint32_t u32_CqRingSize;
+   struct io_uring_sqe * pt_Sqes;
+   uint32_t u32_SqesSize;
+   uint32_t * pu32_SqHead;
+   uint32_t * pu32_SqTail;
+   uint32_t * pu32_SqMask;
+   uint32_t * pu32_SqArray;
+   uint32_t u32_SqEntries;
+   uint32_t * pu32_CqHead;
+   uint32_t * pu32_CqTail;
+   uint32_t * pu32_CqMask;
+   struct io_uring_cqe * pt_Cqes;
+   uint32_t u32_ToSubmit;
+#endif
+} T_ingest_instance;
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static int32_t load_file(const char * const opc_File, uint8_t ** const oppu8_Buffer, uint32_t * const opu32_Size);
+#ifdef HAVE_IO_URING
+static int32_t ring_setup(T_ingest_instance * const opt_IngestInstance);
+static int32_t ring_probe(const long os32_Fd);
+static void ring_release(T_ingest_instance * const opt_IngestInstance);
+static struct io_uring_sqe * ring_get_sqe(T_ingest_instance * const opt_IngestInstance, const uint32_t ou32_Slot, const uint32_t ou32_Op);
+static int32_t ring_enter(T_ingest_instance * const opt_IngestInstance, const uint32_t ou32_MinComplete);
+static void ring_reap(T_ingest_instance * const opt_IngestInstance);
+static void submit_files(T_ingest_instance * const opt_IngestInstance);
+static void submit_read(T_ingest_instance * const opt_IngestInstance, const uint32_t ou32_Slot);
+static void complete_slot(T_ingest_instance * const opt_IngestInstance, const uint32_t ou32_Slot);
+#endif
+
+
+/* -- Implementation ------------------------------------------------------ */
+
+T_INGEST_HANDLE ingest_open(const int32_t os32_NumOfFiles, const char * const * const opapc_Files)
+{
+   T_ingest_instance * pt_IngestInstance;
+   uint32_t u32_Slot;
+
+   //------------------------------------------------------------//
+   // allocate ingest instance                                   //
+   //------------------------------------------------------------//
+   pt_IngestInstance = calloc(1, sizeof(T_ingest_instance));
+   pt_IngestInstance->papc_Files = opapc_Files;
+   pt_IngestInstance->s32_NumOfFiles = os32_NumOfFiles;
+   for (u32_Slot = 0; u32_Slot < INGEST_MAX_FILES_IN_FLIGHT; ++u32_Slot)
+   {
+      pt_IngestInstance->at_Slot[u32_Slot].s32_File = -1;
+   }
+
+   //------------------------------------------------------------//
+   // setup io_uring (fallback: synchronous read)                //
+   //------------------------------------------------------------//
+   pt_IngestInstance->s32_RingFd = -1;
+#ifdef HAVE_IO_URING
+   if (ring_setup(pt_IngestInstance) < 0)
+   {
+      printf("[W] io_uring not available, reading files one by one\n");
+   }
+#endif
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return ingest instance handle
+   return pt_IngestInstance;
+}
+
+
+void ingest_close(T_INGEST_HANDLE opv_Handle)
+{
+   T_ingest_instance * const pt_IngestInstance = (T_ingest_instance *)opv_Handle;
+
+#ifdef HAVE_IO_URING
+   //wait for outstanding operations, before their buffers are released
+   if (pt_IngestInstance->s32_RingFd >= 0)
+   {
+      uint32_t u32_Slot;
+
+      for (u32_Slot = 0; u32_Slot < INGEST_MAX_FILES_IN_FLIGHT; ++u32_Slot)
+      {
+         T_ingest_slot * const pt_Slot = &pt_IngestInstance->at_Slot[u32_Slot];
+
+         while (pt_Slot->u32_Pending > 0)
+         {
+            ring_enter(pt_IngestInstance, 1);
+            ring_reap(pt_IngestInstance);
+         }
+         free(pt_Slot->pu8_Buffer);
+      }
+      ring_release(pt_IngestInstance);
+   }
+#endif
+   //release instance itself
+   free(pt_IngestInstance);
+}
+
+
+int32_t ingest_is_async(T_INGEST_HANDLE opv_Handle)
+{
+   T_ingest_instance * const pt_IngestInstance = (T_ingest_instance *)opv_Handle;
+
+   return ((pt_IngestInstance->s32_RingFd >= 0) ? 1 : 0);
+}
+
+
+int32_t ingest_get_next(T_INGEST_HANDLE opv_Handle, int32_t * const ops32_File, uint8_t ** const oppu8_Buffer, uint32_t * const opu32_Size)
+{
+   T_ingest_instance * const pt_IngestInstance = (T_ingest_instance *)opv_Handle;
+
+   //------------------------------------------------------------//
+   // synchronous fallback                                       //
+   //------------------------------------------------------------//
+   if (pt_IngestInstance->s32_RingFd < 0)
+   {
+      if (pt_IngestInstance->s32_NextFile >= pt_IngestInstance->s32_NumOfFiles)
+      {
+         return 0;
+      }
+      *ops32_File = pt_IngestInstance->s32_NextFile++;
+      if (load_file(pt_IngestInstance->papc_Files[*ops32_File], oppu8_Buffer, opu32_Size) < 0)
+      {
+         *oppu8_Buffer = NULL;
+         *opu32_Size = 0;
+      }
+      return 1;
+   }
+
+#ifdef HAVE_IO_URING
+   //------------------------------------------------------------//
+   // io_uring                                                   //
+   //------------------------------------------------------------//
+   for (;;)
+   {
+      //keep the ring busy on every call, before anything is handed out: take the completions (the follow-up
+      //reads are queued), refill the free slots with further files and submit all of them at once
+      ring_reap(pt_IngestInstance);
+      submit_files(pt_IngestInstance);
+      if (pt_IngestInstance->u32_ToSubmit > 0)
+      {
+         ring_enter(pt_IngestInstance, 0);
+      }
+
+      //hand out the first completed file
+      if (pt_IngestInstance->u32_CompletedHead != pt_IngestInstance->u32_CompletedTail)
+      {
+         const int32_t s32_Slot = pt_IngestInstance->as32_Completed[pt_IngestInstance->u32_CompletedHead % INGEST_MAX_FILES_IN_FLIGHT];
+         T_ingest_slot * const pt_Slot = &pt_IngestInstance->at_Slot[s32_Slot];
+
+         ++pt_IngestInstance->u32_CompletedHead;
+         *ops32_File = pt_Slot->s32_File;
+         if (pt_Slot->s32_Error == 0)
+         {
+            *oppu8_Buffer = pt_Slot->pu8_Buffer;
+            *opu32_Size = pt_Slot->u32_Done;
+         }
+         else
+         {
+            free(pt_Slot->pu8_Buffer);
+            *oppu8_Buffer = NULL;
+            *opu32_Size = 0;
+         }
+         pt_Slot->pu8_Buffer = NULL;
+         //slot is reusable, as soon as its close operation is done
+         pt_Slot->s32_File = -1;
+         --pt_IngestInstance->s32_InFlight;
+         return 1;
+      }
+
+      //all done
+      if ((pt_IngestInstance->s32_InFlight == 0) && (pt_IngestInstance->s32_NextFile >= pt_IngestInstance->s32_NumOfFiles))
+      {
+         return 0;
+      }
+
+      //wait for at least one completion (reaped at the top of the loop)
+      ring_enter(pt_IngestInstance, 1);
+   }
+#else
+   return 0;
+#endif
+}
+
+
+
+
+
+
+
+
+
+static int32_t load_file(const char * const opc_File, uint8_t ** const oppu8_Buffer, uint32_t * const opu32_Size)
+{
+   struct stat t_Stat;
+   uint8_t * pu8_Buffer;
+   uint32_t u32_Done;
+   int32_t s32_Fd;
+
+   s32_Fd = open(opc_File, O_RDONLY);
+   if (s32_Fd < 0)
+   {
+      return -1;
+   }
+   if (fstat(s32_Fd, &t_Stat) < 0)
+   {
+      close(s32_Fd);
+      return -1;
+   }
+   pu8_Buffer = malloc((t_Stat.st_size > 0) ? t_Stat.st_size : 1);
+   u32_Done = 0;
+   while (u32_Done < (uint32_t)t_Stat.st_size)
+   {
+      const ssize_t s32_Read = read(s32_Fd, &pu8_Buffer[u32_Done], t_Stat.st_size - u32_Done);
+
+      if (s32_Read <= 0)
+      {
+         break;
+      }
+      u32_Done += (uint32_t)s32_Read;
+   }
+   close(s32_Fd);
+   *oppu8_Buffer = pu8_Buffer;
+   *opu32_Size = u32_Done;
+   return 0;
+}
+
+
+
+#ifdef HAVE_IO_URING
+static int32_t ring_setup(T_ingest_instance * const opt_IngestInstance)
+{
+   struct io_uring_params t_Params;
+   uint8_t * pu8_Sq;
+   uint8_t * pu8_Cq;
+   long s32_Fd;
+
+   memset(&t_Params, 0, sizeof(t_Params));
+   s32_Fd = syscall(__NR_io_uring_setup, INGEST_RING_ENTRIES, &t_Params);
+   if (s32_Fd < 0)
+   {
+      return -1;
+   }
+   //the kernel may support io_uring, but not all of the operations
+   if (ring_probe(s32_Fd) < 0)
+   {
+      close(s32_Fd);
+      return -1;
+   }
+
+   //map submission queue, completion queue and submission queue entries
+   opt_IngestInstance->u32_SqRingSize = t_Params.sq_off.array + (t_Params.sq_entries * sizeof(uint32_t));
+   opt_IngestInstance->u32_CqRingSize = t_Params.cq_off.cqes + (t_Params.cq_entries * sizeof(struct io_uring_cqe));
+   if ((t_Params.features & IORING_FEAT_SINGLE_MMAP) != 0)
+   {
+      if (opt_IngestInstance->u32_CqRingSize > opt_IngestInstance->u32_SqRingSize)
+      {
+         opt_IngestInstance->u32_SqRingSize = opt_IngestInstance->u32_CqRingSize;
+      }
+      opt_IngestInstance->u32_CqRingSize = opt_IngestInstance->u32_SqRingSize;
+   }
+   opt_IngestInstance->pv_SqRing = mmap(NULL, opt_IngestInstance->u32_SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, s32_Fd, IORING_OFF_SQ_RING);
+   if ((t_Params.features & IORING_FEAT_SINGLE_MMAP) != 0)
+   {
+      opt_IngestInstance->pv_CqRing = opt_IngestInstance->pv_SqRing;
+   }
+   else
+   {
+      opt_IngestInstance->pv_CqRing = mmap(NULL, opt_IngestInstance->u32_CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, s32_Fd, IORING_OFF_CQ_RING);
+   }
+   opt_IngestInstance->u32_SqesSize = t_Params.sq_entries * sizeof(struct io_uring_sqe);
+   opt_IngestInstance->pt_Sqes = mmap(NULL, opt_IngestInstance->u32_SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, s32_Fd, IORING_OFF_SQES);
+   if ((opt_IngestInstance->pv_SqRing == MAP_FAILED) || (opt_IngestInstance->pv_CqRing == MAP_FAILED) || (opt_IngestInstance->pt_Sqes == MAP_FAILED))
+   {
+      close(s32_Fd);
+      return -1;
+   }
+
+   pu8_Sq = opt_IngestInstance->pv_SqRing;
+   opt_IngestInstance->pu32_SqHead = (uint32_t *)&pu8_Sq[t_Params.sq_off.head];
+   opt_IngestInstance->pu32_SqTail = (uint32_t *)&pu8_Sq[t_Params.sq_off.tail];
+   opt_IngestInstance->pu32_SqMask = (uint32_t *)&pu8_Sq[t_Params.sq_off.ring_mask];
+   opt_IngestInstance->pu32_SqArray = (uint32_t *)&pu8_Sq[t_Params.sq_off.array];
+   opt_IngestInstance->u32_SqEntries = t_Params.sq_entries;
+   pu8_Cq = opt_IngestInstance->pv_CqRing;
+   opt_IngestInstance->pu32_CqHead = (uint32_t *)&pu8_Cq[t_Params.cq_off.head];
+   opt_IngestInstance->pu32_CqTail = (uint32_t *)&pu8_Cq[t_Params.cq_off.tail];
+   opt_IngestInstance->pu32_CqMask = (uint32_t *)&pu8_Cq[t_Params.cq_off.ring_mask];
+   opt_IngestInstance->pt_Cqes = (struct io_uring_cqe *)&pu8_Cq[t_Params.cq_off.cqes];
+   opt_IngestInstance->s32_RingFd = (int32_t)s32_Fd;
+   return 0;
+}
+
+
+/*
+   Check, that open, statx, read and close are supported (IORING_REGISTER_PROBE, kernel 5.6,
+   as IORING_OP_OPENAT and IORING_OP_STATX).
+*/
+static int32_t ring_probe(const long os32_Fd)
+{
+   const uint8_t au8_Op[] = { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE };
+   struct io_uring_probe * pt_Probe;
+   int32_t s32_Result;
+
+   pt_Probe = calloc(1, sizeof(struct io_uring_probe) + (256 * sizeof(struct io_uring_probe_op)));
+   s32_Result = ((syscall(__NR_io_uring_register, os32_Fd, IORING_REGISTER_PROBE, pt_Probe, 256) < 0) ? -1 : 0);
+   for (uint32_t u32_Op = 0; (s32_Result == 0) && (u32_Op < sizeof(au8_Op)); ++u32_Op)
+   {
+      if ((au8_Op[u32_Op] > pt_Probe->last_op) || ((pt_Probe->ops[au8_Op[u32_Op]].flags & IO_URING_OP_SUPPORTED) == 0))
+      {
+         s32_Result = -1;
+      }
+   }
+   free(pt_Probe);
+   return s32_Result;
+}
+
+
+static void ring_release(T_ingest_instance * const opt_IngestInstance)
+{
+   munmap(opt_IngestInstance->pt_Sqes, opt_IngestInstance->u32_SqesSize);
+   if (opt_IngestInstance->pv_CqRing != opt_IngestInstance->pv_SqRing)
+   {
+      munmap(opt_IngestInstance->pv_CqRing, opt_IngestInstance->u32_CqRingSize);
+   }
+   munmap(opt_IngestInstance->pv_SqRing, opt_IngestInstance->u32_SqRingSize);
+   close(opt_IngestInstance->s32_RingFd);
+}
+
+
+static struct io_uring_sqe * ring_get_sqe(T_ingest_instance * const opt_IngestInstance, const uint32_t ou32_Slot, const uint32_t ou32_Op)
+{
+   struct io_uring_sqe * pt_Sqe;
+   uint32_t u32_Tail;
+   uint32_t u32_Index;
+
+   //submission queue full -> hand over to the kernel first
+   u32_Tail = *opt_IngestInstance->pu32_SqTail;
+   while ((u32_Tail - __atomic_load_n(opt_IngestInstance->pu32_SqHead, __ATOMIC_ACQUIRE)) >= opt_IngestInstance->u32_SqEntries)
+   {
+      ring_enter(opt_IngestInstance, 0);
+   }
+
+   u32_Index = u32_Tail & *opt_IngestInstance->pu32_SqMask;
+   pt_Sqe = &opt_IngestInstance->pt_Sqes[u32_Index];
+   memset(pt_Sqe, 0, sizeof(*pt_Sqe));
+   pt_Sqe->user_data = ((uint64_t)ou32_Slot << INGEST_OP_BITS) | ou32_Op;
+   opt_IngestInstance->pu32_SqArray[u32_Index] = u32_Index;
+   __atomic_store_n(opt_IngestInstance->pu32_SqTail, u32_Tail + 1, __ATOMIC_RELEASE);
+   ++opt_IngestInstance->u32_ToSubmit;
+   if (ou32_Op != INGEST_OP_CLOSE)
+   {
+      ++opt_IngestInstance->at_Slot[ou32_Slot].u32_Pending;
+   }
+   return pt_Sqe;
+}
+
+
+static int32_t ring_enter(T_ingest_instance * const opt_IngestInstance, const uint32_t ou32_MinComplete)
+{
+   long s32_Submitted;
+
+   s32_Submitted = syscall(__NR_io_uring_enter, opt_IngestInstance->s32_RingFd, opt_IngestInstance->u32_ToSubmit, ou32_MinComplete,
+                           ((ou32_MinComplete > 0) ? IORING_ENTER_GETEVENTS : 0), NULL, 0);
+   if (s32_Submitted > 0)
+   {
+      opt_IngestInstance->u32_ToSubmit -= (uint32_t)s32_Submitted;
+   }
+   return (int32_t)s32_Submitted;
+}
+
+
+static void ring_reap(T_ingest_instance * const opt_IngestInstance)
+{
+   uint32_t u32_Head;
+   uint32_t u32_Tail;
+
+   u32_Head = *opt_IngestInstance->pu32_CqHead;
+   u32_Tail = __atomic_load_n(opt_IngestInstance->pu32_CqTail, __ATOMIC_ACQUIRE);
+   while (u32_Head != u32_Tail)
+   {
+      const struct io_uring_cqe * const pt_Cqe = &opt_IngestInstance->pt_Cqes[u32_Head & *opt_IngestInstance->pu32_CqMask];
+      const uint32_t u32_Slot = (uint32_t)(pt_Cqe->user_data >> INGEST_OP_BITS);
+      const uint32_t u32_Op = (uint32_t)(pt_Cqe->user_data & ((1u << INGEST_OP_BITS) - 1));
+      const int32_t s32_Result = pt_Cqe->res;
+      T_ingest_slot * const pt_Slot = &opt_IngestInstance->at_Slot[u32_Slot];
+
+      ++u32_Head;
+      __atomic_store_n(opt_IngestInstance->pu32_CqHead, u32_Head, __ATOMIC_RELEASE);
+      if (u32_Op == INGEST_OP_CLOSE)
+      {
+         continue;
+      }
+      --pt_Slot->u32_Pending;
+
+      switch (u32_Op)
+      {
+      case INGEST_OP_OPEN:
+         pt_Slot->s32_Fd = s32_Result;
+         if (s32_Result < 0)
+         {
+            pt_Slot->s32_Error = s32_Result;
+         }
+         break;
+
+      case INGEST_OP_STATX:
+         if (s32_Result < 0)
+         {
+            pt_Slot->s32_Error = s32_Result;
+         }
+         break;
+
+      case INGEST_OP_READ:
+         if (s32_Result < 0)
+         {
+            pt_Slot->s32_Error = s32_Result;
+         }
+         else if (s32_Result == 0)
+         {
+            pt_Slot->u32_Size = pt_Slot->u32_Done; //file got shorter meanwhile
+         }
+         else
+         {
+            pt_Slot->u32_Done += (uint32_t)s32_Result;
+         }
+         break;
+
+      default:
+         break;
+      }
+
+      //open and statx both done -> read whole file
+      if (pt_Slot->u32_Pending == 0)
+      {
+         if ((u32_Op != INGEST_OP_READ) && (pt_Slot->s32_Error == 0))
+         {
+            pt_Slot->u32_Size = (uint32_t)pt_Slot->t_Statx.stx_size;
+            pt_Slot->pu8_Buffer = malloc((pt_Slot->u32_Size > 0) ? pt_Slot->u32_Size : 1);
+         }
+         if ((pt_Slot->s32_Error == 0) && (pt_Slot->u32_Done < pt_Slot->u32_Size))
+         {
+            submit_read(opt_IngestInstance, u32_Slot);
+         }
+         else
+         {
+            complete_slot(opt_IngestInstance, u32_Slot);
+         }
+      }
+   }
+}
+
+
+/*
+   Open and statx are submitted at once for each file, the read follows, when both are done.
+*/
+static void submit_files(T_ingest_instance * const opt_IngestInstance)
+{
+   uint32_t u32_Slot;
+
+   for (u32_Slot = 0; u32_Slot < INGEST_MAX_FILES_IN_FLIGHT; ++u32_Slot)
+   {
+      T_ingest_slot * const pt_Slot = &opt_IngestInstance->at_Slot[u32_Slot];
+      const char * pc_File;
+      struct io_uring_sqe * pt_Sqe;
+
+      if (opt_IngestInstance->s32_NextFile >= opt_IngestInstance->s32_NumOfFiles)
+      {
+         return;
+      }
+      //slot still busy (or its close operation is outstanding)
+      if ((pt_Slot->s32_File >= 0) || (pt_Slot->u32_Pending > 0))
+      {
+         continue;
+      }
+
+      pt_Slot->s32_File = opt_IngestInstance->s32_NextFile++;
+      pt_Slot->s32_Fd = -1;
+      pt_Slot->s32_Error = 0;
+      pt_Slot->pu8_Buffer = NULL;
+      pt_Slot->u32_Size = 0;
+      pt_Slot->u32_Done = 0;
+      ++opt_IngestInstance->s32_InFlight;
+      pc_File = opt_IngestInstance->papc_Files[pt_Slot->s32_File];
+
+      pt_Sqe = ring_get_sqe(opt_IngestInstance, u32_Slot, INGEST_OP_OPEN);
+      pt_Sqe->opcode = IORING_OP_OPENAT;
+      pt_Sqe->fd = AT_FDCWD;
+      pt_Sqe->addr = (uint64_t)(uintptr_t)pc_File;
+      pt_Sqe->open_flags = O_RDONLY;
+
+      pt_Sqe = ring_get_sqe(opt_IngestInstance, u32_Slot, INGEST_OP_STATX);
+      pt_Sqe->opcode = IORING_OP_STATX;
+      pt_Sqe->fd = AT_FDCWD;
+      pt_Sqe->addr = (uint64_t)(uintptr_t)pc_File;
+      pt_Sqe->len = STATX_SIZE;
+      pt_Sqe->addr2 = (uint64_t)(uintptr_t)&pt_Slot->t_Statx;
+   }
+}
+
+
+static void submit_read(T_ingest_instance * const opt_IngestInstance, const uint32_t ou32_Slot)
+{
+   T_ingest_slot * const pt_Slot = &opt_IngestInstance->at_Slot[ou32_Slot];
+   struct io_uring_sqe * pt_Sqe;
+
+   pt_Sqe = ring_get_sqe(opt_IngestInstance, ou32_Slot, INGEST_OP_READ);
+   pt_Sqe->opcode = IORING_OP_READ;
+   pt_Sqe->fd = pt_Slot->s32_Fd;
+   pt_Sqe->addr = (uint64_t)(uintptr_t)&pt_Slot->pu8_Buffer[pt_Slot->u32_Done];
+   pt_Sqe->len = pt_Slot->u32_Size - pt_Slot->u32_Done;
+   pt_Sqe->off = pt_Slot->u32_Done;
+}
+
+
+static void complete_slot(T_ingest_instance * const opt_IngestInstance, const uint32_t ou32_Slot)
+{
+   T_ingest_slot * const pt_Slot = &opt_IngestInstance->at_Slot[ou32_Slot];
+
+   //close asynchronously, the result is not of interest
+   if (pt_Slot->s32_Fd >= 0)
+   {
+      struct io_uring_sqe * const pt_Sqe = ring_get_sqe(opt_IngestInstance, ou32_Slot, INGEST_OP_CLOSE);
+
+      pt_Sqe->opcode = IORING_OP_CLOSE;
+      pt_Sqe->fd = pt_Slot->s32_Fd;
+      pt_Slot->s32_Fd = -1;
+   }
+   opt_IngestInstance->as32_Completed[opt_IngestInstance->u32_CompletedTail % INGEST_MAX_FILES_IN_FLIGHT] = (int32_t)ou32_Slot;
+   ++opt_IngestInstance->u32_CompletedTail;
+}
+#endif
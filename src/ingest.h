@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     ingest.h
+   \brief    Functions to load many files at once (batched, asynchronous I/O)
+
+   Opening, sizing and reading of several files is submitted to the kernel at
+   once (io_uring, Linux). Loaded files are handed out in order of completion,
+   so the caller can decode one file, while the others are still being read.
+   If io_uring is not available, the files are read one by one.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _INGEST_H
+#define _INGEST_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define INGEST_MAX_FILES_IN_FLIGHT  (32)
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_INGEST_HANDLE;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+extern T_INGEST_HANDLE ingest_open(const int32_t os32_NumOfFiles, const char * const * const opapc_Files);
+extern void ingest_close(T_INGEST_HANDLE opv_Handle);
+
+//get next loaded file: returns 1 if a file is provided (buffer is NULL if it could not be loaded), 0 if all files are done.
+//the buffer is allocated by malloc, the caller takes ownership.
+extern int32_t ingest_get_next(T_INGEST_HANDLE opv_Handle, int32_t * const ops32_File, uint8_t ** const oppu8_Buffer, uint32_t * const opu32_Size);
+extern int32_t ingest_is_async(T_INGEST_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
@@ -0,0 +1,341 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     ir.c
+   \brief    Functions to store and map the decoded note events of a midi file
+
+   File layout (host byte order, checked by a byte order mark; all blocks 8 byte aligned):
+      header (T_ir_header)
+      track table (T_ir_track per track)
+      per track: note events (+ terminating event), tempo map
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ir.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define IR_BYTE_ORDER               (0x01020304uL)
+#define IR_ALIGN(x)                 (((x) + 7u) & ~(uint64_t)7u)
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   char acn_Magic[8];                  //"MIDIIR"
+   uint32_t u32_Version;
+   uint32_t u32_ByteOrder;
+   uint16_t u16_FormatType;
+   uint16_t u16_NumOfTracks;
+   uint16_t u16_TimeDivision;
+   uint16_t u16_Reserved;
+   uint32_t u32_TrackSize;             //sizeof(T_ir_track)
+   uint32_t u32_NoteSize;              //sizeof(T_midi_event_note)
+   uint64_t u64_Tracks;                //offset of track table
+   uint64_t u64_FileSize;
+   uint8_t au8_Reserved[16];
+} T_ir_header;
+
+
+typedef struct
+{
+   uint64_t u64_NoteEvents;            //offset of note events
+   uint64_t u64_Tempos;                //offset of tempo map
+   int32_t s32_NumOfNoteEvents;        //-1: invalid data
+   uint32_t u32_NumOfTempos;
+   T_midi_event_statistic t_Statistic;
+   uint32_t u32_Reserved;
+} T_ir_track;
+
+
+typedef struct
+{
+   uint8_t * pu8_File;                 //mapped file
+   uint64_t u64_FileSize;
+   const T_ir_header * pt_Header;
+   const T_ir_track * pat_Track;
+} T_ir_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void write_aligned(FILE * const opv_File, const void * const opv_Data, const uint64_t ou64_Size, uint64_t * const opu64_Offset);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+int32_t ir_write(const char * const opc_File, T_MIDI_HANDLE opv_Midi)
+{
+   T_midi_header_chunk t_HeaderChunk;
+   T_ir_header t_Header;
+   T_ir_track * pat_Track;
+   FILE * pv_File;
+   uint64_t u64_Offset;
+   uint32_t u32_Track;
+   int32_t s32_Result;
+
+   midi_get_header_chunk(opv_Midi, &t_HeaderChunk);
+   pv_File = fopen(opc_File, "wb");
+   if (pv_File == NULL)
+   {
+      return -1;
+   }
+
+   //------------------------------------------------------------//
+   // header and track table (rewritten at the end)              //
+   //------------------------------------------------------------//
+   memset(&t_Header, 0, sizeof(t_Header));
+   memcpy(t_Header.acn_Magic, "MIDIIR", 6);
+   t_Header.u32_Version = IR_VERSION;
+   t_Header.u32_ByteOrder = IR_BYTE_ORDER;
+   t_Header.u16_FormatType = t_HeaderChunk.u16_FormatType;
+   t_Header.u16_NumOfTracks = t_HeaderChunk.u16_NumOfTracks;
+   t_Header.u16_TimeDivision = t_HeaderChunk.u16_TimeDivision;
+   t_Header.u32_TrackSize = sizeof(T_ir_track);
+   t_Header.u32_NoteSize = sizeof(T_midi_event_note);
+   t_Header.u64_Tracks = sizeof(T_ir_header);
+   pat_Track = calloc(t_HeaderChunk.u16_NumOfTracks + 1, sizeof(T_ir_track));
+   u64_Offset = 0;
+   write_aligned(pv_File, &t_Header, sizeof(t_Header), &u64_Offset);
+   write_aligned(pv_File, pat_Track, t_HeaderChunk.u16_NumOfTracks * sizeof(T_ir_track), &u64_Offset);
+
+   //------------------------------------------------------------//
+   // decode each track                                          //
+   //------------------------------------------------------------//
+   for (u32_Track = 0; u32_Track < t_HeaderChunk.u16_NumOfTracks; ++u32_Track)
+   {
+      T_ir_track * const pt_Track = &pat_Track[u32_Track];
+      const T_midi_event_note t_Terminator = { 0, 0, 0, 0, 0 };
+      T_midi_track_chunk t_TrackChunk;
+      T_MIDI_EVENT_HANDLE pv_MidiEvent;
+      T_midi_event_note * pt_NoteEvents;
+      T_midi_event_tempo * pat_Tempo;
+      uint32_t u32_MaxTempos;
+
+      pt_Track->s32_NumOfNoteEvents = -1;
+      pt_Track->u64_NoteEvents = u64_Offset;
+      pt_Track->u64_Tempos = u64_Offset;
+      if (midi_get_track_chunk(opv_Midi, u32_Track, &t_TrackChunk) < 0)
+      {
+         write_aligned(pv_File, &t_Terminator, sizeof(t_Terminator), &u64_Offset);
+         pt_Track->u64_Tempos = u64_Offset;
+         continue;
+      }
+      pv_MidiEvent = midi_event_open(&t_TrackChunk);
+
+      //note events, terminated by a zero length event (sound_get_signal_sequence looks one event ahead)
+      pt_Track->s32_NumOfNoteEvents = midi_event_get_note_events(pv_MidiEvent, &pt_NoteEvents);
+      if (pt_Track->s32_NumOfNoteEvents >= 0)
+      {
+         fwrite(pt_NoteEvents, sizeof(T_midi_event_note), (size_t)pt_Track->s32_NumOfNoteEvents, pv_File);
+         u64_Offset += (uint64_t)pt_Track->s32_NumOfNoteEvents * sizeof(T_midi_event_note);
+      }
+      write_aligned(pv_File, &t_Terminator, sizeof(t_Terminator), &u64_Offset);
+
+      //tempo map (a tempo event takes at least 7 bytes) and statistic
+      u32_MaxTempos = (t_TrackChunk.u32_ChunkSize / 7) + 1;
+      pat_Tempo = malloc(u32_MaxTempos * sizeof(T_midi_event_tempo));
+      midi_event_get_statistic(pv_MidiEvent, &pt_Track->t_Statistic, pat_Tempo, u32_MaxTempos, NULL, 0);
+      pt_Track->u32_NumOfTempos = ((pt_Track->t_Statistic.u32_NumOfTempos < u32_MaxTempos) ? pt_Track->t_Statistic.u32_NumOfTempos : u32_MaxTempos);
+      pt_Track->u64_Tempos = u64_Offset;
+      write_aligned(pv_File, pat_Tempo, pt_Track->u32_NumOfTempos * sizeof(T_midi_event_tempo), &u64_Offset);
+      free(pat_Tempo);
+      midi_event_close(pv_MidiEvent);
+   }
+
+   //------------------------------------------------------------//
+   // finalize header and track table                            //
+   //------------------------------------------------------------//
+   t_Header.u64_FileSize = u64_Offset;
+   fseek(pv_File, 0, SEEK_SET);
+   fwrite(&t_Header, sizeof(t_Header), 1, pv_File);
+   fwrite(pat_Track, sizeof(T_ir_track), t_HeaderChunk.u16_NumOfTracks, pv_File);
+   free(pat_Track);
+   s32_Result = ((ferror(pv_File) != 0) ? -1 : 0);
+   if (fclose(pv_File) != 0)
+   {
+      s32_Result = -1;
+   }
+   if (s32_Result < 0)
+   {
+      remove(opc_File);
+   }
+   return s32_Result;
+}
+
+
+T_IR_HANDLE ir_open(const char * const opc_File)
+{
+   T_ir_instance * pt_IrInstance;
+   struct stat t_Stat;
+   const T_ir_header * pt_Header;
+   uint8_t * pu8_File;
+   uint64_t u64_FileSize;
+   int s32_File;
+
+   //------------------------------------------------------------//
+   // map file                                                   //
+   //------------------------------------------------------------//
+   s32_File = open(opc_File, O_RDONLY);
+   if (s32_File < 0)
+   {
+      return 0;
+   }
+   if ((fstat(s32_File, &t_Stat) < 0) || ((uint64_t)t_Stat.st_size < sizeof(T_ir_header)))
+   {
+      close(s32_File);
+      return 0;
+   }
+   u64_FileSize = (uint64_t)t_Stat.st_size;
+   pu8_File = mmap(NULL, (size_t)u64_FileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, s32_File, 0);
+   close(s32_File);
+   if (pu8_File == MAP_FAILED)
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // check header and track table                               //
+   //------------------------------------------------------------//
+   pt_Header = (const T_ir_header *)pu8_File;
+   if ((memcmp(pt_Header->acn_Magic, "MIDIIR", 6) != 0) || (pt_Header->u32_Version != IR_VERSION) ||
+       (pt_Header->u32_ByteOrder != IR_BYTE_ORDER) || (pt_Header->u32_TrackSize != sizeof(T_ir_track)) ||
+       (pt_Header->u32_NoteSize != sizeof(T_midi_event_note)) || (pt_Header->u64_FileSize != u64_FileSize) ||
+       (pt_Header->u64_Tracks != sizeof(T_ir_header)) ||
+       (((u64_FileSize - sizeof(T_ir_header)) / sizeof(T_ir_track)) < pt_Header->u16_NumOfTracks))
+   {
+      munmap(pu8_File, (size_t)u64_FileSize);
+      return 0;
+   }
+   for (uint32_t u32_Track = 0; u32_Track < pt_Header->u16_NumOfTracks; ++u32_Track)
+   {
+      const T_ir_track * const pt_Track = &((const T_ir_track *)&pu8_File[pt_Header->u64_Tracks])[u32_Track];
+      const uint64_t u64_NumOfNoteEvents = ((pt_Track->s32_NumOfNoteEvents > 0) ? (uint64_t)pt_Track->s32_NumOfNoteEvents : 0) + 1;
+
+      if (((pt_Track->u64_NoteEvents % 8) != 0) || ((pt_Track->u64_Tempos % 8) != 0) ||
+          (pt_Track->u64_NoteEvents > u64_FileSize) || (((u64_FileSize - pt_Track->u64_NoteEvents) / sizeof(T_midi_event_note)) < u64_NumOfNoteEvents) ||
+          (pt_Track->u64_Tempos > u64_FileSize) || (((u64_FileSize - pt_Track->u64_Tempos) / sizeof(T_midi_event_tempo)) < pt_Track->u32_NumOfTempos))
+      {
+         munmap(pu8_File, (size_t)u64_FileSize);
+         return 0;
+      }
+      //value ranges, as used as table indices later on (no decoding)
+      for (uint64_t u64_Count = 0; u64_Count < u64_NumOfNoteEvents; ++u64_Count)
+      {
+         const T_midi_event_note * const pt_NoteEvent = &((const T_midi_event_note *)&pu8_File[pt_Track->u64_NoteEvents])[u64_Count];
+
+         if ((pt_NoteEvent->u8_OnOff > 1) || (pt_NoteEvent->u8_Channel > 0x0F) || (pt_NoteEvent->u8_Note > 0x7F))
+         {
+            munmap(pu8_File, (size_t)u64_FileSize);
+            return 0;
+         }
+      }
+   }
+
+   //------------------------------------------------------------//
+   // allocate IR instance                                       //
+   //------------------------------------------------------------//
+   pt_IrInstance = malloc(sizeof(T_ir_instance));
+   pt_IrInstance->pu8_File = pu8_File;
+   pt_IrInstance->u64_FileSize = u64_FileSize;
+   pt_IrInstance->pt_Header = pt_Header;
+   pt_IrInstance->pat_Track = (const T_ir_track *)&pu8_File[pt_Header->u64_Tracks];
+
+   //return IR instance handle
+   return pt_IrInstance;
+}
+
+
+void ir_close(T_IR_HANDLE opv_Handle)
+{
+   T_ir_instance * const pt_IrInstance = (T_ir_instance *)opv_Handle;
+
+   //release mapping and instance itself
+   munmap(pt_IrInstance->pu8_File, (size_t)pt_IrInstance->u64_FileSize);
+   free(pt_IrInstance);
+}
+
+
+void ir_get_header_chunk(T_IR_HANDLE opv_Handle, T_midi_header_chunk * const opt_HeaderChunk)
+{
+   T_ir_instance * const pt_IrInstance = (T_ir_instance *)opv_Handle;
+
+   memset(opt_HeaderChunk, 0, sizeof(T_midi_header_chunk));
+   memcpy(opt_HeaderChunk->acn_ChunkId, "MThd", 4);
+   opt_HeaderChunk->u32_ChunkSize = 6;
+   opt_HeaderChunk->u16_FormatType = pt_IrInstance->pt_Header->u16_FormatType;
+   opt_HeaderChunk->u16_NumOfTracks = pt_IrInstance->pt_Header->u16_NumOfTracks;
+   opt_HeaderChunk->u16_TimeDivision = pt_IrInstance->pt_Header->u16_TimeDivision;
+}
+
+
+int32_t ir_get_note_events(T_IR_HANDLE opv_Handle, const uint32_t ou32_Track, T_midi_event_note ** oppt_NoteEvents)
+{
+   T_ir_instance * const pt_IrInstance = (T_ir_instance *)opv_Handle;
+
+   if (ou32_Track >= pt_IrInstance->pt_Header->u16_NumOfTracks)
+   {
+      return -1;
+   }
+   *oppt_NoteEvents = (T_midi_event_note *)&pt_IrInstance->pu8_File[pt_IrInstance->pat_Track[ou32_Track].u64_NoteEvents];
+   return pt_IrInstance->pat_Track[ou32_Track].s32_NumOfNoteEvents;
+}
+
+
+int32_t ir_get_tempo_map(T_IR_HANDLE opv_Handle, const uint32_t ou32_Track, const T_midi_event_tempo ** oppt_Tempos)
+{
+   T_ir_instance * const pt_IrInstance = (T_ir_instance *)opv_Handle;
+
+   if (ou32_Track >= pt_IrInstance->pt_Header->u16_NumOfTracks)
+   {
+      return -1;
+   }
+   *oppt_Tempos = (const T_midi_event_tempo *)&pt_IrInstance->pu8_File[pt_IrInstance->pat_Track[ou32_Track].u64_Tempos];
+   return (int32_t)pt_IrInstance->pat_Track[ou32_Track].u32_NumOfTempos;
+}
+
+
+int32_t ir_get_statistic(T_IR_HANDLE opv_Handle, const uint32_t ou32_Track, T_midi_event_statistic * const opt_Statistic)
+{
+   T_ir_instance * const pt_IrInstance = (T_ir_instance *)opv_Handle;
+
+   if (ou32_Track >= pt_IrInstance->pt_Header->u16_NumOfTracks)
+   {
+      return -1;
+   }
+   *opt_Statistic = pt_IrInstance->pat_Track[ou32_Track].t_Statistic;
+   return 0;
+}
+
+
+
+
+
+
+
+
+
+//write data and pad to the next multiple of 8 bytes
+static void write_aligned(FILE * const opv_File, const void * const opv_Data, const uint64_t ou64_Size, uint64_t * const opu64_Offset)
+{
+   static const uint8_t au8_Zero[8] = { 0 };
+   const uint64_t u64_End = IR_ALIGN(*opu64_Offset + ou64_Size);
+
+   if (ou64_Size > 0)
+   {
+      fwrite(opv_Data, 1, (size_t)ou64_Size, opv_File);
+   }
+   fwrite(au8_Zero, 1, (size_t)(u64_End - (*opu64_Offset + ou64_Size)), opv_File);
+   *opu64_Offset = u64_End;
+}
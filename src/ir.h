@@ -0,0 +1,61 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     ir.h
+   \brief    Functions to store and map the decoded note events of a midi file
+
+   The intermediate representation (IR) holds the note events, the tempo map and
+   the statistic of each track in the memory layout of T_midi_event_note,
+   T_midi_event_tempo and T_midi_event_statistic. It is mapped into memory as is,
+   so subsequent conversions (e.g. with other options) don't decode the midi file
+   again. The mapping is private: changes (e.g. by midi_event_strip_redundant_note_events)
+   don't modify the file.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _IR_H
+#define _IR_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "midi.h"
+#include "midi_event.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define IR_VERSION                  (1u)
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_IR_HANDLE;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//decode all tracks of the midi file and write them to the IR file
+extern int32_t ir_write(const char * const opc_File, T_MIDI_HANDLE opv_Midi);
+//map IR file; returns 0 if the file is invalid (or of another version)
+extern T_IR_HANDLE ir_open(const char * const opc_File);
+extern void ir_close(T_IR_HANDLE opv_Handle);
+
+extern void ir_get_header_chunk(T_IR_HANDLE opv_Handle, T_midi_header_chunk * const opt_HeaderChunk);
+//note events of the track (terminated by an additional event with delta time 0); returns -1 if the track has invalid data
+extern int32_t ir_get_note_events(T_IR_HANDLE opv_Handle, const uint32_t ou32_Track, T_midi_event_note ** oppt_NoteEvents);
+extern int32_t ir_get_tempo_map(T_IR_HANDLE opv_Handle, const uint32_t ou32_Track, const T_midi_event_tempo ** oppt_Tempos);
+extern int32_t ir_get_statistic(T_IR_HANDLE opv_Handle, const uint32_t ou32_Track, T_midi_event_statistic * const opt_Statistic);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
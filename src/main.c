@@ -2,104 +2,1346 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 #include "midi.h"
 #include "midi_event.h"
 #include "sound.h"
+#include "motif.h"
+#include "voice.h"
+#include "pool.h"
+#include "ingest.h"
+#include "analyze.h"
+#include "pipeline.h"
+#include "palette.h"
+#include "checkpoint.h"
+#include "object.h"
+#include "timer.h"
+#include "ir.h"
+#include "watch.h"
+#include "tick.h"
+#include "footprint.h"
+#include "play.h"
+#include "chunk.h"
 
 
+typedef struct
+{
+   const char * outputFile;
+   const char * outputFormat;
+   int32_t s32_MaxGapTicks;   //-1: derived from time division
+   uint8_t u8_NumOfVoices;
+   T_voice_steal e_VoiceSteal;
+   uint8_t au8_ChannelPriority[VOICE_NUM_OF_CHANNELS];
+   const char * analyzeDirectory;
+   uint32_t u32_NumOfThreads;    //0: number of online CPUs
+   uint32_t u32_FlashBudget1By;  //0: no limit
+   uint32_t u32_PipelineBlockSize; //0: sequential conversion
+   uint8_t u8_Fused;             //1: decode and convert in a single pass (no note event array)
+   uint16_t u16_MinSignal1ms;    //0: keep all signals
+   T_sound_absorb e_Absorb;
+   uint16_t u16_GridNumerator;   //palette: duration grid [1ms] = numerator / denominator
+   uint16_t u16_GridDenominator;
+   uint8_t u8_Window;            //0: whole song, 1: time window [u32_From1ms, u32_To1ms)
+   uint32_t u32_From1ms;
+   uint32_t u32_To1ms;
+   uint32_t u32_CheckpointTicks; //0: derived from time division
+   T_object_machine e_Machine;   //object formats
+   const char * objectSection;
+   const char * objectSymbol;
+   uint32_t u32_TimerClock1Hz;   //0: frequencies in Hz
+   const char * timerPrescalers;
+   T_TIMER_HANDLE pv_Timer;      //reload values of the target timer (table format)
+   T_TICK_HANDLE pv_Tick;        //tempo map of the current song (ticks format)
+   uint32_t u32_StartTick;       //absolute time, the first note event refers to (ticks format)
+   const char * irFile;          //decoded note events (input instead of midi files)
+   const char * irOutputFile;    //decoded note events of the midi file (written in addition)
+   uint16_t u16_ChannelMask;     //0: all channels in one table, else one table per selected channel (bit n: channel n + 1)
+   const char * watchDirectory;  //midi files are converted whenever they change (output directory: -o)
+   uint32_t u32_Debounce1ms;
+   uint8_t u8_Footprint;         //0: off, 1: report only, 2: report and convert to the smallest format
+   uint32_t u32_MaxCycles;       //decode budget per signal of the smallest format (0: no limit)
+   T_FOOTPRINT_HANDLE pv_Footprint; //signal sequences are encoded by all formats (nothing is written)
+   const char * playSink;        //signal sequences are played in real time (in addition to the output)
+   T_play_clock e_PlayClock;
+   uint32_t u32_PlayPriority;    //0: normal scheduling, else SCHED_FIFO
+   T_PLAY_HANDLE pv_Play;
+   uint16_t u16_BlockSize;       //chunks format: block size [bytes] (page or sector of the external flash)
+} T_options;
 
 
-int main(int argc, char ** argv)
+/*
+   Rests shorter than 1/32 beat (respectively ~1/64 second for SMPTE time division)
+   are treated as redundant.
+*/
+static int32_t get_default_max_gap_ticks(const uint16_t ou16_TimeDivision)
 {
-   const char * inputFile = NULL;
-   const char * outputFile = NULL;
-   T_midi_header_chunk t_HeaderChunk;
+   if (ou16_TimeDivision <= 0x7FFFu)
+   {
+      return ou16_TimeDivision / 32;
+   }
+   return ((ou16_TimeDivision & 0x00FFu) * ((ou16_TimeDivision & 0x7F00u) >> 8)) / 64;
+}
+
+
+/*
+   Parse channel priorities, given as comma separated list of <channel>=<priority>
+   (channel 1..16, as usually displayed, priority 0..255), e.g. "10=0,1=2". Unlisted channels have priority 1.
+   Returns -1 if the list is invalid.
+*/
+static int32_t parse_channel_priority(const char * opc_List, uint8_t * const opau8_ChannelPriority)
+{
+   char * pc_End;
+   const char * pc_Priority;
+   int32_t s32_Channel;
+   int32_t s32_Priority;
+   uint32_t u32_Channel;
+
+   for (u32_Channel = 0; u32_Channel < VOICE_NUM_OF_CHANNELS; ++u32_Channel)
+   {
+      opau8_ChannelPriority[u32_Channel] = 1;
+   }
+   while (*opc_List != 0)
+   {
+      s32_Channel = (int32_t)strtol(opc_List, &pc_End, 10);
+      if ((pc_End == opc_List) || (*pc_End != '=') || (s32_Channel < 1) || (s32_Channel > VOICE_NUM_OF_CHANNELS))
+      {
+         printf("[E] Invalid channel priority %s!\n", opc_List);
+         return -1;
+      }
+      pc_Priority = &pc_End[1];
+      s32_Priority = (int32_t)strtol(pc_Priority, &pc_End, 10);
+      if ((pc_End == pc_Priority) || (s32_Priority < 0) || (s32_Priority > 255) || ((*pc_End != ',') && (*pc_End != 0)))
+      {
+         printf("[E] Invalid channel priority %s!\n", opc_List);
+         return -1;
+      }
+      opau8_ChannelPriority[s32_Channel - 1] = (uint8_t)s32_Priority;
+      opc_List = ((*pc_End == ',') ? &pc_End[1] : pc_End);
+   }
+   return 0;
+}
+
+
+/*
+   Parse a list of channels and channel ranges (channel 1..16), e.g. "1-9,11", into a channel mask.
+   Returns -1 if the list is empty or invalid.
+*/
+static int32_t parse_channels(const char * opc_List, uint16_t * const opu16_Mask)
+{
+   char * pc_End;
+   int32_t s32_First;
+   int32_t s32_Last;
+
+   *opu16_Mask = 0;
+   if (*opc_List == 0)
+   {
+      printf("[E] No channels given!\n");
+      return -1;
+   }
+   while (*opc_List != 0)
+   {
+      s32_First = (int32_t)strtol(opc_List, &pc_End, 10);
+      s32_Last = ((*pc_End == '-') ? (int32_t)strtol(&pc_End[1], &pc_End, 10) : s32_First);
+      if ((pc_End == opc_List) || (s32_First < 1) || (s32_Last > 16) || (s32_First > s32_Last) || ((*pc_End != ',') && (*pc_End != 0)))
+      {
+         printf("[E] Invalid channels %s!\n", opc_List);
+         return -1;
+      }
+      for (; s32_First <= s32_Last; ++s32_First)
+      {
+         *opu16_Mask |= (uint16_t)(1u << (s32_First - 1));
+      }
+      opc_List = ((*pc_End == ',') ? &pc_End[1] : pc_End);
+   }
+   return 0;
+}
+
+
+/*
+   Parse duration grid of the palette format: either a fraction of a beat (e.g. "1/64",
+   500ms per beat as assumed by sound_get_ms_per_tick), or milliseconds (e.g. "10").
+   Numerator and denominator have to fit 16 bit (at most 131 beats respectively 65535ms),
+   otherwise the grid is set to 0/0 (rejected by the palette and footprint).
+*/
+static void parse_grid(const char * const opc_Grid, uint16_t * const opu16_Numerator, uint16_t * const opu16_Denominator)
+{
+   char * pc_End;
+   long s32_Numerator = strtol(opc_Grid, &pc_End, 10);
+   long s32_Denominator = 1;
+
+   if (*pc_End == '/')
+   {
+      s32_Numerator = ((s32_Numerator <= (UINT16_MAX / 500)) ? (500 * s32_Numerator) : 0);
+      s32_Denominator = strtol(&pc_End[1], NULL, 10);
+   }
+   if ((s32_Numerator <= 0) || (s32_Numerator > UINT16_MAX) || (s32_Denominator <= 0) || (s32_Denominator > UINT16_MAX))
+   {
+      printf("[E] Invalid grid %s!\n", opc_Grid);
+      s32_Numerator = 0;
+      s32_Denominator = 0;
+   }
+   *opu16_Numerator = (uint16_t)s32_Numerator;
+   *opu16_Denominator = (uint16_t)s32_Denominator;
+}
+
+/*
+   Parse a point in time: either "<minutes>:<seconds>" or "<seconds>" (fractions of a second allowed),
+   e.g. "1:30.5" or "90.5". Returns the time in milliseconds.
+*/
+static uint32_t parse_time(const char * const opc_Time)
+{
+   char * pc_End;
+   double f64_Seconds;
+
+   f64_Seconds = strtod(opc_Time, &pc_End);
+   if (*pc_End == ':')
+   {
+      f64_Seconds = (60.0 * f64_Seconds) + strtod(&pc_End[1], NULL);
+   }
+   return ((f64_Seconds > 0.0) ? (uint32_t)((f64_Seconds * 1000.0) + 0.5) : 0);
+}
+
+
+/*
+   Checkpoints every 4 beats (respectively every second for SMPTE time division).
+   The index is taken from the sidecar file <input>.ckp, or built and stored there
+   (if the file is missing or was built with another interval).
+*/
+static T_CHECKPOINT_HANDLE get_checkpoints(const char * const opc_InputFile, T_MIDI_HANDLE opv_Midi,
+                                           const uint16_t ou16_TimeDivision, const uint32_t ou32_IntervalTicks)
+{
+   T_CHECKPOINT_HANDLE pv_Checkpoint;
+   char acn_File[1024];
+   uint32_t u32_IntervalTicks;
+
+   u32_IntervalTicks = ou32_IntervalTicks;
+   if (u32_IntervalTicks == 0)
+   {
+      u32_IntervalTicks = ((ou16_TimeDivision <= 0x7FFFu) ? (4u * ou16_TimeDivision) :
+                           ((ou16_TimeDivision & 0x00FFu) * ((ou16_TimeDivision & 0x7F00u) >> 8)));
+   }
+   snprintf(acn_File, sizeof(acn_File), "%s.ckp", opc_InputFile);
+   pv_Checkpoint = checkpoint_load(acn_File, opv_Midi, u32_IntervalTicks);
+   if (pv_Checkpoint == 0)
+   {
+      pv_Checkpoint = checkpoint_open(opv_Midi, u32_IntervalTicks);
+      if ((pv_Checkpoint != 0) && (checkpoint_save(acn_File, pv_Checkpoint) < 0))
+      {
+         printf("[W] Cannot write checkpoint file %s!\n", acn_File);
+      }
+   }
+   if (pv_Checkpoint != 0)
+   {
+      checkpoint_print_statistic(pv_Checkpoint);
+   }
+   return pv_Checkpoint;
+}
+
+
+
+/*
+   Demultiplex the note events of a track by channel and write one table per selected channel
+   (symbol: <symbol>Ch<channel>). The track is decoded only once.
+*/
+static void convert_channels(const uint16_t ou16_TimeDivision, const uint32_t ou32_MaxGapTicks, const int32_t os32_NoteEvents,
+                             const T_midi_event_note * const opt_NoteEvents, const T_options * const opt_Options)
+{
+   T_midi_event_note * pt_ChannelEvents;
+   int32_t as32_NumOfEvents[16];
+   T_SOUND_HANDLE apv_Sound[16];
+   char aacn_Symbol[16][128];
+   const char * apc_Symbol[16];
+   int32_t as32_SignalSequence[16];
+   const T_sound_signal * apt_SignalSequence[16];
+   uint32_t u32_NumOfSequences;
+   uint32_t u32_Channel;
+   int32_t s32_Offset;
+
+   pt_ChannelEvents = malloc((os32_NoteEvents + 16) * sizeof(T_midi_event_note));
+   midi_event_split_channels(os32_NoteEvents, opt_NoteEvents, opt_Options->u16_ChannelMask, pt_ChannelEvents, as32_NumOfEvents);
+
+   //for each selected channel
+   u32_NumOfSequences = 0;
+   s32_Offset = 0;
+   for (u32_Channel = 0; u32_Channel < 16; ++u32_Channel)
+   {
+      T_midi_event_note * const pt_NoteEvents = &pt_ChannelEvents[s32_Offset];
+      T_sound_signal * pt_SignalSequence;
+      int32_t s32_SignalSequence;
+      int32_t s32_NoteEvents;
+
+      if (as32_NumOfEvents[u32_Channel] == 0)
+      {
+         continue;
+      }
+      s32_Offset += as32_NumOfEvents[u32_Channel];
+      s32_NoteEvents = midi_event_strip_redundant_note_events(as32_NumOfEvents[u32_Channel], pt_NoteEvents, ou32_MaxGapTicks);
+      if (s32_NoteEvents <= 0)
+      {
+         continue;
+      }
+      apv_Sound[u32_NumOfSequences] = sound_open(s32_NoteEvents, pt_NoteEvents, ou16_TimeDivision);
+      s32_SignalSequence = sound_get_signal_sequence(apv_Sound[u32_NumOfSequences], &pt_SignalSequence);
+      if (s32_SignalSequence > 0)
+      {
+         T_sound_interrupt_statistic t_InterruptStatistic;
+
+         if (opt_Options->u16_MinSignal1ms > 0)
+         {
+            s32_SignalSequence = sound_filter_short_signals(s32_SignalSequence, pt_SignalSequence, opt_Options->u16_MinSignal1ms, opt_Options->e_Absorb);
+         }
+         printf("Channel %d\n", u32_Channel + 1);
+         sound_get_interrupt_statistic(s32_SignalSequence, pt_SignalSequence, &t_InterruptStatistic);
+         sound_print_interrupt_statistic(&t_InterruptStatistic);
+      }
+      snprintf(aacn_Symbol[u32_NumOfSequences], sizeof(aacn_Symbol[0]), "%sCh%d", opt_Options->objectSymbol, u32_Channel + 1);
+      apc_Symbol[u32_NumOfSequences] = aacn_Symbol[u32_NumOfSequences];
+      as32_SignalSequence[u32_NumOfSequences] = ((s32_SignalSequence > 0) ? s32_SignalSequence : 0);
+      apt_SignalSequence[u32_NumOfSequences] = pt_SignalSequence;
+      ++u32_NumOfSequences;
+   }
+
+   if ((opt_Options->outputFile != NULL) && (u32_NumOfSequences > 0))
+   {
+      sound_write_signal_sequences(opt_Options->outputFile, u32_NumOfSequences, apc_Symbol, as32_SignalSequence, apt_SignalSequence);
+   }
+   for (u32_Channel = 0; u32_Channel < u32_NumOfSequences; ++u32_Channel)
+   {
+      sound_close(apv_Sound[u32_Channel]);
+   }
+   free(pt_ChannelEvents);
+}
+
+
+/*
+   Tempo changes of all tracks (ticks format). The buffer grows to the number of tempo changes
+   of the largest track (a track with more changes than the buffer is scanned once more).
+*/
+static T_TICK_HANDLE get_tempo_map(T_MIDI_HANDLE opv_Midi, const T_midi_header_chunk * const opt_HeaderChunk)
+{
+   T_TICK_HANDLE pv_Tick;
    T_midi_track_chunk t_TrackChunk;
-   T_MIDI_HANDLE pv_Midi;
-   T_MIDI_EVENT_HANDLE pv_MidiEvent;
+   T_midi_event_statistic t_Statistic;
+   T_midi_event_tempo * pat_Tempo;
+   uint32_t u32_MaxTempos;
    uint32_t u32_Track;
-   T_midi_event_note * pt_NoteEvents;
+
+   pv_Tick = tick_open(opt_HeaderChunk->u16_TimeDivision);
+   u32_MaxTempos = 4096;
+   pat_Tempo = malloc(u32_MaxTempos * sizeof(T_midi_event_tempo));
+   for (u32_Track = 0; u32_Track < opt_HeaderChunk->u16_NumOfTracks; ++u32_Track)
+   {
+      T_MIDI_EVENT_HANDLE pv_MidiEvent;
+
+      if (midi_get_track_chunk(opv_Midi, u32_Track, &t_TrackChunk) < 0)
+      {
+         break;
+      }
+      pv_MidiEvent = midi_event_open(&t_TrackChunk);
+      midi_event_get_statistic(pv_MidiEvent, &t_Statistic, pat_Tempo, u32_MaxTempos, NULL, 0);
+      if (t_Statistic.u32_NumOfTempos > u32_MaxTempos)
+      {
+         u32_MaxTempos = t_Statistic.u32_NumOfTempos;
+         pat_Tempo = realloc(pat_Tempo, u32_MaxTempos * sizeof(T_midi_event_tempo));
+         midi_event_get_statistic(pv_MidiEvent, &t_Statistic, pat_Tempo, u32_MaxTempos, NULL, 0);
+      }
+      tick_add_tempo_map(pv_Tick, t_Statistic.u32_NumOfTempos, pat_Tempo);
+      midi_event_close(pv_MidiEvent);
+   }
+   free(pat_Tempo);
+   return pv_Tick;
+}
+
+
+/*
+   Filter, print and write (respectively add to pool, palette or footprint) the signal sequence of a track.
+*/
+static void convert_signal_sequence(const char * const opc_InputFile, const uint32_t ou32_File, const uint32_t ou32_Track,
+                                    const int32_t os32_SignalSequence, T_sound_signal * const opt_SignalSequence,
+                                    const T_options * const opt_Options, T_POOL_HANDLE opv_Pool, T_PALETTE_HANDLE opv_Palette)
+{
+   const char * const outputFile = opt_Options->outputFile;
+   const char * const outputFormat = opt_Options->outputFormat;
+   T_sound_interrupt_statistic t_InterruptStatistic;
+   int32_t s32_SignalSequence;
+
+   //limit the interrupt rate of the target (short signals are added to their neighbours)
+   s32_SignalSequence = os32_SignalSequence;
+   if (opt_Options->u16_MinSignal1ms > 0)
+   {
+      s32_SignalSequence = sound_filter_short_signals(s32_SignalSequence, opt_SignalSequence, opt_Options->u16_MinSignal1ms, opt_Options->e_Absorb);
+   }
+   sound_get_interrupt_statistic(s32_SignalSequence, opt_SignalSequence, &t_InterruptStatistic);
+   sound_print_interrupt_statistic(&t_InterruptStatistic);
+   if (opt_Options->pv_Timer != NULL)
+   {
+      timer_print_error(opt_Options->pv_Timer, s32_SignalSequence, opt_SignalSequence);
+   }
+   //timing validation: play in real time
+   if (opt_Options->pv_Play != NULL)
+   {
+      play_signal_sequence(opt_Options->pv_Play, s32_SignalSequence, opt_SignalSequence);
+   }
+   // sound_print_signal_sequence(s32_SignalSequence, opt_SignalSequence);
+   if ((opv_Pool != NULL) || (opv_Palette != NULL) || (opt_Options->pv_Footprint != NULL))
+   {
+      char acn_Name[256];
+
+      snprintf(acn_Name, sizeof(acn_Name), "%s (track %d)", opc_InputFile, ou32_Track);
+      if (opt_Options->pv_Footprint != NULL)
+      {
+         footprint_add_signal_sequence(opt_Options->pv_Footprint, acn_Name, ((uint64_t)ou32_File << 32) | ou32_Track, s32_SignalSequence, opt_SignalSequence);
+      }
+      else if (opv_Pool != NULL)
+      {
+         pool_add_signal_sequence(opv_Pool, acn_Name, ((uint64_t)ou32_File << 32) | ou32_Track, s32_SignalSequence, opt_SignalSequence);
+      }
+      else
+      {
+         palette_add_signal_sequence(opv_Palette, acn_Name, ((uint64_t)ou32_File << 32) | ou32_Track, s32_SignalSequence, opt_SignalSequence);
+      }
+   }
+   else if (outputFile != NULL)
+   {
+      if (strcmp(outputFormat, "motif") == 0)
+      {
+         T_MOTIF_HANDLE pv_Motif;
+
+         //compress repeated phrases into pool and play list
+         pv_Motif = motif_open(s32_SignalSequence, opt_SignalSequence);
+         if (pv_Motif != 0)
+         {
+            motif_print_play_list(pv_Motif);
+            motif_write_play_list(outputFile, pv_Motif);
+            motif_close(pv_Motif);
+         }
+      }
+      else if (strcmp(outputFormat, "chunks") == 0)
+      {
+         uint8_t * pu8_Image;
+         int32_t s32_Size;
+
+         //page aligned blocks with index (streaming from external flash)
+         s32_Size = chunk_get_image(opt_Options->u16_BlockSize, s32_SignalSequence, opt_SignalSequence, &pu8_Image);
+         if (s32_Size > 0)
+         {
+            chunk_print_image(pu8_Image);
+            if (object_write_blob(outputFile, pu8_Image, (uint32_t)s32_Size) < 0)
+            {
+               printf("[E] Cannot write file %s!\n", outputFile);
+            }
+            free(pu8_Image);
+         }
+      }
+      else if ((strcmp(outputFormat, "elf") == 0) || (strcmp(outputFormat, "bin") == 0))
+      {
+         uint8_t * pu8_Table;
+         uint32_t u32_Size;
+         int32_t s32_Result;
+
+         //table without C compiler: relocatable object or plain binary
+         pu8_Table = malloc((s32_SignalSequence + 1) * sizeof(T_sound_signal));
+         u32_Size = sound_get_signal_table(s32_SignalSequence, opt_SignalSequence, pu8_Table);
+         if (strcmp(outputFormat, "elf") == 0)
+         {
+            s32_Result = object_write_elf(outputFile, opt_Options->e_Machine, opt_Options->objectSection, opt_Options->objectSymbol, pu8_Table, u32_Size);
+         }
+         else
+         {
+            s32_Result = object_write_blob(outputFile, pu8_Table, u32_Size);
+         }
+         if (s32_Result < 0)
+         {
+            printf("[E] Cannot write file %s!\n", outputFile);
+         }
+         free(pu8_Table);
+      }
+      else if (opt_Options->pv_Timer != NULL)
+      {
+         timer_write_signal_sequence(outputFile, opt_Options->pv_Timer, s32_SignalSequence, opt_SignalSequence);
+      }
+      else
+      {
+         sound_write_signal_sequence(outputFile, s32_SignalSequence, opt_SignalSequence);
+      }
+   }
+}
+
+
+/*
+   Convert the note events of one track into the selected output format. If a pool or palette is given,
+   the signal sequence is added to it (and written later on), otherwise it is written to the output file.
+*/
+static void convert_note_events(const char * const opc_InputFile, const uint32_t ou32_File, const uint32_t ou32_Track, const uint16_t ou16_TimeDivision,
+                                const uint32_t ou32_MaxGapTicks, const int32_t os32_NoteEvents, T_midi_event_note * const opt_NoteEvents,
+                                const T_options * const opt_Options, T_POOL_HANDLE opv_Pool, T_PALETTE_HANDLE opv_Palette)
+{
    int32_t s32_NoteEvents;
    T_SOUND_HANDLE pv_Sound;
    T_sound_signal * pt_SignalSequence;
    int32_t s32_SignalSequence;
+   const char * const outputFile = opt_Options->outputFile;
+   const char * const outputFormat = opt_Options->outputFormat;
+
+   midi_event_print_note_events(os32_NoteEvents, opt_NoteEvents);
+
+   //polyphonic output (note offs are required to release the voices, so nothing is stripped)
+   if ((strcmp(outputFormat, "voices") == 0) || (strcmp(outputFormat, "changes") == 0))
+   {
+      T_VOICE_HANDLE pv_Voice;
+
+      pv_Voice = voice_open(os32_NoteEvents, opt_NoteEvents, ou16_TimeDivision,
+                            opt_Options->u8_NumOfVoices, opt_Options->e_VoiceSteal, opt_Options->au8_ChannelPriority);
+      if (pv_Voice != 0)
+      {
+         voice_print_statistic(pv_Voice);
+         if (outputFile != NULL)
+         {
+            if (strcmp(outputFormat, "voices") == 0)
+            {
+               voice_write_signal_sequences(outputFile, pv_Voice);
+            }
+            else
+            {
+               voice_write_change_sequence(outputFile, pv_Voice);
+            }
+         }
+         voice_close(pv_Voice);
+      }
+      return;
+   }
+
+   //one table per channel
+   if (opt_Options->u16_ChannelMask != 0)
+   {
+      convert_channels(ou16_TimeDivision, ou32_MaxGapTicks, os32_NoteEvents, opt_NoteEvents, opt_Options);
+      return;
+   }
+
+   //remove redundant events (e.g. note off + immediate note on event -> the note off event will be removed)
+   s32_NoteEvents = midi_event_strip_redundant_note_events(os32_NoteEvents, opt_NoteEvents, ou32_MaxGapTicks);
+
+   //durations in ticks and the tempo map
+   if ((opt_Options->pv_Tick != NULL) && (s32_NoteEvents > 0))
+   {
+      T_tick_signal * pt_TickSequence;
+
+      s32_SignalSequence = tick_get_signal_sequence(opt_Options->pv_Tick, opt_Options->u32_StartTick, s32_NoteEvents, opt_NoteEvents, &pt_TickSequence);
+      tick_print_statistic(opt_Options->pv_Tick);
+      if (outputFile != NULL)
+      {
+         tick_write_signal_sequence(outputFile, opt_Options->pv_Tick, s32_SignalSequence, pt_TickSequence);
+      }
+      return;
+   }
+   if (s32_NoteEvents > 0)
+   {
+      pv_Sound = sound_open(s32_NoteEvents, opt_NoteEvents, ou16_TimeDivision);
+      //now the events can be converted to duration and frequency
+      s32_SignalSequence = sound_get_signal_sequence(pv_Sound, &pt_SignalSequence);
+      if (s32_SignalSequence > 0)
+      {
+         convert_signal_sequence(opc_InputFile, ou32_File, ou32_Track, s32_SignalSequence, pt_SignalSequence, opt_Options, opv_Pool, opv_Palette);
+      }
+      sound_close(pv_Sound);
+   }
+}
+
+
+/*
+   Convert all tracks of one midi file. If a pool or palette is given, the signal sequences are
+   added to it (and written later on), otherwise they are written to the output file.
+*/
+static void convert_file(const char * const opc_InputFile, const uint32_t ou32_File, T_MIDI_HANDLE opv_Midi,
+                         const T_options * const opt_Options, T_POOL_HANDLE opv_Pool, T_PALETTE_HANDLE opv_Palette)
+{
+   T_midi_header_chunk t_HeaderChunk;
+   T_midi_track_chunk t_TrackChunk;
+   T_MIDI_EVENT_HANDLE pv_MidiEvent;
+   uint32_t u32_Track;
+   T_midi_event_note * pt_NoteEvents;
+   int32_t s32_NoteEvents;
+   int32_t s32_MaxGapTicks;
+   const char * const outputFile = opt_Options->outputFile;
+   const char * const outputFormat = opt_Options->outputFormat;
+   T_CHECKPOINT_HANDLE pv_Checkpoint;
+   T_options t_Options;
+   uint32_t u32_FromTick;
+   uint32_t u32_ToTick;
+
+   //midi header
+   midi_get_header_chunk(opv_Midi, &t_HeaderChunk);
+   midi_print_header_chunk(&t_HeaderChunk);
+   s32_MaxGapTicks = opt_Options->s32_MaxGapTicks;
+   if (s32_MaxGapTicks < 0)
+   {
+      s32_MaxGapTicks = get_default_max_gap_ticks(t_HeaderChunk.u16_TimeDivision);
+   }
+
+   //time window -> seek via checkpoints
+   pv_Checkpoint = NULL;
+   u32_FromTick = 0;
+   u32_ToTick = UINT32_MAX;
+   if (opt_Options->u8_Window != 0)
+   {
+      const double f64_MsPerTick = sound_get_ms_per_tick(t_HeaderChunk.u16_TimeDivision);
+
+      u32_FromTick = (uint32_t)((opt_Options->u32_From1ms / f64_MsPerTick) + 0.5);
+      if (opt_Options->u32_To1ms != UINT32_MAX)
+      {
+         u32_ToTick = (uint32_t)((opt_Options->u32_To1ms / f64_MsPerTick) + 0.5);
+      }
+      pv_Checkpoint = get_checkpoints(opc_InputFile, opv_Midi, t_HeaderChunk.u16_TimeDivision, opt_Options->u32_CheckpointTicks);
+   }
+
+   //ticks format: tempo map of all tracks
+   t_Options = *opt_Options;
+   if (strcmp(outputFormat, "ticks") == 0)
+   {
+      t_Options.pv_Tick = get_tempo_map(opv_Midi, &t_HeaderChunk);
+      t_Options.u32_StartTick = u32_FromTick;
+   }
+
+   //for each track
+   for (u32_Track = 0; u32_Track < t_HeaderChunk.u16_NumOfTracks; ++u32_Track)
+   {
+      //track header
+      if (midi_get_track_chunk(opv_Midi, u32_Track, &t_TrackChunk) < 0)
+      {
+         printf("[E] Invalid track chunk %d!\n", u32_Track);
+         break;
+      }
+      midi_print_track_chunk(&t_TrackChunk);
+
+      //midi events of track
+      pv_MidiEvent = midi_event_open(&t_TrackChunk);
+//      midi_event_hex_dump(pv_MidiEvent);
+//      midi_event_print_events(pv_MidiEvent);
+
+      //decode, convert and write in parallel stages (table format only, no filter of short signals)
+      if ((opt_Options->u32_PipelineBlockSize > 0) && (opt_Options->u16_MinSignal1ms == 0) && (opt_Options->u8_Window == 0) &&
+          (opt_Options->pv_Timer == NULL) && (opt_Options->u16_ChannelMask == 0) && (opt_Options->pv_Play == NULL) && (opv_Pool == NULL) && (outputFile != NULL) && (strcmp(outputFormat, "table") == 0))
+      {
+         if (pipeline_convert_track(pv_MidiEvent, t_HeaderChunk.u16_TimeDivision, (uint32_t)s32_MaxGapTicks,
+                                    opt_Options->u32_PipelineBlockSize, outputFile) == -1)
+         {
+            printf("[E] Invalid note events in track %d!\n", u32_Track);
+         }
+         midi_event_close(pv_MidiEvent);
+         continue;
+      }
+
+      //decode and convert in a single pass: each block of decoded note events is converted at once,
+      //memory is proportional to the signals only (formats based on the signal sequence)
+      if ((opt_Options->u8_Fused != 0) && (opt_Options->u8_Window == 0) && (opt_Options->u16_ChannelMask == 0) && (t_Options.pv_Tick == NULL) &&
+          (strcmp(outputFormat, "voices") != 0) && (strcmp(outputFormat, "changes") != 0))
+      {
+         T_midi_event_note at_NoteEvents[64];
+         T_SOUND_STREAM_HANDLE pv_Stream;
+         T_sound_signal * pt_SignalSequence;
+         int32_t s32_SignalSequence;
+
+         pv_Stream = sound_stream_open(t_HeaderChunk.u16_TimeDivision, (uint32_t)s32_MaxGapTicks, NULL, NULL);
+         do
+         {
+            s32_NoteEvents = midi_event_get_next_note_events(pv_MidiEvent, at_NoteEvents, (int32_t)(sizeof(at_NoteEvents) / sizeof(at_NoteEvents[0])));
+            if (s32_NoteEvents > 0)
+            {
+               sound_stream_add_note_events(pv_Stream, s32_NoteEvents, at_NoteEvents);
+            }
+         } while (s32_NoteEvents > 0);
+         if (s32_NoteEvents < 0)
+         {
+            printf("[E] Invalid note events in track %d!\n", u32_Track);
+         }
+         else if (sound_stream_flush(pv_Stream) > 0)
+         {
+            s32_SignalSequence = sound_stream_get_signal_sequence(pv_Stream, &pt_SignalSequence);
+            convert_signal_sequence(opc_InputFile, ou32_File, u32_Track, s32_SignalSequence, pt_SignalSequence, opt_Options, opv_Pool, opv_Palette);
+         }
+         sound_stream_close(pv_Stream);
+         midi_event_close(pv_MidiEvent);
+         continue;
+      }
+
+      //get note events
+      if (opt_Options->u8_Window != 0)
+      {
+         s32_NoteEvents = midi_event_get_note_events_range(pv_MidiEvent, checkpoint_find(pv_Checkpoint, u32_Track, u32_FromTick),
+                                                           u32_FromTick, u32_ToTick, &pt_NoteEvents);
+      }
+      else
+      {
+         s32_NoteEvents = midi_event_get_note_events(pv_MidiEvent, &pt_NoteEvents);
+      }
+      if (s32_NoteEvents > 0)
+      {
+         convert_note_events(opc_InputFile, ou32_File, u32_Track, t_HeaderChunk.u16_TimeDivision, (uint32_t)s32_MaxGapTicks,
+                             s32_NoteEvents, pt_NoteEvents, &t_Options, opv_Pool, opv_Palette);
+      }
+
+      midi_event_close(pv_MidiEvent);
+   }
+
+   if (pv_Checkpoint != NULL)
+   {
+      checkpoint_close(pv_Checkpoint);
+   }
+   if (t_Options.pv_Tick != NULL)
+   {
+      tick_close(t_Options.pv_Tick);
+   }
+}
+
+
+/*
+   Convert all tracks of an IR file (note events are taken from the mapped file as they are).
+*/
+static void convert_ir_file(const char * const opc_InputFile, T_IR_HANDLE opv_Ir, const T_options * const opt_Options,
+                            T_PALETTE_HANDLE opv_Palette)
+{
+   T_midi_header_chunk t_HeaderChunk;
+   uint32_t u32_Track;
+   T_midi_event_note * pt_NoteEvents;
+   int32_t s32_NoteEvents;
+   int32_t s32_MaxGapTicks;
+   T_options t_Options;
+
+   //midi header
+   ir_get_header_chunk(opv_Ir, &t_HeaderChunk);
+   midi_print_header_chunk(&t_HeaderChunk);
+   s32_MaxGapTicks = opt_Options->s32_MaxGapTicks;
+   if (s32_MaxGapTicks < 0)
+   {
+      s32_MaxGapTicks = get_default_max_gap_ticks(t_HeaderChunk.u16_TimeDivision);
+   }
+
+   //ticks format: tempo map of all tracks
+   t_Options = *opt_Options;
+   if (strcmp(opt_Options->outputFormat, "ticks") == 0)
+   {
+      t_Options.pv_Tick = tick_open(t_HeaderChunk.u16_TimeDivision);
+      for (u32_Track = 0; u32_Track < t_HeaderChunk.u16_NumOfTracks; ++u32_Track)
+      {
+         const T_midi_event_tempo * pt_Tempos;
+         const int32_t s32_Tempos = ir_get_tempo_map(opv_Ir, u32_Track, &pt_Tempos);
+
+         if (s32_Tempos > 0)
+         {
+            tick_add_tempo_map(t_Options.pv_Tick, (uint32_t)s32_Tempos, pt_Tempos);
+         }
+      }
+   }
+
+   //for each track
+   for (u32_Track = 0; u32_Track < t_HeaderChunk.u16_NumOfTracks; ++u32_Track)
+   {
+      s32_NoteEvents = ir_get_note_events(opv_Ir, u32_Track, &pt_NoteEvents);
+      if (s32_NoteEvents > 0)
+      {
+         convert_note_events(opc_InputFile, 0, u32_Track, t_HeaderChunk.u16_TimeDivision, (uint32_t)s32_MaxGapTicks,
+                             s32_NoteEvents, pt_NoteEvents, &t_Options, NULL, opv_Palette);
+      }
+   }
+   if (t_Options.pv_Tick != NULL)
+   {
+      tick_close(t_Options.pv_Tick);
+   }
+}
+
+
+/*
+   Encode the signal sequences of all songs by all formats and print their footprint (nothing is written).
+   Returns the smallest format within the decode budget, NULL if there is none.
+*/
+static const char * measure_footprint(const int32_t os32_NumOfInputFiles, const char ** const opac_InputFiles, const T_options * const opt_Options)
+{
+   T_options t_Options;
+   const char * pc_Format;
+   int32_t s32_File;
+
+   t_Options = *opt_Options;
+   t_Options.outputFile = NULL;
+   t_Options.outputFormat = "table";
+   t_Options.u16_ChannelMask = 0;
+   t_Options.pv_Footprint = footprint_open(opt_Options->u16_GridNumerator, opt_Options->u16_GridDenominator, ((os32_NumOfInputFiles > 1) ? 1 : 0));
+   if (t_Options.pv_Footprint == 0)
+   {
+      printf("[E] Invalid grid!\n");
+      return NULL;
+   }
+   if (t_Options.irFile != NULL)
+   {
+      T_IR_HANDLE pv_Ir;
+
+      pv_Ir = ir_open(t_Options.irFile);
+      if (pv_Ir != 0)
+      {
+         convert_ir_file(t_Options.irFile, pv_Ir, &t_Options, NULL);
+         ir_close(pv_Ir);
+      }
+   }
+   else
+   {
+      for (s32_File = 0; s32_File < os32_NumOfInputFiles; ++s32_File)
+      {
+         T_MIDI_HANDLE pv_Midi;
+
+         pv_Midi = midi_open(opac_InputFiles[s32_File]);
+         if (pv_Midi != 0)
+         {
+            convert_file(opac_InputFiles[s32_File], (uint32_t)s32_File, pv_Midi, &t_Options, NULL, NULL);
+            midi_close(pv_Midi);
+         }
+      }
+   }
+   pc_Format = footprint_build(t_Options.pv_Footprint, t_Options.u32_MaxCycles);
+   footprint_print(t_Options.pv_Footprint);
+   footprint_close(t_Options.pv_Footprint);
+   return pc_Format;
+}
+
+
+/*
+   Convert one midi file of the watched directory (called by the worker threads of watch_run).
+*/
+static int32_t convert_watched_file(const char * const opc_InputFile, const char * const opc_OutputFile, void * const opv_Context)
+{
+   T_options t_Options;
+   T_MIDI_HANDLE pv_Midi;
+
+   t_Options = *(const T_options *)opv_Context;
+   t_Options.outputFile = opc_OutputFile;
+   pv_Midi = midi_open(opc_InputFile);
+   if (pv_Midi == 0)
+   {
+      return -1;
+   }
+   convert_file(opc_InputFile, 0, pv_Midi, &t_Options, NULL, NULL);
+   midi_close(pv_Midi);
+   return (access(opc_OutputFile, F_OK) == 0) ? 0 : -1;
+}
+
+
+int main(int argc, char ** argv)
+{
+   const char ** inputFiles;
+   int32_t numOfInputFiles = 0;
+   T_options t_Options;
+   T_PALETTE_HANDLE pv_Palette;
+   uint8_t u8_SplitChannels = 0;
+   uint16_t u16_IncludeChannels = 0;
+   uint16_t u16_ExcludeChannels = 0;
+   uint8_t u8_InvalidArguments = 0;
+
+   //defaults
+   memset(&t_Options, 0, sizeof(t_Options));
+   t_Options.outputFormat = "table";
+   t_Options.s32_MaxGapTicks = -1;
+   t_Options.u8_NumOfVoices = 4;
+   t_Options.e_VoiceSteal = VOICE_STEAL_OLDEST;
+   t_Options.e_Absorb = SOUND_ABSORB_PREVIOUS;
+   t_Options.u16_GridNumerator = 500;   //1/64 beat
+   t_Options.u16_GridDenominator = 64;
+   t_Options.u32_To1ms = UINT32_MAX;
+   t_Options.e_Machine = OBJECT_MACHINE_ARM;
+   t_Options.objectSection = ".rodata.sound";
+   t_Options.objectSymbol = "gau16_SoundSequence";
+   t_Options.u32_Debounce1ms = 50;
+   t_Options.u16_BlockSize = 256;
 
    //get input and output file from command line arguments
+   inputFiles = malloc(argc * sizeof(const char *));
    for (int i = 1; i < (argc - 1); ++i)
    {
-      //input file
+      //input file(s)
       if (strcmp(argv[i], "-i") == 0)
       {
-         inputFile = argv[i + 1];
+         inputFiles[numOfInputFiles++] = argv[i + 1];
       }
       //output file
       if (strcmp(argv[i], "-o") == 0)
       {
-         outputFile = argv[i + 1];
+         t_Options.outputFile = argv[i + 1];
+      }
+      //max. length of a rest between two notes, that is removed [ticks]
+      if (strcmp(argv[i], "-g") == 0)
+      {
+         t_Options.s32_MaxGapTicks = atoi(argv[i + 1]);
+      }
+      //output format
+      if (strcmp(argv[i], "-f") == 0)
+      {
+         t_Options.outputFormat = argv[i + 1];
+      }
+      //number of voices (polyphonic formats)
+      if (strcmp(argv[i], "-v") == 0)
+      {
+         char * pc_End;
+         const long s32_NumOfVoices = strtol(argv[i + 1], &pc_End, 10);
+
+         if ((pc_End == argv[i + 1]) || (*pc_End != 0) || (s32_NumOfVoices < 1) || (s32_NumOfVoices > VOICE_MAX_VOICES))
+         {
+            printf("[E] Invalid number of voices %s (1..%d)!\n", argv[i + 1], VOICE_MAX_VOICES);
+            u8_InvalidArguments = 1;
+         }
+         t_Options.u8_NumOfVoices = (uint8_t)s32_NumOfVoices;
+      }
+      //voice stealing policy (polyphonic formats)
+      if (strcmp(argv[i], "-s") == 0)
+      {
+         if (strcmp(argv[i + 1], "velocity") == 0)
+         {
+            t_Options.e_VoiceSteal = VOICE_STEAL_LOWEST_VELOCITY;
+         }
+         else if (strcmp(argv[i + 1], "oldest") == 0)
+         {
+            t_Options.e_VoiceSteal = VOICE_STEAL_OLDEST;
+         }
+         else
+         {
+            printf("[E] Invalid voice stealing policy %s (oldest, velocity)!\n", argv[i + 1]);
+            u8_InvalidArguments = 1;
+         }
+      }
+      //channel priorities (polyphonic formats)
+      if (strcmp(argv[i], "-p") == 0)
+      {
+         if (parse_channel_priority(argv[i + 1], t_Options.au8_ChannelPriority) < 0)
+         {
+            u8_InvalidArguments = 1;
+         }
+      }
+      //min. duration of a signal [ms]
+      if (strcmp(argv[i], "-m") == 0)
+      {
+         t_Options.u16_MinSignal1ms = (uint16_t)atoi(argv[i + 1]);
+      }
+      //duration grid (palette format)
+      if (strcmp(argv[i], "-q") == 0)
+      {
+         parse_grid(argv[i + 1], &t_Options.u16_GridNumerator, &t_Options.u16_GridDenominator);
+      }
+      //neighbour, that absorbs a short signal
+      if (strcmp(argv[i], "-a") == 0)
+      {
+         t_Options.e_Absorb = ((strcmp(argv[i + 1], "next") == 0) ? SOUND_ABSORB_NEXT :
+                               ((strcmp(argv[i + 1], "sounding") == 0) ? SOUND_ABSORB_SOUNDING : SOUND_ABSORB_PREVIOUS));
+      }
+      //one table per channel: selected channels, respectively all channels except the excluded ones
+      if (strcmp(argv[i], "--channels") == 0)
+      {
+         if (parse_channels(argv[i + 1], &u16_IncludeChannels) < 0)
+         {
+            u8_InvalidArguments = 1;
+         }
+         u8_SplitChannels = 1;
+      }
+      if (strcmp(argv[i], "--exclude-channels") == 0)
+      {
+         if (parse_channels(argv[i + 1], &u16_ExcludeChannels) < 0)
+         {
+            u8_InvalidArguments = 1;
+         }
+         u8_SplitChannels = 1;
+      }
+      //pipelined conversion, number of events per block
+      if (strcmp(argv[i], "--pipeline") == 0)
+      {
+         t_Options.u32_PipelineBlockSize = (uint32_t)atoi(argv[i + 1]);
+      }
+      //decoding: note event array (default), or single pass (fused)
+      if (strcmp(argv[i], "--decode") == 0)
+      {
+         t_Options.u8_Fused = ((strcmp(argv[i + 1], "fused") == 0) ? 1 : 0);
+      }
+      //time window (start, end)
+      if (strcmp(argv[i], "--from") == 0)
+      {
+         t_Options.u32_From1ms = parse_time(argv[i + 1]);
+         t_Options.u8_Window = 1;
+      }
+      if (strcmp(argv[i], "--to") == 0)
+      {
+         t_Options.u32_To1ms = parse_time(argv[i + 1]);
+         t_Options.u8_Window = 1;
+      }
+      //interval of the checkpoint index [ticks]
+      if (strcmp(argv[i], "--checkpoint") == 0)
+      {
+         t_Options.u32_CheckpointTicks = (uint32_t)atoi(argv[i + 1]);
+      }
+      //target, section and symbol (object formats)
+      if (strcmp(argv[i], "--machine") == 0)
+      {
+         t_Options.e_Machine = ((strcmp(argv[i + 1], "x86-64") == 0) ? OBJECT_MACHINE_X86_64 : OBJECT_MACHINE_ARM);
+      }
+      if (strcmp(argv[i], "--section") == 0)
+      {
+         t_Options.objectSection = argv[i + 1];
+      }
+      if (strcmp(argv[i], "--symbol") == 0)
+      {
+         t_Options.objectSymbol = argv[i + 1];
+      }
+      //timer clock [Hz] and prescalers of the target (reload values instead of frequencies)
+      if (strcmp(argv[i], "--timer-clock") == 0)
+      {
+         t_Options.u32_TimerClock1Hz = (uint32_t)strtoul(argv[i + 1], NULL, 10);
+      }
+      if (strcmp(argv[i], "--prescalers") == 0)
+      {
+         t_Options.timerPrescalers = argv[i + 1];
+      }
+      //decoded note events: input instead of midi file, respectively output in addition
+      if (strcmp(argv[i], "--ir") == 0)
+      {
+         t_Options.irFile = argv[i + 1];
+      }
+      if (strcmp(argv[i], "--ir-write") == 0)
+      {
+         t_Options.irOutputFile = argv[i + 1];
+      }
+      //directory to watch, delay after the last change of a file [ms]
+      if (strcmp(argv[i], "--watch") == 0)
+      {
+         t_Options.watchDirectory = argv[i + 1];
+      }
+      if (strcmp(argv[i], "--debounce") == 0)
+      {
+         t_Options.u32_Debounce1ms = (uint32_t)atoi(argv[i + 1]);
       }
+      //encoding report, respectively conversion to the smallest format; decode budget [cycles per signal]
+      if (strcmp(argv[i], "--footprint") == 0)
+      {
+         t_Options.u8_Footprint = ((strcmp(argv[i + 1], "auto") == 0) ? 2 : 1);
+      }
+      if (strcmp(argv[i], "--max-cycles") == 0)
+      {
+         t_Options.u32_MaxCycles = (uint32_t)atoi(argv[i + 1]);
+      }
+      //block size (chunks format)
+      if (strcmp(argv[i], "--block-size") == 0)
+      {
+         t_Options.u16_BlockSize = (uint16_t)atoi(argv[i + 1]);
+      }
+      //real time playback: sink, timer, SCHED_FIFO priority
+      if (strcmp(argv[i], "--play") == 0)
+      {
+         t_Options.playSink = argv[i + 1];
+      }
+      if (strcmp(argv[i], "--play-clock") == 0)
+      {
+         t_Options.e_PlayClock = ((strcmp(argv[i + 1], "timerfd") == 0) ? PLAY_CLOCK_TIMERFD : PLAY_CLOCK_NANOSLEEP);
+      }
+      if (strcmp(argv[i], "--priority") == 0)
+      {
+         t_Options.u32_PlayPriority = (uint32_t)atoi(argv[i + 1]);
+      }
+      //directory to analyze (statistics only)
+      if (strcmp(argv[i], "--analyze") == 0)
+      {
+         t_Options.analyzeDirectory = argv[i + 1];
+      }
+      //number of threads (analyze)
+      if (strcmp(argv[i], "-j") == 0)
+      {
+         t_Options.u32_NumOfThreads = (uint32_t)atoi(argv[i + 1]);
+      }
+      //flash budget [bytes] (analyze)
+      if (strcmp(argv[i], "-b") == 0)
+      {
+         t_Options.u32_FlashBudget1By = (uint32_t)atoi(argv[i + 1]);
+      }
+   }
+   if (u8_InvalidArguments != 0)
+   {
+      free(inputFiles);
+      return -1;
+   }
+   //the note events of an IR file are decoded already: time windows, pipeline and single pass decoding need the midi file
+   if ((t_Options.irFile != NULL) && ((t_Options.u8_Window != 0) || (t_Options.u32_PipelineBlockSize > 0) || (t_Options.u8_Fused != 0)))
+   {
+      printf("[E] --from, --to, --pipeline and --decode fused cannot be combined with --ir!\n");
+      free(inputFiles);
+      return -1;
    }
-   if (inputFile == NULL)
+   if (u8_SplitChannels != 0)
+   {
+      //no include list: all channels
+      t_Options.u16_ChannelMask = (uint16_t)(((u16_IncludeChannels != 0) ? u16_IncludeChannels : 0xFFFFu) & ~u16_ExcludeChannels);
+      if (t_Options.u16_ChannelMask == 0)
+      {
+         printf("[E] No channel selected!\n");
+         free(inputFiles);
+         return -1;
+      }
+   }
+   if (t_Options.analyzeDirectory != NULL)
+   {
+      T_ANALYZE_HANDLE pv_Analyze;
+
+      //statistics of all midi files of a directory
+      pv_Analyze = analyze_open(t_Options.analyzeDirectory, t_Options.u32_NumOfThreads, t_Options.u32_FlashBudget1By);
+      if (strcmp(t_Options.outputFormat, "json") == 0)
+      {
+         analyze_write_json(t_Options.outputFile, pv_Analyze);
+      }
+      else
+      {
+         analyze_write_csv(t_Options.outputFile, pv_Analyze);
+      }
+      if (t_Options.outputFile != NULL)
+      {
+         analyze_print_summary(pv_Analyze);
+      }
+      analyze_close(pv_Analyze);
+      free(inputFiles);
+      return 0;
+   }
+   if ((numOfInputFiles == 0) && (t_Options.irFile == NULL) && (t_Options.watchDirectory == NULL))
    {
       printf("Usage:\n");
-      printf(" %s -i <input> [-o <output>]:\n\n", argv[0]);
+      printf(" %s -i <input> [-i <input> ...] [-o <output>] [-g <max-gap-ticks>] [-f <format>]\n", argv[0]);
+      printf("    [-v <voices>] [-s oldest|velocity] [-p <channel>=<priority>,...] [-m <min-signal-ms>] [-a previous|next|sounding]\n");
+      printf("    [-q <beats>/<fraction>|<ms>] [--pipeline <events-per-block>] [--decode array|fused]\n");
+      printf("    [--from <time>] [--to <time>] [--checkpoint <ticks>]\n");
+      printf("    [--machine arm|x86-64] [--section <name>] [--symbol <name>] [--timer-clock <hz> [--prescalers <p>,...]]\n");
+      printf("    [--channels <channels>] [--exclude-channels <channels>] [--ir-write <ir-file>]\n");
+      printf("    [--footprint report|auto [--max-cycles <cycles-per-signal>]]\n");
+      printf("    [--play null|fifo:<path>|pcm:<path> [--play-clock nanosleep|timerfd] [--priority <sched-fifo-priority>]]\n");
+      printf("    [--block-size <bytes>]:\n");
+      printf("  format: table (default), motif, voices, changes, palette, elf, bin, ticks, chunks\n");
+      printf("  time: <minutes>:<seconds> or <seconds>, e.g. 1:30.5\n");
+      printf("  channels: list of channels and ranges (1..16), e.g. 1-9,11 -> one table per channel\n");
+      printf("  several inputs are combined into one deduplicated pool (table format) or one palette (palette format)\n");
+      printf("  footprint: size and decode cost of each format; auto -> converted to the smallest one within the budget\n");
+      printf("  play: each signal sequence is played in real time, latency and jitter are printed\n");
+      printf(" %s --ir <ir-file> [-o <output>] [options as above]\n", argv[0]);
+      printf(" %s --watch <directory> [-o <output-directory>] [--debounce <ms>] [-j <threads>] [options as above]\n", argv[0]);
+      printf(" %s --analyze <directory> [-o <output>] [-f csv|json] [-j <threads>] [-b <flash-budget-bytes>]\n\n", argv[0]);
+      free(inputFiles);
       return -1;
    }
 
+   //encoding report; auto: the smallest format is used for the conversion
+   if ((t_Options.u8_Footprint != 0) && (t_Options.watchDirectory != NULL))
+   {
+      printf("[W] Footprint not supported in watch mode!\n");
+   }
+   else if (t_Options.u8_Footprint != 0)
+   {
+      const char * const pc_Format = measure_footprint(numOfInputFiles, inputFiles, &t_Options);
+
+      if (t_Options.u8_Footprint == 1)
+      {
+         free(inputFiles);
+         return 0;
+      }
+      if (pc_Format == NULL)
+      {
+         printf("[W] No format within %d cycles per signal, using table!\n", t_Options.u32_MaxCycles);
+      }
+      t_Options.outputFormat = ((pc_Format != NULL) ? pc_Format : "table");
+      printf("Format: %s\n", t_Options.outputFormat);
+   }
 
+   //block size: power of two
+   if ((strcmp(t_Options.outputFormat, "chunks") == 0) &&
+       ((t_Options.u16_BlockSize < CHUNK_MIN_BLOCK_SIZE) || (t_Options.u16_BlockSize > CHUNK_MAX_BLOCK_SIZE) ||
+        ((t_Options.u16_BlockSize & (t_Options.u16_BlockSize - 1u)) != 0)))
+   {
+      printf("[E] Invalid block size %d (power of two, %d..%d)!\n", t_Options.u16_BlockSize, CHUNK_MIN_BLOCK_SIZE, CHUNK_MAX_BLOCK_SIZE);
+      free(inputFiles);
+      return -1;
+   }
 
+   //one table per channel (single song, table format)
+   if (u8_SplitChannels != 0)
+   {
+      if ((numOfInputFiles > 1) || (strcmp(t_Options.outputFormat, "table") != 0) || (t_Options.u32_TimerClock1Hz > 0))
+      {
+         printf("[W] Channel tables are written for a single song in table format only, using table!\n");
+         t_Options.outputFormat = "table";
+         t_Options.u32_TimerClock1Hz = 0;
+         if (numOfInputFiles > 1)
+         {
+            t_Options.u16_ChannelMask = 0;
+         }
+      }
+   }
 
-   //open midi
-   pv_Midi = midi_open(inputFile);
-   if (pv_Midi != 0)
+   //each midi file is converted on its own
+   if ((t_Options.watchDirectory != NULL) && (strcmp(t_Options.outputFormat, "palette") == 0))
    {
-      //midi header
-      midi_get_header_chunk(pv_Midi, &t_HeaderChunk);
-      midi_print_header_chunk(&t_HeaderChunk);
+      printf("[W] Format palette not supported in watch mode, using table!\n");
+      t_Options.outputFormat = "table";
+   }
 
-      //for each track
-      for (u32_Track = 0; u32_Track < t_HeaderChunk.u16_NumOfTracks; ++u32_Track)
+   //all tracks of all songs are encoded with a common palette
+   pv_Palette = NULL;
+   if (strcmp(t_Options.outputFormat, "palette") == 0)
+   {
+      pv_Palette = palette_open(t_Options.u16_GridNumerator, t_Options.u16_GridDenominator);
+      if (pv_Palette == 0)
       {
-         //track header
-         midi_get_track_chunk(pv_Midi, u32_Track, &t_TrackChunk);
-         midi_print_track_chunk(&t_TrackChunk);
+         printf("[E] Invalid grid!\n");
+         free(inputFiles);
+         return -1;
+      }
+   }
 
-         //midi events of track
-         pv_MidiEvent = midi_event_open(&t_TrackChunk);
-//         midi_event_hex_dump(pv_MidiEvent);
-//         midi_event_print_events(pv_MidiEvent);
+   //frequencies as reload values of the target timer
+   if (t_Options.u32_TimerClock1Hz > 0)
+   {
+      t_Options.pv_Timer = timer_open(t_Options.u32_TimerClock1Hz, t_Options.timerPrescalers);
+      if (t_Options.pv_Timer == 0)
+      {
+         printf("[E] Invalid prescalers (max. %d positive values)!\n", TIMER_MAX_PRESCALERS);
+         if (pv_Palette != NULL)
+         {
+            palette_close(pv_Palette);
+         }
+         free(inputFiles);
+         return -1;
+      }
+   }
 
-         //get note events
-         s32_NoteEvents = midi_event_get_note_events(pv_MidiEvent, &pt_NoteEvents);
-         if (s32_NoteEvents > 0)
+   //timing validation (not in watch mode)
+   if ((t_Options.playSink != NULL) && (t_Options.watchDirectory == NULL))
+   {
+      t_Options.pv_Play = play_open_sink(t_Options.playSink, t_Options.e_PlayClock, t_Options.u32_PlayPriority);
+      if (t_Options.pv_Play == 0)
+      {
+         if (pv_Palette != NULL)
+         {
+            palette_close(pv_Palette);
+         }
+         if (t_Options.pv_Timer != NULL)
+         {
+            timer_close(t_Options.pv_Timer);
+         }
+         free(inputFiles);
+         return -1;
+      }
+   }
+
+   if (t_Options.watchDirectory != NULL)
+   {
+      const char * pc_Extension;
+
+      //resident: convert all midi files, then each changed one
+      pc_Extension = ((strcmp(t_Options.outputFormat, "elf") == 0) ? ".o" :
+                      (((strcmp(t_Options.outputFormat, "bin") == 0) || (strcmp(t_Options.outputFormat, "chunks") == 0)) ? ".bin" : ".c"));
+      watch_run(t_Options.watchDirectory, ((t_Options.outputFile != NULL) ? t_Options.outputFile : t_Options.watchDirectory), pc_Extension,
+                t_Options.u32_NumOfThreads, t_Options.u32_Debounce1ms, convert_watched_file, &t_Options);
+   }
+   else if (t_Options.irFile != NULL)
+   {
+      T_IR_HANDLE pv_Ir;
+
+      //single song, decoded before
+      pv_Ir = ir_open(t_Options.irFile);
+      if (pv_Ir != 0)
+      {
+         convert_ir_file(t_Options.irFile, pv_Ir, &t_Options, pv_Palette);
+         ir_close(pv_Ir);
+      }
+      else
+      {
+         printf("[E] Invalid IR file %s!\n", t_Options.irFile);
+      }
+   }
+   else if (numOfInputFiles == 1)
+   {
+      T_MIDI_HANDLE pv_Midi;
+
+      //single song
+      pv_Midi = midi_open(inputFiles[0]);
+      if (pv_Midi != 0)
+      {
+         if ((t_Options.irOutputFile != NULL) && (ir_write(t_Options.irOutputFile, pv_Midi) < 0))
+         {
+            printf("[W] Cannot write IR file %s!\n", t_Options.irOutputFile);
+         }
+         convert_file(inputFiles[0], 0, pv_Midi, &t_Options, NULL, pv_Palette);
+         midi_close(pv_Midi);
+      }
+   }
+   else
+   {
+      T_POOL_HANDLE pv_Pool;
+      T_INGEST_HANDLE pv_Ingest;
+      int32_t s32_File;
+      uint8_t * pu8_Buffer;
+      uint32_t u32_Size;
+
+      //several songs -> one pool (or palette)
+      pv_Pool = NULL;
+      if (pv_Palette == NULL)
+      {
+         if (strcmp(t_Options.outputFormat, "table") != 0)
          {
-            midi_event_print_note_events(s32_NoteEvents, pt_NoteEvents);
+            printf("[W] Format %s not supported for several inputs, using table!\n", t_Options.outputFormat);
+            t_Options.outputFormat = "table";
+         }
+         pv_Pool = pool_open();
+      }
+      //files are loaded in the background and converted in order of completion
+      pv_Ingest = ingest_open(numOfInputFiles, inputFiles);
+      while (ingest_get_next(pv_Ingest, &s32_File, &pu8_Buffer, &u32_Size) > 0)
+      {
+         T_MIDI_HANDLE pv_Midi;
 
-//            //remove redundant events (e.g. note off + immediate note on event -> the note off event will be removed)
-//            s32_NoteEvents = midi_event_strip_redundant_note_events(s32_NoteEvents, pt_NoteEvents);
-//            if (s32_NoteEvents > 0)
+         if (pu8_Buffer == NULL)
+         {
+            printf("cannot open file %s\n", inputFiles[s32_File]);
+            continue;
+         }
+         pv_Midi = midi_open_buffer(pu8_Buffer, u32_Size);
+         if (pv_Midi != 0)
+         {
+            convert_file(inputFiles[s32_File], (uint32_t)s32_File, pv_Midi, &t_Options, pv_Pool, pv_Palette);
+            midi_close(pv_Midi);
+         }
+      }
+      ingest_close(pv_Ingest);
+      if (pv_Pool != NULL)
+      {
+         if (pool_build(pv_Pool) > 0)
+         {
+            pool_print_index(pv_Pool);
+            if (t_Options.outputFile != NULL)
             {
-               pv_Sound = sound_open(s32_NoteEvents, pt_NoteEvents, t_HeaderChunk.u16_TimeDivision);
-               //now the events can be converted to duration and frequency
-               s32_SignalSequence = sound_get_signal_sequence(pv_Sound, &pt_SignalSequence);
-               if (s32_SignalSequence > 0)
-               {
-                  // sound_print_signal_sequence(s32_SignalSequence, pt_SignalSequence);
-                  if (outputFile != NULL)
-                  {
-                     sound_write_signal_sequence(outputFile, s32_SignalSequence, pt_SignalSequence);
-                  }
-               }
-               sound_close(pv_Sound);
+               pool_write(t_Options.outputFile, pv_Pool);
             }
          }
-
-         midi_event_close(pv_MidiEvent);
+         pool_close(pv_Pool);
       }
+   }
 
-      //close midi
-      midi_close(pv_Midi);
+   if (pv_Palette != NULL)
+   {
+      if (palette_build(pv_Palette) > 0)
+      {
+         palette_print_statistic(pv_Palette);
+         if (t_Options.outputFile != NULL)
+         {
+            palette_write(t_Options.outputFile, pv_Palette);
+         }
+      }
+      palette_close(pv_Palette);
    }
+   if (t_Options.pv_Timer != NULL)
+   {
+      timer_close(t_Options.pv_Timer);
+   }
+   if (t_Options.pv_Play != NULL)
+   {
+      play_print_statistic(t_Options.pv_Play);
+      play_close(t_Options.pv_Play);
+   }
+
+   free(inputFiles);
    return 0;
 }
-
-
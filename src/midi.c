@@ -22,6 +22,7 @@
 typedef struct
 {
    uint8_t * pu8_FileBuffer;
+   uint32_t u32_FileSize1By;
    T_midi_header_chunk t_HeaderChunk;
 } T_midi_instance;
 
@@ -39,9 +40,7 @@ T_MIDI_HANDLE midi_open(const char * const opc_File)
 {
    FILE * pv_File;
    uint32_t u32_FileSize1By;
-   T_midi_instance * pt_MidiInstance;
-   uint8_t u8_Char;
-   uint32_t u32_Count;
+   uint8_t * pu8_FileBuffer;
 
 
 
@@ -59,23 +58,43 @@ T_MIDI_HANDLE midi_open(const char * const opc_File)
    fseek(pv_File, 0, SEEK_END); // seek to end of file
    u32_FileSize1By = ftell(pv_File); // get current file pointer
    fseek(pv_File, 0, SEEK_SET); // seek back to beginning of file
+
    //------------------------------------------------------------//
-   // allocate midi instance and file buffer                     //
+   // load file to buffer                                        //
    //------------------------------------------------------------//
-   pt_MidiInstance = malloc(sizeof(T_midi_instance));
-   pt_MidiInstance->pu8_FileBuffer = malloc(u32_FileSize1By);
+   pu8_FileBuffer = malloc(u32_FileSize1By);
+   u32_FileSize1By = fread(pu8_FileBuffer, 1, u32_FileSize1By, pv_File); //whole file at once
 
    //------------------------------------------------------------//
-   // load file to buffer                                        //
+   // finalize                                                   //
    //------------------------------------------------------------//
-   u32_Count = 0;
-   u8_Char = fgetc(pv_File);
-   while (!feof(pv_File)) //loop for whole file
+   //close file
+   fclose(pv_File);
+   //return midi instance handle
+   return midi_open_buffer(pu8_FileBuffer, u32_FileSize1By);
+}
+
+
+T_MIDI_HANDLE midi_open_buffer(uint8_t * const opu8_FileBuffer, const uint32_t ou32_FileSize1By)
+{
+   T_midi_instance * pt_MidiInstance;
+   uint32_t u32_Count;
+
+   //preconditional check (header chunk has 14 bytes)
+   if ((opu8_FileBuffer == NULL) || (ou32_FileSize1By < 14))
    {
-      pt_MidiInstance->pu8_FileBuffer[u32_Count++] = u8_Char; //add to buffer
-      u8_Char = fgetc(pv_File); //next char
+      printf("[E] Invalid midi file!\n");
+      free(opu8_FileBuffer);
+      return NULL;
    }
 
+   //------------------------------------------------------------//
+   // allocate midi instance                                     //
+   //------------------------------------------------------------//
+   pt_MidiInstance = malloc(sizeof(T_midi_instance));
+   pt_MidiInstance->pu8_FileBuffer = opu8_FileBuffer;
+   pt_MidiInstance->u32_FileSize1By = ou32_FileSize1By;
+
 
    u32_Count = 0;
    //------------------------------------------------------------//
@@ -106,8 +125,6 @@ T_MIDI_HANDLE midi_open(const char * const opc_File)
    //------------------------------------------------------------//
    // finalize                                                   //
    //------------------------------------------------------------//
-   //close file
-   fclose(pv_File);
    //return midi instance handle
    return pt_MidiInstance;
 }
@@ -175,6 +192,7 @@ static const uint8_t * decode_track_chunk(const uint8_t * opu8_Data, T_midi_trac
 int32_t midi_get_track_chunk(T_MIDI_HANDLE opv_Handle, const uint32_t ou32_Track, T_midi_track_chunk * const opt_TrackChunk)
 {
    T_midi_instance * const pt_MidiInstance = (T_midi_instance *)opv_Handle;
+   const uint8_t * const pu8_FileEnd = &pt_MidiInstance->pu8_FileBuffer[pt_MidiInstance->u32_FileSize1By];
    const uint8_t * pu8_Track;
    uint32_t u32_Track;
 
@@ -191,7 +209,16 @@ int32_t midi_get_track_chunk(T_MIDI_HANDLE opv_Handle, const uint32_t ou32_Track
    pu8_Track = &pt_MidiInstance->pu8_FileBuffer[14]; //reference to first track (skip 14 bytes header chunk)
    for (u32_Track = 0; u32_Track <= ou32_Track; ++u32_Track) //get track chunk of selected track
    {
+      //track header (8 bytes) and track data must be part of the file
+      if ((pu8_FileEnd - pu8_Track) < 8)
+      {
+         return -1;
+      }
       pu8_Track = decode_track_chunk(pu8_Track, opt_TrackChunk);
+      if (opt_TrackChunk->u32_ChunkSize > (uint32_t)(pu8_FileEnd - opt_TrackChunk->pu8_Chunk))
+      {
+         return -1;
+      }
    }
    return 0;
 }
@@ -46,6 +46,7 @@ typedef struct
 
 /* -- Function Prototypes ------------------------------------------------- */
 extern T_MIDI_HANDLE midi_open(const char * const opc_File);
+extern T_MIDI_HANDLE midi_open_buffer(uint8_t * const opu8_FileBuffer, const uint32_t ou32_FileSize1By); //takes ownership of (malloc'ed) buffer
 extern void midi_close(T_MIDI_HANDLE opv_Handle);
 
 //header
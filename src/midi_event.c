@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include "midi_event.h"
 
 
@@ -23,6 +24,9 @@ typedef struct
 {
    const T_midi_track_chunk * pt_TrackChunk;
    T_midi_event_note * pat_NoteEvents;
+   uint32_t u32_MaxNoteEvents;         //capacity of pat_NoteEvents
+   const uint8_t * pu8_Next;           //position of the incremental decoder
+   T_midi_event_checkpoint * pat_Checkpoints;
 } T_midi_event_instance;
 
 /* -- Global Variables ---------------------------------------------------- */
@@ -49,7 +53,13 @@ static const char * const mapcn_MidiEvent[16] =
 };
 
 /* -- Module Global Function Prototypes ----------------------------------- */
-static const uint8_t * get_variable_length_value(const uint8_t * opu8_Data, uint32_t * opu32_Vlv);
+static const uint8_t * get_variable_length_value(const uint8_t * opu8_Data, const uint8_t * const opu8_DataEnd, uint32_t * opu32_Vlv);
+static int32_t decode_note_events(const uint8_t ** const oppu8_Chunk, const uint8_t * const opu8_ChunkEnd,
+                                  T_midi_event_note * opt_NoteEvents, const int32_t os32_MaxEvents);
+static int32_t decode_event(const uint8_t ** const oppu8_Chunk, const uint8_t * const opu8_ChunkEnd, uint8_t * const opu8_RunningStatus,
+                            uint32_t * const opu32_DeltaTime, T_midi_event_note * const opt_NoteEvent);
+static void update_checkpoint(T_midi_event_checkpoint * const opt_State, const T_midi_event_note * const opt_NoteEvent);
+static int32_t add_window_start(const T_midi_event_checkpoint * const opt_State, T_midi_event_note * const opt_NoteEvents);
 
 
 /* -- Implementation ------------------------------------------------------ */
@@ -58,21 +68,17 @@ static const uint8_t * get_variable_length_value(const uint8_t * opu8_Data, uint
 T_MIDI_EVENT_HANDLE midi_event_open(const T_midi_track_chunk * const opt_TrackChunk)
 {
    T_midi_event_instance * pt_MidiEventInstance;
-   uint32_t u32_MaxNoteEvents;
 
    //------------------------------------------------------------//
    // allocate midi event instance                               //
    //------------------------------------------------------------//
    pt_MidiEventInstance = malloc(sizeof(T_midi_event_instance));
    pt_MidiEventInstance->pt_TrackChunk = opt_TrackChunk;
-
-   //------------------------------------------------------------//
-   // allocate buffer for note events                            //
-   //------------------------------------------------------------//
-   //calculate theoretical maximal number of note event:
-   //each note event takes at least 4bytes (1byte delta-time + 3byte event chunk)
-   u32_MaxNoteEvents = (opt_TrackChunk->u32_ChunkSize / 4) + 1; //round up in each case
-   pt_MidiEventInstance->pat_NoteEvents = malloc(u32_MaxNoteEvents * sizeof(T_midi_event_note));
+   //buffer for note events is allocated on demand (see midi_event_get_note_events)
+   pt_MidiEventInstance->pat_NoteEvents = NULL;
+   pt_MidiEventInstance->u32_MaxNoteEvents = 0;
+   pt_MidiEventInstance->pu8_Next = opt_TrackChunk->pu8_Chunk;
+   pt_MidiEventInstance->pat_Checkpoints = NULL;
 
 
    //------------------------------------------------------------//
@@ -87,8 +93,9 @@ void midi_event_close(T_MIDI_EVENT_HANDLE opv_Handle)
 {
    T_midi_event_instance * const pt_MidiEventInstance = (T_midi_event_instance *)opv_Handle;
 
-   //release note event buffer and instance itself
+   //release note event and checkpoint buffer and instance itself
    free(pt_MidiEventInstance->pat_NoteEvents);
+   free(pt_MidiEventInstance->pat_Checkpoints);
    free(pt_MidiEventInstance);
 }
 
@@ -131,7 +138,11 @@ void midi_event_print_events(T_MIDI_EVENT_HANDLE opv_Handle)
       uint8_t u8_MidiCommand;
 
       //get delta time from variable length value and address of subsequent event
-      pu8_Chunk = get_variable_length_value(pu8_Chunk, &u32_DeltaTime);
+      pu8_Chunk = get_variable_length_value(pu8_Chunk, pu8_ChunkEnd, &u32_DeltaTime);
+      if (pu8_Chunk == NULL)
+      {
+         break;
+      }
 
       //get command byte and switch by midi command
       u8_Command = *pu8_Chunk;
@@ -192,14 +203,648 @@ int32_t midi_event_get_note_events(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_
    const T_midi_track_chunk * const pt_TrackChunk = pt_MidiEventInstance->pt_TrackChunk;
    const uint8_t * pu8_Chunk = pt_TrackChunk->pu8_Chunk;
    const uint8_t * const pu8_ChunkEnd = &pu8_Chunk[pt_TrackChunk->u32_ChunkSize];
-   T_midi_event_note * pt_NoteEvents = pt_MidiEventInstance->pat_NoteEvents;
+   T_midi_event_note * pt_NoteEvents;
+   int32_t s32_Count;
+
+   //------------------------------------------------------------//
+   // allocate buffer for note events                            //
+   //------------------------------------------------------------//
+   if (pt_MidiEventInstance->pat_NoteEvents == NULL)
+   {
+      uint32_t u32_MaxNoteEvents;
+
+      //calculate theoretical maximal number of note event:
+      //each note event takes at least 4bytes (1byte delta-time + 3byte event chunk)
+      u32_MaxNoteEvents = (pt_TrackChunk->u32_ChunkSize / 4) + 1; //round up in each case
+      pt_MidiEventInstance->pat_NoteEvents = malloc(u32_MaxNoteEvents * sizeof(T_midi_event_note));
+      pt_MidiEventInstance->u32_MaxNoteEvents = u32_MaxNoteEvents;
+   }
+   pt_NoteEvents = pt_MidiEventInstance->pat_NoteEvents;
+
+   //all events
+   *oppt_NoteEvents = pt_NoteEvents;
+   s32_Count = decode_note_events(&pu8_Chunk, pu8_ChunkEnd, pt_NoteEvents, INT32_MAX);
+
+   //return number of note events
+   return s32_Count;
+}
+
+
+
+/*
+   Single linear pass, compacting the note events in place.
+   Each note event defines the signal until the subsequent event occurs. So an event
+   is redundant, if
+   - the subsequent event has delta time 0 (zero length segment), or
+   - it is a note off event, followed by a note on event within ou32_MaxGapTicks
+     (the short rest is added to the previous note).
+   The delta time of a removed event is added to the subsequent event, so the absolute
+   time of all remaining events is preserved.
+*/
+int32_t midi_event_strip_redundant_note_events(const int32_t os32_Length, T_midi_event_note * opt_NoteEvents, const uint32_t ou32_MaxGapTicks)
+{
+   const T_midi_event_note * pt_Read;
+   T_midi_event_note * pt_Write;
+   uint32_t u32_Carry;
+   int32_t s32_Count;
+
+   //preconditional check
+   if (os32_Length <= 0)
+   {
+      return -1;
+   }
+
+   //for each note event
+   pt_Read = opt_NoteEvents;
+   pt_Write = opt_NoteEvents;
+   u32_Carry = 0;
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      T_midi_event_note t_NoteEvent;
+
+      t_NoteEvent = *pt_Read;
+      t_NoteEvent.u32_DeltaTime += u32_Carry;
+      u32_Carry = 0;
+
+      //the last event is kept in each case (it terminates the sequence)
+      if ((s32_Count + 1) < os32_Length)
+      {
+         const T_midi_event_note * const pt_Next = &pt_Read[1];
+
+         //zero length segment
+         if (pt_Next->u32_DeltaTime == 0)
+         {
+            u32_Carry = t_NoteEvent.u32_DeltaTime;
+            ++pt_Read;
+            continue;
+         }
+         //note off, immediately followed by note on
+         if ((t_NoteEvent.u8_OnOff == 0) && (pt_Next->u8_OnOff != 0) && (pt_Next->u32_DeltaTime <= ou32_MaxGapTicks))
+         {
+            u32_Carry = t_NoteEvent.u32_DeltaTime;
+            ++pt_Read;
+            continue;
+         }
+      }
+
+      //keep event
+      *pt_Write++ = t_NoteEvent;
+      ++pt_Read;
+   }
+
+   //return number of remaining note events
+   return (int32_t)(pt_Write - opt_NoteEvents);
+}
+
+
+
+/*
+   Demultiplex the note events of a track by channel (single pass over the events). The events of
+   each selected channel (bit n of ou16_ChannelMask: channel n, 0..15) are stored in ascending channel order
+   to opat_ChannelEvents, which must hold os32_Length + 16 events. Each channel starts with a rest, that
+   aligns its first note to the start of the track, so the channels stay in sync when played together.
+   opas32_NumOfEvents[16] returns the number of events per channel (0: channel not selected or unused).
+   Returns the total number of stored events.
+*/
+int32_t midi_event_split_channels(const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents, const uint16_t ou16_ChannelMask,
+                                  T_midi_event_note * const opat_ChannelEvents, int32_t * const opas32_NumOfEvents)
+{
+   T_midi_event_note * apt_Write[16];
+   uint32_t au32_LastTick[16];
+   uint32_t u32_Tick;
+   uint32_t u32_Channel;
+   int32_t s32_Count;
+   int32_t s32_Offset;
+
+   //number of events per channel -> start of each channel
+   memset(opas32_NumOfEvents, 0, 16 * sizeof(int32_t));
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      if (((ou16_ChannelMask >> (opt_NoteEvents[s32_Count].u8_Channel & 0x0Fu)) & 1u) != 0)
+      {
+         ++opas32_NumOfEvents[opt_NoteEvents[s32_Count].u8_Channel & 0x0Fu];
+      }
+   }
+   s32_Offset = 0;
+   for (u32_Channel = 0; u32_Channel < 16; ++u32_Channel)
+   {
+      apt_Write[u32_Channel] = &opat_ChannelEvents[s32_Offset];
+      au32_LastTick[u32_Channel] = 0;
+      if (opas32_NumOfEvents[u32_Channel] > 0)
+      {
+         //leading rest
+         memset(apt_Write[u32_Channel], 0, sizeof(T_midi_event_note));
+         apt_Write[u32_Channel]->u8_Channel = (uint8_t)u32_Channel;
+         ++apt_Write[u32_Channel];
+         ++opas32_NumOfEvents[u32_Channel];
+         s32_Offset += opas32_NumOfEvents[u32_Channel];
+      }
+   }
+
+   //route events, delta times relative to the previous event of the same channel
+   //(the delta time of the first event is ignored by the signal generation, so the time starts there)
+   u32_Tick = 0;
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      u32_Channel = opt_NoteEvents[s32_Count].u8_Channel & 0x0Fu;
+      if (s32_Count > 0)
+      {
+         u32_Tick += opt_NoteEvents[s32_Count].u32_DeltaTime;
+      }
+      if (((ou16_ChannelMask >> u32_Channel) & 1u) != 0)
+      {
+         *apt_Write[u32_Channel] = opt_NoteEvents[s32_Count];
+         apt_Write[u32_Channel]->u32_DeltaTime = u32_Tick - au32_LastTick[u32_Channel];
+         au32_LastTick[u32_Channel] = u32_Tick;
+         ++apt_Write[u32_Channel];
+      }
+   }
+
+   return s32_Offset;
+}
+
+
+
+/*
+   Incremental variant of midi_event_get_note_events: each call decodes the subsequent
+   note events into the given buffer (e.g. to process a large track block by block).
+   Returns the number of note events, 0 at the end of the track, -1 on invalid data.
+*/
+int32_t midi_event_get_next_note_events(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_note * const opat_NoteEvents, const int32_t os32_MaxEvents)
+{
+   T_midi_event_instance * const pt_MidiEventInstance = (T_midi_event_instance *)opv_Handle;
+   const T_midi_track_chunk * const pt_TrackChunk = pt_MidiEventInstance->pt_TrackChunk;
+
+   return decode_note_events(&pt_MidiEventInstance->pu8_Next, &pt_TrackChunk->pu8_Chunk[pt_TrackChunk->u32_ChunkSize],
+                             opat_NoteEvents, os32_MaxEvents);
+}
+
+
+/*
+   Single pass over the track, recording the decoder state whenever an event reaches the
+   next multiple of ou32_IntervalTicks. The first checkpoint is the start of the track.
+   Unlike decode_note_events, running status and sysex events are supported.
+   Decoding stops at invalid data. Returns the number of checkpoints, -1 on invalid interval or if
+   the memory cannot be allocated.
+*/
+int32_t midi_event_get_checkpoints(T_MIDI_EVENT_HANDLE opv_Handle, const uint32_t ou32_IntervalTicks, T_midi_event_checkpoint ** oppt_Checkpoints)
+{
+   T_midi_event_instance * const pt_MidiEventInstance = (T_midi_event_instance *)opv_Handle;
+   const T_midi_track_chunk * const pt_TrackChunk = pt_MidiEventInstance->pt_TrackChunk;
+   const uint8_t * pu8_Chunk = pt_TrackChunk->pu8_Chunk;
+   const uint8_t * const pu8_ChunkEnd = &pu8_Chunk[pt_TrackChunk->u32_ChunkSize];
+   T_midi_event_checkpoint t_State;
+   uint32_t u32_MaxCheckpoints;
+   uint32_t u32_NextTick;
    int32_t s32_Count;
 
+   //preconditional check
+   if (ou32_IntervalTicks == 0)
+   {
+      return -1;
+   }
+
+   //initial state: start of track
+   memset(&t_State, 0, sizeof(t_State));
+   t_State.u8_LastOnOff = 0xFF;
+   u32_MaxCheckpoints = 64;
+   free(pt_MidiEventInstance->pat_Checkpoints);
+   pt_MidiEventInstance->pat_Checkpoints = malloc(u32_MaxCheckpoints * sizeof(T_midi_event_checkpoint));
+   if (pt_MidiEventInstance->pat_Checkpoints == NULL)
+   {
+      return -1;
+   }
+   pt_MidiEventInstance->pat_Checkpoints[0] = t_State;
+   s32_Count = 1;
+   u32_NextTick = ou32_IntervalTicks;
 
    //for each event
-   s32_Count = 0;
+   while (pu8_Chunk < pu8_ChunkEnd)
+   {
+      const uint8_t * const pu8_Event = pu8_Chunk;
+      T_midi_event_note t_NoteEvent;
+      uint32_t u32_DeltaTime;
+      uint8_t u8_RunningStatus;
+      int32_t s32_Result;
+
+      u8_RunningStatus = t_State.u8_RunningStatus;
+      s32_Result = decode_event(&pu8_Chunk, pu8_ChunkEnd, &u8_RunningStatus, &u32_DeltaTime, &t_NoteEvent);
+      if (s32_Result < 0)
+      {
+         break; //the checkpoints in front are valid anyway
+      }
+
+      //event reaches the next interval -> record state in front of it
+      if ((t_State.u32_Tick + u32_DeltaTime) >= u32_NextTick)
+      {
+         if ((uint32_t)s32_Count >= u32_MaxCheckpoints)
+         {
+            T_midi_event_checkpoint * const pt_Checkpoints = realloc(pt_MidiEventInstance->pat_Checkpoints,
+                                                                     2 * u32_MaxCheckpoints * sizeof(T_midi_event_checkpoint));
+
+            if (pt_Checkpoints == NULL)
+            {
+               free(pt_MidiEventInstance->pat_Checkpoints);
+               pt_MidiEventInstance->pat_Checkpoints = NULL;
+               return -1;
+            }
+            pt_MidiEventInstance->pat_Checkpoints = pt_Checkpoints;
+            u32_MaxCheckpoints *= 2;
+         }
+         t_State.u32_Offset = (uint32_t)(pu8_Event - pt_TrackChunk->pu8_Chunk);
+         pt_MidiEventInstance->pat_Checkpoints[s32_Count++] = t_State;
+         u32_NextTick = (((t_State.u32_Tick + u32_DeltaTime) / ou32_IntervalTicks) + 1) * ou32_IntervalTicks;
+      }
+
+      //apply event
+      t_State.u32_Tick += u32_DeltaTime;
+      t_State.u8_RunningStatus = u8_RunningStatus;
+      if (s32_Result > 0)
+      {
+         update_checkpoint(&t_State, &t_NoteEvent);
+      }
+   }
+
+   //return number of checkpoints
+   *oppt_Checkpoints = pt_MidiEventInstance->pat_Checkpoints;
+   return s32_Count;
+}
+
+
+/*
+   Decode the note events of the window [ou32_FromTick, ou32_ToTick), starting at the given
+   checkpoint. The window starts with the notes, that are sounding at ou32_FromTick (the last
+   note event before is repeated last), and ends with note off events at ou32_ToTick (or at the
+   end of the track). Delta times are relative to the start of the window.
+   Returns the number of note events (0 if no note sounds within the window), -1 on invalid data or if
+   the memory cannot be allocated.
+*/
+int32_t midi_event_get_note_events_range(T_MIDI_EVENT_HANDLE opv_Handle, const T_midi_event_checkpoint * const opt_Checkpoint,
+                                         const uint32_t ou32_FromTick, const uint32_t ou32_ToTick, T_midi_event_note ** oppt_NoteEvents)
+{
+   T_midi_event_instance * const pt_MidiEventInstance = (T_midi_event_instance *)opv_Handle;
+   const T_midi_track_chunk * const pt_TrackChunk = pt_MidiEventInstance->pt_TrackChunk;
+   const uint8_t * const pu8_ChunkEnd = &pt_TrackChunk->pu8_Chunk[pt_TrackChunk->u32_ChunkSize];
+   const uint8_t * pu8_Chunk;
+   T_midi_event_checkpoint t_State;
+   T_midi_event_note * pt_NoteEvents;
+   uint32_t u32_EventTick;            //absolute time of the last added note event
+   uint32_t u32_EndTick;
+   uint32_t u32_NumOfNotes;           //sounding notes at the start + note events within the window
+   int32_t s32_Count;
+   uint8_t u8_Started;
+   uint8_t u8_Reached;                //an event at or behind the end of the window was decoded
+
+   //------------------------------------------------------------//
+   // allocate buffer for note events                            //
+   //------------------------------------------------------------//
+   {
+      //as midi_event_get_note_events, plus the notes, that are sounding at the start and the end of the window
+      //(a smaller buffer of midi_event_get_note_events is replaced)
+      const uint32_t u32_MaxNoteEvents = (pt_TrackChunk->u32_ChunkSize / 4) + 1 + (2 * ((16 * 128) + 1));
+
+      if (pt_MidiEventInstance->u32_MaxNoteEvents < u32_MaxNoteEvents)
+      {
+         free(pt_MidiEventInstance->pat_NoteEvents);
+         pt_MidiEventInstance->pat_NoteEvents = malloc(u32_MaxNoteEvents * sizeof(T_midi_event_note));
+         if (pt_MidiEventInstance->pat_NoteEvents == NULL)
+         {
+            pt_MidiEventInstance->u32_MaxNoteEvents = 0;
+            return -1;
+         }
+         pt_MidiEventInstance->u32_MaxNoteEvents = u32_MaxNoteEvents;
+      }
+   }
+   pt_NoteEvents = pt_MidiEventInstance->pat_NoteEvents;
    *oppt_NoteEvents = pt_NoteEvents;
-   while(pu8_Chunk < pu8_ChunkEnd)
+
+   //------------------------------------------------------------//
+   // seek to checkpoint                                         //
+   //------------------------------------------------------------//
+   memset(&t_State, 0, sizeof(t_State));
+   t_State.u8_LastOnOff = 0xFF;
+   if (opt_Checkpoint != NULL)
+   {
+      if ((opt_Checkpoint->u32_Offset > pt_TrackChunk->u32_ChunkSize) || (opt_Checkpoint->u32_Tick > ou32_FromTick))
+      {
+         return -1;
+      }
+      t_State = *opt_Checkpoint;
+   }
+   pu8_Chunk = &pt_TrackChunk->pu8_Chunk[t_State.u32_Offset];
+
+   //------------------------------------------------------------//
+   // decode up to the end of the window                         //
+   //------------------------------------------------------------//
+   s32_Count = 0;
+   u32_NumOfNotes = 0;
+   u32_EventTick = ou32_FromTick;
+   u32_EndTick = ou32_ToTick;
+   u8_Started = 0;
+   u8_Reached = 0;
+   while (pu8_Chunk < pu8_ChunkEnd)
+   {
+      T_midi_event_note t_NoteEvent;
+      uint32_t u32_DeltaTime;
+      int32_t s32_Result;
+
+      s32_Result = decode_event(&pu8_Chunk, pu8_ChunkEnd, &t_State.u8_RunningStatus, &u32_DeltaTime, &t_NoteEvent);
+      if (s32_Result < 0)
+      {
+         return -1;
+      }
+      //start of window: sounding notes
+      if ((u8_Started == 0) && ((t_State.u32_Tick + u32_DeltaTime) >= ou32_FromTick))
+      {
+         s32_Count = add_window_start(&t_State, pt_NoteEvents);
+         u32_NumOfNotes = (uint32_t)s32_Count - ((t_State.u8_LastOnOff != 1) ? 1 : 0);
+         u8_Started = 1;
+      }
+      if ((t_State.u32_Tick + u32_DeltaTime) >= ou32_ToTick)
+      {
+         u8_Reached = 1;
+         break;
+      }
+      t_State.u32_Tick += u32_DeltaTime;
+      u32_EndTick = t_State.u32_Tick;
+      if (s32_Result > 0)
+      {
+         update_checkpoint(&t_State, &t_NoteEvent);
+         if (u8_Started != 0)
+         {
+            t_NoteEvent.u32_DeltaTime = t_State.u32_Tick - u32_EventTick;
+            pt_NoteEvents[s32_Count++] = t_NoteEvent;
+            u32_EventTick = t_State.u32_Tick;
+            ++u32_NumOfNotes;
+         }
+      }
+   }
+   if (u8_Reached != 0)
+   {
+      u32_EndTick = ou32_ToTick;
+   }
+   //window starts behind the end of the track
+   if ((u8_Started == 0) || (u32_NumOfNotes == 0))
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // end of window: release sounding notes                      //
+   //------------------------------------------------------------//
+   {
+      T_midi_event_note t_NoteOff;
+
+      t_NoteOff.u32_DeltaTime = u32_EndTick - u32_EventTick;
+      t_NoteOff.u8_OnOff = 0;
+      t_NoteOff.u8_Velocity = 0;
+      t_NoteOff.u8_Channel = ((t_State.u8_LastOnOff != 0xFF) ? t_State.u8_LastChannel : 0);
+      t_NoteOff.u8_Note = ((t_State.u8_LastOnOff != 0xFF) ? t_State.u8_LastNote : 0);
+      //at least one event terminates the last signal
+      pt_NoteEvents[s32_Count++] = t_NoteOff;
+      t_NoteOff.u32_DeltaTime = 0;
+      for (uint32_t u32_Channel = 0; u32_Channel < 16; ++u32_Channel)
+      {
+         for (uint32_t u32_Note = 0; u32_Note < 128; ++u32_Note)
+         {
+            if (((t_State.au16_ActiveNotes[u32_Channel][u32_Note >> 4] >> (u32_Note & 0x0Fu)) & 1u) != 0)
+            {
+               t_NoteOff.u8_Channel = (uint8_t)u32_Channel;
+               t_NoteOff.u8_Note = (uint8_t)u32_Note;
+               pt_NoteEvents[s32_Count++] = t_NoteOff;
+            }
+         }
+      }
+   }
+
+   //return number of note events
+   return s32_Count;
+}
+
+
+void midi_event_print_note_events(const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents)
+{
+   int32_t s32_Count;
+
+
+   //for each note event
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      printf("%d. %s\n", s32_Count, mapcn_MidiEvent[8 + opt_NoteEvents->u8_OnOff]);
+      printf("\tChannel %d", opt_NoteEvents->u8_Channel);
+      printf("\tNote %d", opt_NoteEvents->u8_Note);
+      printf("\tVelocity %d", opt_NoteEvents->u8_Velocity);
+      printf("\tDelta Time %d\n", opt_NoteEvents->u32_DeltaTime);
+      //
+      ++opt_NoteEvents;
+   }
+}
+
+
+
+
+
+
+
+
+
+/*
+   Lightweight single pass over all events of the track (e.g. to scan large collections).
+   Unlike the other decoders, running status and sysex events are supported and the data
+   is checked against the end of the chunk. Tempo changes are stored to opat_Tempo (up to
+   ou32_MaxTempos entries), all other events are just counted. Each change of the number of
+   sounding notes is stored to opat_Polyphony (up to ou32_MaxPolyphony entries), so the
+   polyphony of several tracks can be combined by the caller.
+   Returns the number of polyphony changes, -1 if the track contains invalid data (statistic
+   is valid up to that point).
+*/
+int32_t midi_event_get_statistic(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_statistic * const opt_Statistic,
+                                 T_midi_event_tempo * const opat_Tempo, const uint32_t ou32_MaxTempos,
+                                 T_midi_event_polyphony * const opat_Polyphony, const uint32_t ou32_MaxPolyphony)
+{
+   T_midi_event_instance * const pt_MidiEventInstance = (T_midi_event_instance *)opv_Handle;
+   const T_midi_track_chunk * const pt_TrackChunk = pt_MidiEventInstance->pt_TrackChunk;
+   const uint8_t * pu8_Chunk = pt_TrackChunk->pu8_Chunk;
+   const uint8_t * const pu8_ChunkEnd = &pu8_Chunk[pt_TrackChunk->u32_ChunkSize];
+   uint8_t au8_Active[16][128]; //number of note on events per channel and note
+   uint16_t u16_Polyphony;
+   uint8_t u8_RunningStatus;
+   uint32_t u32_Tick;
+   int32_t s32_NumOfChanges;
+
+   memset(opt_Statistic, 0, sizeof(T_midi_event_statistic));
+   memset(au8_Active, 0, sizeof(au8_Active));
+   opt_Statistic->u8_MinNote = 0x7F;
+   u16_Polyphony = 0;
+   u8_RunningStatus = 0;
+   u32_Tick = 0;
+   s32_NumOfChanges = 0;
+
+   //for each event
+   while (pu8_Chunk < pu8_ChunkEnd)
+   {
+      uint32_t u32_DeltaTime;
+      uint32_t u32_Length;
+      uint8_t u8_Command;
+      uint8_t u8_MidiCommand;
+
+      //get delta time from variable length value and address of subsequent event
+      pu8_Chunk = get_variable_length_value(pu8_Chunk, pu8_ChunkEnd, &u32_DeltaTime);
+      if ((pu8_Chunk == NULL) || (pu8_Chunk >= pu8_ChunkEnd))
+      {
+         return -1;
+      }
+      u32_Tick += u32_DeltaTime;
+
+      //get command byte (data byte -> running status)
+      u8_Command = *pu8_Chunk;
+      if (u8_Command < 0x80)
+      {
+         if (u8_RunningStatus == 0)
+         {
+            return -1;
+         }
+         u8_Command = u8_RunningStatus;
+      }
+      else
+      {
+         ++pu8_Chunk;
+      }
+      u8_MidiCommand = u8_Command & 0xF0;
+      ++opt_Statistic->au32_NumOfEvents[(u8_MidiCommand >> 4) - 8];
+
+      //meta and sysex events
+      if (u8_MidiCommand == 0xF0)
+      {
+         uint8_t u8_MetaType;
+
+         u8_RunningStatus = 0; //cancelled by meta and sysex events
+         u8_MetaType = 0;
+         if (u8_Command == 0xFF)
+         {
+            if (pu8_Chunk >= pu8_ChunkEnd)
+            {
+               return -1;
+            }
+            u8_MetaType = *pu8_Chunk++;
+         }
+         else if ((u8_Command != 0xF0) && (u8_Command != 0xF7))
+         {
+            return -1;
+         }
+         pu8_Chunk = get_variable_length_value(pu8_Chunk, pu8_ChunkEnd, &u32_Length);
+         if ((pu8_Chunk == NULL) || (u32_Length > (uint32_t)(pu8_ChunkEnd - pu8_Chunk)))
+         {
+            return -1;
+         }
+         //set tempo
+         if ((u8_MetaType == 0x51) && (u32_Length == 3))
+         {
+            const uint32_t u32_TempoUs = ((uint32_t)pu8_Chunk[0] << 16) | ((uint32_t)pu8_Chunk[1] << 8) | pu8_Chunk[2];
+
+            if (opt_Statistic->u32_NumOfTempos < ou32_MaxTempos)
+            {
+               opat_Tempo[opt_Statistic->u32_NumOfTempos].u32_Tick = u32_Tick;
+               opat_Tempo[opt_Statistic->u32_NumOfTempos].u32_TempoUs = u32_TempoUs;
+            }
+            if ((opt_Statistic->u32_NumOfTempos == 0) || (u32_TempoUs < opt_Statistic->u32_MinTempoUs))
+            {
+               opt_Statistic->u32_MinTempoUs = u32_TempoUs;
+            }
+            if (u32_TempoUs > opt_Statistic->u32_MaxTempoUs)
+            {
+               opt_Statistic->u32_MaxTempoUs = u32_TempoUs;
+            }
+            ++opt_Statistic->u32_NumOfTempos;
+         }
+         pu8_Chunk += u32_Length;
+         continue;
+      }
+
+      //channel events: 2 byte commands have one data byte, all others two
+      u8_RunningStatus = u8_Command;
+      u32_Length = (((u8_MidiCommand == 0xC0) || (u8_MidiCommand == 0xD0)) ? 1 : 2);
+      if (u32_Length > (uint32_t)(pu8_ChunkEnd - pu8_Chunk))
+      {
+         return -1;
+      }
+      if ((u8_MidiCommand == 0x80) || (u8_MidiCommand == 0x90))
+      {
+         uint8_t * const pu8_Active = &au8_Active[u8_Command & 0x0F][pu8_Chunk[0] & 0x7F];
+
+         if ((u8_MidiCommand == 0x90) && (pu8_Chunk[1] != 0))
+         {
+            //note on
+            ++opt_Statistic->u32_NumOfNotes;
+            if (pu8_Chunk[0] < opt_Statistic->u8_MinNote)
+            {
+               opt_Statistic->u8_MinNote = pu8_Chunk[0];
+            }
+            if (pu8_Chunk[0] > opt_Statistic->u8_MaxNote)
+            {
+               opt_Statistic->u8_MaxNote = pu8_Chunk[0];
+            }
+            if (*pu8_Active < 0xFF)
+            {
+               ++(*pu8_Active);
+               ++u16_Polyphony;
+               if ((opat_Polyphony != NULL) && ((uint32_t)s32_NumOfChanges < ou32_MaxPolyphony))
+               {
+                  opat_Polyphony[s32_NumOfChanges].u32_Tick = u32_Tick;
+                  opat_Polyphony[s32_NumOfChanges].s32_Change = 1;
+               }
+               ++s32_NumOfChanges;
+            }
+            if (u16_Polyphony > opt_Statistic->u16_MaxPolyphony)
+            {
+               opt_Statistic->u16_MaxPolyphony = u16_Polyphony;
+            }
+         }
+         else if (*pu8_Active > 0)
+         {
+            //note off (or note on with velocity 0)
+            --(*pu8_Active);
+            --u16_Polyphony;
+            if ((opat_Polyphony != NULL) && ((uint32_t)s32_NumOfChanges < ou32_MaxPolyphony))
+            {
+               opat_Polyphony[s32_NumOfChanges].u32_Tick = u32_Tick;
+               opat_Polyphony[s32_NumOfChanges].s32_Change = -1;
+            }
+            ++s32_NumOfChanges;
+         }
+      }
+      pu8_Chunk += u32_Length;
+   }
+
+   opt_Statistic->u32_DurationTicks = u32_Tick;
+   if (opt_Statistic->u32_NumOfNotes == 0)
+   {
+      opt_Statistic->u8_MinNote = 0;
+   }
+   return s32_NumOfChanges;
+}
+
+
+
+
+
+
+
+
+
+/*
+   Decode up to os32_MaxEvents note events, starting at *oppu8_Chunk.
+   *oppu8_Chunk is advanced to the first event, that was not decoded.
+*/
+static int32_t decode_note_events(const uint8_t ** const oppu8_Chunk, const uint8_t * const opu8_ChunkEnd,
+                                  T_midi_event_note * opt_NoteEvents, const int32_t os32_MaxEvents)
+{
+   const uint8_t * pu8_Chunk = *oppu8_Chunk;
+   int32_t s32_Count;
+
+   //for each event
+   s32_Count = 0;
+   while ((pu8_Chunk < opu8_ChunkEnd) && (s32_Count < os32_MaxEvents))
    {
       uint8_t u8_Command;
       uint8_t u8_MidiChannel;
@@ -207,7 +852,12 @@ int32_t midi_event_get_note_events(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_
       uint32_t u32_DeltaTime;
 
       //get delta time from variable length value and address of subsequent event
-      pu8_Chunk = get_variable_length_value(pu8_Chunk, &u32_DeltaTime);
+      pu8_Chunk = get_variable_length_value(pu8_Chunk, opu8_ChunkEnd, &u32_DeltaTime);
+      if (pu8_Chunk == NULL)
+      {
+         pu8_Chunk = opu8_ChunkEnd;
+         break;
+      }
 
       //get command byte and switch by midi command
       u8_Command = *pu8_Chunk;
@@ -218,18 +868,18 @@ int32_t midi_event_get_note_events(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_
       //3 byte command
       case 0x80: //Note off
       case 0x90: //Note on
-         pt_NoteEvents->u32_DeltaTime = u32_DeltaTime;
-         pt_NoteEvents->u8_OnOff = ((u8_MidiCommand == 0x80) ? 0 : 1);
-         pt_NoteEvents->u8_Channel = u8_MidiChannel;
-         pt_NoteEvents->u8_Note = pu8_Chunk[1];
-         pt_NoteEvents->u8_Velocity = pu8_Chunk[2];
-         if (pt_NoteEvents->u8_Velocity == 0) //velocity == 0 is synoym for note off
+         opt_NoteEvents->u32_DeltaTime = u32_DeltaTime;
+         opt_NoteEvents->u8_OnOff = ((u8_MidiCommand == 0x80) ? 0 : 1);
+         opt_NoteEvents->u8_Channel = u8_MidiChannel;
+         opt_NoteEvents->u8_Note = pu8_Chunk[1];
+         opt_NoteEvents->u8_Velocity = pu8_Chunk[2];
+         if (opt_NoteEvents->u8_Velocity == 0) //velocity == 0 is synoym for note off
          {
-            pt_NoteEvents->u8_OnOff = 0; //note off is intended
+            opt_NoteEvents->u8_OnOff = 0; //note off is intended
          }
          //continue
          ++s32_Count;
-         ++pt_NoteEvents;
+         ++opt_NoteEvents;
          pu8_Chunk = &pu8_Chunk[3];
          break;
 
@@ -265,71 +915,183 @@ int32_t midi_event_get_note_events(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_
 
       default:
          printf("[E] Invalid Command 0x%02X!\n", u8_Command);
+         *oppu8_Chunk = pu8_Chunk;
          return - 1;
       }
    }
 
+   *oppu8_Chunk = pu8_Chunk;
    //return number of note events
    return s32_Count;
 }
 
 
-
-int32_t midi_event_strip_redundant_note_events(const int32_t os32_Length, T_midi_event_note * opt_NoteEvents)
+/*
+   Decode one event (running status, meta and sysex events supported), checked against the
+   end of the chunk. Returns 1 for a note event (opt_NoteEvent is valid), 0 for any other
+   event, -1 on invalid data.
+*/
+static int32_t decode_event(const uint8_t ** const oppu8_Chunk, const uint8_t * const opu8_ChunkEnd, uint8_t * const opu8_RunningStatus,
+                            uint32_t * const opu32_DeltaTime, T_midi_event_note * const opt_NoteEvent)
 {
-   return -1;
-}
-
-
+   const uint8_t * pu8_Chunk = *oppu8_Chunk;
+   uint32_t u32_Length;
+   uint8_t u8_Command;
+   uint8_t u8_MidiCommand;
+
+   //get delta time from variable length value and address of subsequent event
+   pu8_Chunk = get_variable_length_value(pu8_Chunk, opu8_ChunkEnd, opu32_DeltaTime);
+   if ((pu8_Chunk == NULL) || (pu8_Chunk >= opu8_ChunkEnd))
+   {
+      return -1;
+   }
 
-void midi_event_print_note_events(const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents)
-{
-   int32_t s32_Count;
+   //get command byte (data byte -> running status)
+   u8_Command = *pu8_Chunk;
+   if (u8_Command < 0x80)
+   {
+      if (*opu8_RunningStatus == 0)
+      {
+         return -1;
+      }
+      u8_Command = *opu8_RunningStatus;
+   }
+   else
+   {
+      ++pu8_Chunk;
+   }
+   u8_MidiCommand = u8_Command & 0xF0;
 
+   //meta and sysex events
+   if (u8_MidiCommand == 0xF0)
+   {
+      *opu8_RunningStatus = 0; //cancelled by meta and sysex events
+      if (u8_Command == 0xFF)
+      {
+         ++pu8_Chunk; //meta type
+      }
+      else if ((u8_Command != 0xF0) && (u8_Command != 0xF7))
+      {
+         return -1;
+      }
+      if (pu8_Chunk >= opu8_ChunkEnd)
+      {
+         return -1;
+      }
+      pu8_Chunk = get_variable_length_value(pu8_Chunk, opu8_ChunkEnd, &u32_Length);
+      if ((pu8_Chunk == NULL) || (u32_Length > (uint32_t)(opu8_ChunkEnd - pu8_Chunk)))
+      {
+         return -1;
+      }
+      *oppu8_Chunk = &pu8_Chunk[u32_Length];
+      return 0;
+   }
 
-   //for each note event
-   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   //channel events: 2 byte commands have one data byte, all others two
+   *opu8_RunningStatus = u8_Command;
+   u32_Length = (((u8_MidiCommand == 0xC0) || (u8_MidiCommand == 0xD0)) ? 1 : 2);
+   if (u32_Length > (uint32_t)(opu8_ChunkEnd - pu8_Chunk))
    {
-      printf("%d. %s\n", s32_Count, mapcn_MidiEvent[8 + opt_NoteEvents->u8_OnOff]);
-      printf("\tChannel %d", opt_NoteEvents->u8_Channel);
-      printf("\tNote %d", opt_NoteEvents->u8_Note);
-      printf("\tVelocity %d", opt_NoteEvents->u8_Velocity);
-      printf("\tDelta Time %d\n", opt_NoteEvents->u32_DeltaTime);
-      //
-      ++opt_NoteEvents;
+      return -1;
    }
+   *oppu8_Chunk = &pu8_Chunk[u32_Length];
+   if ((u8_MidiCommand != 0x80) && (u8_MidiCommand != 0x90))
+   {
+      return 0;
+   }
+   opt_NoteEvent->u32_DeltaTime = *opu32_DeltaTime;
+   opt_NoteEvent->u8_OnOff = (((u8_MidiCommand == 0x90) && (pu8_Chunk[1] != 0)) ? 1 : 0); //velocity == 0 is synoym for note off
+   opt_NoteEvent->u8_Channel = u8_Command & 0x0F;
+   opt_NoteEvent->u8_Note = pu8_Chunk[0] & 0x7F;
+   opt_NoteEvent->u8_Velocity = pu8_Chunk[1];
+   return 1;
 }
 
 
+//apply a note event to the set of sounding notes
+static void update_checkpoint(T_midi_event_checkpoint * const opt_State, const T_midi_event_note * const opt_NoteEvent)
+{
+   uint16_t * const pu16_Active = &opt_State->au16_ActiveNotes[opt_NoteEvent->u8_Channel][opt_NoteEvent->u8_Note >> 4];
+   const uint16_t u16_Bit = (uint16_t)(1u << (opt_NoteEvent->u8_Note & 0x0Fu));
 
+   if (opt_NoteEvent->u8_OnOff != 0)
+   {
+      *pu16_Active |= u16_Bit;
+   }
+   else
+   {
+      *pu16_Active &= (uint16_t)~u16_Bit;
+   }
+   opt_State->u8_LastOnOff = opt_NoteEvent->u8_OnOff;
+   opt_State->u8_LastChannel = opt_NoteEvent->u8_Channel;
+   opt_State->u8_LastNote = opt_NoteEvent->u8_Note;
+}
 
 
+/*
+   Note on events (delta time 0) for all sounding notes. The last note event is added last,
+   so it defines the signal of a single voice; a note off is added, if there was none or a
+   note off (rest at the start of the window). Returns the number of added events.
+*/
+static int32_t add_window_start(const T_midi_event_checkpoint * const opt_State, T_midi_event_note * const opt_NoteEvents)
+{
+   T_midi_event_note t_NoteEvent;
+   int32_t s32_Count;
 
-
+   s32_Count = 0;
+   t_NoteEvent.u32_DeltaTime = 0;
+   t_NoteEvent.u8_OnOff = 1;
+   t_NoteEvent.u8_Velocity = 64; //velocity is not recorded
+   for (uint32_t u32_Channel = 0; u32_Channel < 16; ++u32_Channel)
+   {
+      for (uint32_t u32_Note = 0; u32_Note < 128; ++u32_Note)
+      {
+         if ((((opt_State->au16_ActiveNotes[u32_Channel][u32_Note >> 4] >> (u32_Note & 0x0Fu)) & 1u) != 0) &&
+             ((opt_State->u8_LastOnOff != 1) || (opt_State->u8_LastChannel != u32_Channel) || (opt_State->u8_LastNote != u32_Note)))
+         {
+            t_NoteEvent.u8_Channel = (uint8_t)u32_Channel;
+            t_NoteEvent.u8_Note = (uint8_t)u32_Note;
+            opt_NoteEvents[s32_Count++] = t_NoteEvent;
+         }
+      }
+   }
+   t_NoteEvent.u8_OnOff = ((opt_State->u8_LastOnOff == 1) ? 1 : 0);
+   t_NoteEvent.u8_Velocity = ((opt_State->u8_LastOnOff == 1) ? 64 : 0);
+   t_NoteEvent.u8_Channel = ((opt_State->u8_LastOnOff != 0xFF) ? opt_State->u8_LastChannel : 0);
+   t_NoteEvent.u8_Note = ((opt_State->u8_LastOnOff != 0xFF) ? opt_State->u8_LastNote : 0);
+   opt_NoteEvents[s32_Count++] = t_NoteEvent;
+   return s32_Count;
+}
 
 
 /*
    If byte is greater or equal to 80h (128 decimal) then the next byte
         is also part of the VLV,
    else byte is the last byte in a VLV.
+   A VLV has at most 4 bytes and must end before opu8_DataEnd, otherwise NULL is returned.
 */
-static const uint8_t * get_variable_length_value(const uint8_t * opu8_Data, uint32_t * opu32_Vlv)
+static const uint8_t * get_variable_length_value(const uint8_t * opu8_Data, const uint8_t * const opu8_DataEnd, uint32_t * opu32_Vlv)
 {
    uint32_t u32_7Bit;
    uint32_t u32_Vlv;
+   uint32_t u32_Count;
 
    u32_Vlv = 0;
-   u32_7Bit = *opu8_Data++;
-   while ((u32_7Bit & 0x80uL) != 0) //if bit 8 is set
+   u32_Count = 0;
+   do
    {
-      u32_Vlv = ((u32_Vlv << 7) | (u32_7Bit & 0x7FuL));
+      if ((opu8_Data >= opu8_DataEnd) || (u32_Count == 4))
+      {
+         return NULL; //truncated or longer than 4 bytes
+      }
 
-      //get next part of variable length value
+      //append next 7bit
       u32_7Bit = *opu8_Data++;
+      u32_Vlv = ((u32_Vlv << 7) | (u32_7Bit & 0x7FuL));
+      ++u32_Count;
    }
+   while ((u32_7Bit & 0x80uL) != 0); //if bit 8 is set
 
-   //append last 7bit
-   u32_Vlv = ((u32_Vlv << 7) | u32_7Bit);
    *opu32_Vlv = u32_Vlv;
 
    //return consecutive address
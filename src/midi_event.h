@@ -35,6 +35,47 @@ typedef struct
 } T_midi_event_note;
 
 
+typedef struct
+{
+   uint32_t u32_Tick;                  //absolute time [ticks]
+   uint32_t u32_TempoUs;               //microseconds per quarter note
+} T_midi_event_tempo;
+
+
+typedef struct
+{
+   uint32_t u32_Tick;                  //absolute time [ticks]
+   int32_t s32_Change;                 //+1: a note starts sounding, -1: a note stops sounding
+} T_midi_event_polyphony;
+
+
+typedef struct
+{
+   uint32_t au32_NumOfEvents[8];       //by command: note off, note on, key after-touch, control change,
+                                       //program change, channel after-touch, pitch wheel, meta/sysex
+   uint32_t u32_NumOfNotes;            //note on events with velocity > 0
+   uint8_t u8_MinNote;
+   uint8_t u8_MaxNote;
+   uint16_t u16_MaxPolyphony;          //max. number of simultaneous notes
+   uint32_t u32_NumOfTempos;           //number of tempo changes
+   uint32_t u32_MinTempoUs;            //0 if there is no tempo change
+   uint32_t u32_MaxTempoUs;
+   uint32_t u32_DurationTicks;         //absolute time of last event
+} T_midi_event_statistic;
+
+
+typedef struct
+{
+   uint32_t u32_Offset;                //position of the subsequent event within the track chunk [bytes]
+   uint32_t u32_Tick;                  //absolute time of the previous event [ticks]
+   uint8_t u8_RunningStatus;           //0: none
+   uint8_t u8_LastOnOff;               //last note event before the checkpoint (0xFF: none)
+   uint8_t u8_LastChannel;
+   uint8_t u8_LastNote;
+   uint16_t au16_ActiveNotes[16][8];   //bit set of the sounding notes per channel
+} T_midi_event_checkpoint;
+
+
 /* -- Global Variables ---------------------------------------------------- */
 
 
@@ -46,8 +87,20 @@ extern void midi_event_hex_dump(T_MIDI_EVENT_HANDLE opv_Handle); //raw hex dump
 extern void midi_event_print_events(T_MIDI_EVENT_HANDLE opv_Handle); //decode events and print to stdout
 //note events
 extern int32_t midi_event_get_note_events(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_note ** oppt_NoteEvents);
-extern int32_t midi_event_strip_redundant_note_events(const int32_t os32_Length, T_midi_event_note * opt_NoteEvents);
+extern int32_t midi_event_get_next_note_events(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_note * const opat_NoteEvents, const int32_t os32_MaxEvents);
+//checkpoints every ou32_IntervalTicks; note events of a time window [ticks), decoded from a checkpoint (NULL: start of track)
+extern int32_t midi_event_get_checkpoints(T_MIDI_EVENT_HANDLE opv_Handle, const uint32_t ou32_IntervalTicks, T_midi_event_checkpoint ** oppt_Checkpoints);
+extern int32_t midi_event_get_note_events_range(T_MIDI_EVENT_HANDLE opv_Handle, const T_midi_event_checkpoint * const opt_Checkpoint,
+                                                const uint32_t ou32_FromTick, const uint32_t ou32_ToTick, T_midi_event_note ** oppt_NoteEvents);
+extern int32_t midi_event_strip_redundant_note_events(const int32_t os32_Length, T_midi_event_note * opt_NoteEvents, const uint32_t ou32_MaxGapTicks);
+//by channel (bit n of ou16_ChannelMask: channel n), opat_ChannelEvents: os32_Length + 16 events, opas32_NumOfEvents: 16 counts
+extern int32_t midi_event_split_channels(const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents, const uint16_t ou16_ChannelMask,
+                                         T_midi_event_note * const opat_ChannelEvents, int32_t * const opas32_NumOfEvents);
 extern void midi_event_print_note_events(const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents);
+//statistic (single pass, no note events are stored), opat_Polyphony: NULL -> polyphony changes are just counted
+extern int32_t midi_event_get_statistic(T_MIDI_EVENT_HANDLE opv_Handle, T_midi_event_statistic * const opt_Statistic,
+                                        T_midi_event_tempo * const opat_Tempo, const uint32_t ou32_MaxTempos,
+                                        T_midi_event_polyphony * const opat_Polyphony, const uint32_t ou32_MaxPolyphony);
 
 
 
@@ -0,0 +1,358 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     motif.c
+   \brief    Functions to compress a signal sequence by repeated phrases (motifs)
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "motif.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define MOTIF_HASH_BITS       (16)
+#define MOTIF_HASH_SIZE       (1uL << MOTIF_HASH_BITS)
+#define MOTIF_MAX_CHAIN       (64)     //max. number of candidates checked per position
+#define MOTIF_MAX_VALUE       (0xFFFF) //limit of 16-bit offset, length and loop count
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   T_sound_signal * pat_Pool;
+   int32_t s32_PoolLength;
+   T_motif_entry * pat_PlayList;
+   int32_t s32_PlayListLength;
+} T_motif_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static uint32_t get_hash(const T_sound_signal * opt_Signal);
+static int32_t get_match_length(const T_sound_signal * opt_A, const T_sound_signal * opt_B, const int32_t os32_MaxLength);
+static int32_t compress(T_motif_instance * const opt_MotifInstance, const int32_t os32_Length, const T_sound_signal * opt_SignalSequence);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_MOTIF_HANDLE motif_open(const int32_t os32_Length, const T_sound_signal * opt_SignalSequence)
+{
+   T_motif_instance * pt_MotifInstance;
+
+   //preconditional check
+   if (os32_Length <= 0)
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // allocate motif instance, pool and play list                //
+   //------------------------------------------------------------//
+   //worst case: no repetition at all -> pool and play list as long as the sequence
+   pt_MotifInstance = malloc(sizeof(T_motif_instance));
+   pt_MotifInstance->pat_Pool = malloc(os32_Length * sizeof(T_sound_signal));
+   pt_MotifInstance->s32_PoolLength = 0;
+   pt_MotifInstance->pat_PlayList = malloc(os32_Length * sizeof(T_motif_entry));
+   pt_MotifInstance->s32_PlayListLength = 0;
+
+   //------------------------------------------------------------//
+   // compress                                                   //
+   //------------------------------------------------------------//
+   if (compress(pt_MotifInstance, os32_Length, opt_SignalSequence) < 0)
+   {
+      printf("[E] Signal sequence too long for motif compression!\n");
+      motif_close(pt_MotifInstance);
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return motif instance handle
+   return pt_MotifInstance;
+}
+
+
+void motif_close(T_MOTIF_HANDLE opv_Handle)
+{
+   T_motif_instance * const pt_MotifInstance = (T_motif_instance *)opv_Handle;
+
+   //release pool, play list and instance itself
+   free(pt_MotifInstance->pat_Pool);
+   free(pt_MotifInstance->pat_PlayList);
+   free(pt_MotifInstance);
+}
+
+
+int32_t motif_get_pool(T_MOTIF_HANDLE opv_Handle, const T_sound_signal ** oppt_Pool)
+{
+   T_motif_instance * const pt_MotifInstance = (T_motif_instance *)opv_Handle;
+
+   *oppt_Pool = pt_MotifInstance->pat_Pool;
+   return pt_MotifInstance->s32_PoolLength;
+}
+
+
+int32_t motif_get_play_list(T_MOTIF_HANDLE opv_Handle, const T_motif_entry ** oppt_PlayList)
+{
+   T_motif_instance * const pt_MotifInstance = (T_motif_instance *)opv_Handle;
+
+   *oppt_PlayList = pt_MotifInstance->pat_PlayList;
+   return pt_MotifInstance->s32_PlayListLength;
+}
+
+
+void motif_print_play_list(T_MOTIF_HANDLE opv_Handle)
+{
+   T_motif_instance * const pt_MotifInstance = (T_motif_instance *)opv_Handle;
+   const T_motif_entry * pt_Entry;
+   int32_t s32_Count;
+
+   printf("Pool: %d signals, Play list: %d entries\n", pt_MotifInstance->s32_PoolLength, pt_MotifInstance->s32_PlayListLength);
+   printf("Offset, Length, Loops\n");
+   pt_Entry = pt_MotifInstance->pat_PlayList;
+   for (s32_Count = 0; s32_Count < pt_MotifInstance->s32_PlayListLength; ++s32_Count)
+   {
+      printf("%d : %d, %d, %d\n", s32_Count + 1, pt_Entry->u16_Offset, pt_Entry->u16_Length, pt_Entry->u16_Loops);
+      ++pt_Entry;
+   }
+}
+
+
+void motif_write_play_list(const char * const opc_File, T_MOTIF_HANDLE opv_Handle)
+{
+   T_motif_instance * const pt_MotifInstance = (T_motif_instance *)opv_Handle;
+   const T_sound_signal * pt_Signal;
+   const T_motif_entry * pt_Entry;
+   FILE * pv_File;
+   int32_t s32_Count;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = fopen(opc_File, "w");
+
+   //------------------------------------------------------------//
+   // write pool to file                                         //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint16_t gau16_SoundMotifPool[] = { //2x16-bit value pair : Duration [1ms], Frequeny [1Hz]\n");
+   pt_Signal = pt_MotifInstance->pat_Pool;
+   for (s32_Count = 0; s32_Count < pt_MotifInstance->s32_PoolLength; ++s32_Count)
+   {
+      fprintf(pv_File, "  %d, %d, ", pt_Signal->u16_Duration1ms, pt_Signal->u16_Frequency1Hz);
+      if ((s32_Count % 8) == 7)
+      {
+         fprintf(pv_File, "\n");
+      }
+      ++pt_Signal;
+   }
+   fprintf(pv_File, "\n};\n\n");
+
+   //------------------------------------------------------------//
+   // write play list to file                                    //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint16_t gau16_SoundPlayList[] = { //3x16-bit value triple : Pool offset, Length, Loop count\n");
+   pt_Entry = pt_MotifInstance->pat_PlayList;
+   for (s32_Count = 0; s32_Count < pt_MotifInstance->s32_PlayListLength; ++s32_Count)
+   {
+      fprintf(pv_File, "  %d, %d, %d, ", pt_Entry->u16_Offset, pt_Entry->u16_Length, pt_Entry->u16_Loops);
+      if ((s32_Count % 6) == 5)
+      {
+         fprintf(pv_File, "\n");
+      }
+      ++pt_Entry;
+   }
+   fprintf(pv_File, " 0, 0, 0\n};\n\n");
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   fclose(pv_File);
+}
+
+
+
+
+
+
+
+
+
+/*
+   Greedy single pass (LZ77 like), with the pool itself being the dictionary:
+   - a phrase, equal to the previous play list entry, increments its loop count
+   - a phrase of at least MOTIF_MIN_LENGTH signals, that is already contained in the pool,
+     becomes a reference into the pool. Candidates are looked up by a hash of the first
+     MOTIF_MIN_LENGTH signals (hash chains, limited to MOTIF_MAX_CHAIN candidates)
+   - otherwise the signal is appended to the pool (literal)
+   Returns -1 if the pool exceeds the 16-bit offset range.
+*/
+static int32_t compress(T_motif_instance * const opt_MotifInstance, const int32_t os32_Length, const T_sound_signal * opt_SignalSequence)
+{
+   T_sound_signal * const pt_Pool = opt_MotifInstance->pat_Pool;
+   T_motif_entry * const pt_PlayList = opt_MotifInstance->pat_PlayList;
+   int32_t * ps32_HashHead;
+   int32_t * ps32_HashPrev;
+   int32_t s32_Hashed;
+   int32_t s32_Pos;
+   uint32_t u32_Count;
+
+   //hash chains of pool positions
+   ps32_HashHead = malloc(MOTIF_HASH_SIZE * sizeof(int32_t));
+   ps32_HashPrev = malloc(os32_Length * sizeof(int32_t));
+   for (u32_Count = 0; u32_Count < MOTIF_HASH_SIZE; ++u32_Count)
+   {
+      ps32_HashHead[u32_Count] = -1;
+   }
+
+   //for each signal
+   s32_Hashed = 0;
+   s32_Pos = 0;
+   while (s32_Pos < os32_Length)
+   {
+      const T_sound_signal * const pt_Signal = &opt_SignalSequence[s32_Pos];
+      const int32_t s32_Remain = os32_Length - s32_Pos;
+      T_motif_entry * const pt_Last = ((opt_MotifInstance->s32_PlayListLength > 0) ? &pt_PlayList[opt_MotifInstance->s32_PlayListLength - 1] : NULL);
+      int32_t s32_BestLength;
+      int32_t s32_BestOffset;
+
+      //-----------------------------------------------------//
+      // repetition of previous entry                        //
+      //-----------------------------------------------------//
+      if ((pt_Last != NULL) &&
+          (pt_Last->u16_Length >= MOTIF_MIN_LENGTH) && (pt_Last->u16_Length <= s32_Remain) && (pt_Last->u16_Loops < MOTIF_MAX_VALUE) &&
+          (get_match_length(&pt_Pool[pt_Last->u16_Offset], pt_Signal, pt_Last->u16_Length) == pt_Last->u16_Length))
+      {
+         ++pt_Last->u16_Loops;
+         s32_Pos += pt_Last->u16_Length;
+         continue;
+      }
+
+      //-----------------------------------------------------//
+      // longest match in pool                               //
+      //-----------------------------------------------------//
+      s32_BestLength = 0;
+      s32_BestOffset = 0;
+      if (s32_Remain >= MOTIF_MIN_LENGTH)
+      {
+         int32_t s32_Candidate;
+         uint32_t u32_Chain;
+
+         s32_Candidate = ps32_HashHead[get_hash(pt_Signal)];
+         for (u32_Chain = 0; (s32_Candidate >= 0) && (u32_Chain < MOTIF_MAX_CHAIN); ++u32_Chain)
+         {
+            int32_t s32_MaxLength;
+            int32_t s32_Length;
+
+            s32_MaxLength = opt_MotifInstance->s32_PoolLength - s32_Candidate;
+            if (s32_MaxLength > s32_Remain)
+            {
+               s32_MaxLength = s32_Remain;
+            }
+            if (s32_MaxLength > MOTIF_MAX_VALUE)
+            {
+               s32_MaxLength = MOTIF_MAX_VALUE;
+            }
+            s32_Length = get_match_length(&pt_Pool[s32_Candidate], pt_Signal, s32_MaxLength);
+            if (s32_Length > s32_BestLength)
+            {
+               s32_BestLength = s32_Length;
+               s32_BestOffset = s32_Candidate;
+            }
+            s32_Candidate = ps32_HashPrev[s32_Candidate];
+         }
+      }
+
+      if (s32_BestLength >= MOTIF_MIN_LENGTH)
+      {
+         //reference into pool
+         T_motif_entry * const pt_Entry = &pt_PlayList[opt_MotifInstance->s32_PlayListLength++];
+
+         pt_Entry->u16_Offset = (uint16_t)s32_BestOffset;
+         pt_Entry->u16_Length = (uint16_t)s32_BestLength;
+         pt_Entry->u16_Loops = 1;
+         s32_Pos += s32_BestLength;
+         continue;
+      }
+
+      //-----------------------------------------------------//
+      // literal                                             //
+      //-----------------------------------------------------//
+      if (opt_MotifInstance->s32_PoolLength >= MOTIF_MAX_VALUE)
+      {
+         free(ps32_HashHead);
+         free(ps32_HashPrev);
+         return -1;
+      }
+      pt_Pool[opt_MotifInstance->s32_PoolLength++] = *pt_Signal;
+      //extend the last entry, if it is the (not repeated) tail of the pool
+      if ((pt_Last != NULL) && (pt_Last->u16_Loops == 1) &&
+          ((pt_Last->u16_Offset + pt_Last->u16_Length + 1) == opt_MotifInstance->s32_PoolLength))
+      {
+         ++pt_Last->u16_Length;
+      }
+      else
+      {
+         T_motif_entry * const pt_Entry = &pt_PlayList[opt_MotifInstance->s32_PlayListLength++];
+
+         pt_Entry->u16_Offset = (uint16_t)(opt_MotifInstance->s32_PoolLength - 1);
+         pt_Entry->u16_Length = 1;
+         pt_Entry->u16_Loops = 1;
+      }
+      ++s32_Pos;
+
+      //add all complete pool positions to hash chains
+      while ((s32_Hashed + MOTIF_MIN_LENGTH) <= opt_MotifInstance->s32_PoolLength)
+      {
+         const uint32_t u32_Hash = get_hash(&pt_Pool[s32_Hashed]);
+
+         ps32_HashPrev[s32_Hashed] = ps32_HashHead[u32_Hash];
+         ps32_HashHead[u32_Hash] = s32_Hashed;
+         ++s32_Hashed;
+      }
+   }
+
+   free(ps32_HashHead);
+   free(ps32_HashPrev);
+   return 0;
+}
+
+
+
+static uint32_t get_hash(const T_sound_signal * opt_Signal)
+{
+   uint32_t u32_Hash;
+   uint32_t u32_Count;
+
+   u32_Hash = 0;
+   for (u32_Count = 0; u32_Count < MOTIF_MIN_LENGTH; ++u32_Count)
+   {
+      u32_Hash ^= ((uint32_t)opt_Signal->u16_Duration1ms << 16) | opt_Signal->u16_Frequency1Hz;
+      u32_Hash *= 2654435761uL; //multiplicative hashing (Knuth)
+      ++opt_Signal;
+   }
+   return (u32_Hash >> (32 - MOTIF_HASH_BITS));
+}
+
+
+static int32_t get_match_length(const T_sound_signal * opt_A, const T_sound_signal * opt_B, const int32_t os32_MaxLength)
+{
+   int32_t s32_Length;
+
+   for (s32_Length = 0; s32_Length < os32_MaxLength; ++s32_Length)
+   {
+      if ((opt_A->u16_Duration1ms != opt_B->u16_Duration1ms) || (opt_A->u16_Frequency1Hz != opt_B->u16_Frequency1Hz))
+      {
+         break;
+      }
+      ++opt_A;
+      ++opt_B;
+   }
+   return s32_Length;
+}
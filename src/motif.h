@@ -0,0 +1,61 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     motif.h
+   \brief    Functions to compress a signal sequence by repeated phrases (motifs)
+
+   The signal sequence is split into a pool of unique signals and a play list.
+   Each play list entry references a range of the pool (offset, length) and
+   how often this range shall be played in a row (loop count).
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _MOTIF_H
+#define _MOTIF_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "sound.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define MOTIF_MIN_LENGTH      (4)   //minimal number of signals of a referenced motif
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_MOTIF_HANDLE;
+
+
+typedef struct
+{
+   uint16_t u16_Offset;  //index of first signal in pool
+   uint16_t u16_Length;  //number of signals
+   uint16_t u16_Loops;   //number of repetitions
+} T_motif_entry;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+extern T_MOTIF_HANDLE motif_open(const int32_t os32_Length, const T_sound_signal * opt_SignalSequence);
+extern void motif_close(T_MOTIF_HANDLE opv_Handle);
+
+extern int32_t motif_get_pool(T_MOTIF_HANDLE opv_Handle, const T_sound_signal ** oppt_Pool);
+extern int32_t motif_get_play_list(T_MOTIF_HANDLE opv_Handle, const T_motif_entry ** oppt_PlayList);
+extern void motif_print_play_list(T_MOTIF_HANDLE opv_Handle);
+extern void motif_write_play_list(const char * const opc_File, T_MOTIF_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
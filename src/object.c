@@ -0,0 +1,320 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     object.c
+   \brief    Functions to write tables as linker-ready object files
+
+   Layout of the ELF object:
+      ELF header
+      table section: table, padding to 4 bytes, size of the table (u32)
+      .symtab, .strtab, .shstrtab
+      section headers: null, table section, .note.GNU-stack, .symtab, .strtab, .shstrtab
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "object.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define OBJECT_NUM_OF_SECTIONS      (6)
+#define OBJECT_NUM_OF_SYMBOLS       (4)   //null, section, table, size
+#define OBJECT_SECTION_TABLE        (1)
+#define OBJECT_SECTION_SYMTAB       (3)
+#define OBJECT_SECTION_STRTAB       (4)
+#define OBJECT_SECTION_SHSTRTAB     (5)
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   uint8_t * pu8_Data;
+   uint32_t u32_Size;
+   uint32_t u32_MaxSize;
+   uint8_t u8_Is64;                 //1: ELF64 (addresses, offsets and sizes have 8 bytes)
+} T_object_buffer;
+
+
+typedef struct
+{
+   uint32_t u32_Name;
+   uint32_t u32_Type;
+   uint32_t u32_Flags;
+   uint32_t u32_Offset;
+   uint32_t u32_Size;
+   uint32_t u32_Link;
+   uint32_t u32_Info;
+   uint32_t u32_AddrAlign;
+   uint32_t u32_EntSize;
+} T_object_section;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void put_bytes(T_object_buffer * const opt_Buffer, const void * const opv_Data, const uint32_t ou32_Size);
+static void put_u8(T_object_buffer * const opt_Buffer, const uint8_t ou8_Value);
+static void put_u16(T_object_buffer * const opt_Buffer, const uint16_t ou16_Value);
+static void put_u32(T_object_buffer * const opt_Buffer, const uint32_t ou32_Value);
+static void put_word(T_object_buffer * const opt_Buffer, const uint32_t ou32_Value);
+static void put_align(T_object_buffer * const opt_Buffer, const uint32_t ou32_Align);
+static void put_symbol(T_object_buffer * const opt_Buffer, const uint32_t ou32_Name, const uint32_t ou32_Value, const uint32_t ou32_Size,
+                       const uint8_t ou8_Info, const uint16_t ou16_Section);
+static int32_t write_file(const char * const opc_File, const uint8_t * const opu8_Data, const uint32_t ou32_Size1By);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+int32_t object_write_elf(const char * const opc_File, const T_object_machine oe_Machine, const char * const opc_Section,
+                         const char * const opc_Symbol, const uint8_t * const opu8_Data, const uint32_t ou32_Size1By)
+{
+   T_object_buffer t_Buffer;
+   T_object_section at_Section[OBJECT_NUM_OF_SECTIONS];
+   T_object_buffer t_StrTab;
+   T_object_buffer t_ShStrTab;
+   uint32_t u32_SizeOffset;
+   uint32_t u32_Symbol;
+   uint32_t u32_SymbolSize;
+   uint32_t u32_SectionHeaders;
+   uint32_t u32_Section;
+   int32_t s32_Result;
+
+   memset(&t_Buffer, 0, sizeof(t_Buffer));
+   memset(at_Section, 0, sizeof(at_Section));
+   memset(&t_StrTab, 0, sizeof(t_StrTab));
+   memset(&t_ShStrTab, 0, sizeof(t_ShStrTab));
+   t_Buffer.u8_Is64 = ((oe_Machine == OBJECT_MACHINE_X86_64) ? 1 : 0);
+
+   //------------------------------------------------------------//
+   // string tables                                              //
+   //------------------------------------------------------------//
+   put_u8(&t_StrTab, 0);
+   u32_Symbol = t_StrTab.u32_Size;
+   put_bytes(&t_StrTab, opc_Symbol, (uint32_t)strlen(opc_Symbol) + 1);
+   u32_SymbolSize = t_StrTab.u32_Size;
+   put_bytes(&t_StrTab, opc_Symbol, (uint32_t)strlen(opc_Symbol));
+   put_bytes(&t_StrTab, "_size", 6);
+   put_u8(&t_ShStrTab, 0);
+   at_Section[OBJECT_SECTION_TABLE].u32_Name = t_ShStrTab.u32_Size;
+   put_bytes(&t_ShStrTab, opc_Section, (uint32_t)strlen(opc_Section) + 1);
+   at_Section[2].u32_Name = t_ShStrTab.u32_Size;
+   put_bytes(&t_ShStrTab, ".note.GNU-stack", 16);
+   at_Section[OBJECT_SECTION_SYMTAB].u32_Name = t_ShStrTab.u32_Size;
+   put_bytes(&t_ShStrTab, ".symtab", 8);
+   at_Section[OBJECT_SECTION_STRTAB].u32_Name = t_ShStrTab.u32_Size;
+   put_bytes(&t_ShStrTab, ".strtab", 8);
+   at_Section[OBJECT_SECTION_SHSTRTAB].u32_Name = t_ShStrTab.u32_Size;
+   put_bytes(&t_ShStrTab, ".shstrtab", 10);
+
+   //------------------------------------------------------------//
+   // ELF header (offset of section headers is patched later)    //
+   //------------------------------------------------------------//
+   put_bytes(&t_Buffer, "\177ELF", 4);
+   put_u8(&t_Buffer, ((t_Buffer.u8_Is64 != 0) ? 2 : 1)); //class
+   put_u8(&t_Buffer, 1);                                    //little endian
+   put_u8(&t_Buffer, 1);                                    //version
+   put_align(&t_Buffer, 16);                                //OS ABI (System V) and padding
+   put_u16(&t_Buffer, 1);                                   //relocatable
+   put_u16(&t_Buffer, ((t_Buffer.u8_Is64 != 0) ? 62 : 40)); //EM_X86_64, EM_ARM
+   put_u32(&t_Buffer, 1);
+   put_word(&t_Buffer, 0);                                  //entry
+   put_word(&t_Buffer, 0);                                  //program headers
+   u32_SectionHeaders = t_Buffer.u32_Size;
+   put_word(&t_Buffer, 0);                                  //section headers
+   put_u32(&t_Buffer, ((t_Buffer.u8_Is64 != 0) ? 0 : 0x05000000u)); //flags: EABI version 5
+   put_u16(&t_Buffer, ((t_Buffer.u8_Is64 != 0) ? 64 : 52));
+   put_u16(&t_Buffer, 0);
+   put_u16(&t_Buffer, 0);
+   put_u16(&t_Buffer, ((t_Buffer.u8_Is64 != 0) ? 64 : 40));
+   put_u16(&t_Buffer, OBJECT_NUM_OF_SECTIONS);
+   put_u16(&t_Buffer, OBJECT_SECTION_SHSTRTAB);
+
+   //------------------------------------------------------------//
+   // table section                                              //
+   //------------------------------------------------------------//
+   put_align(&t_Buffer, 4);
+   at_Section[OBJECT_SECTION_TABLE].u32_Type = 1;          //SHT_PROGBITS
+   at_Section[OBJECT_SECTION_TABLE].u32_Flags = 2;         //SHF_ALLOC
+   at_Section[OBJECT_SECTION_TABLE].u32_Offset = t_Buffer.u32_Size;
+   at_Section[OBJECT_SECTION_TABLE].u32_AddrAlign = 4;
+   put_bytes(&t_Buffer, opu8_Data, ou32_Size1By);
+   put_align(&t_Buffer, 4);
+   u32_SizeOffset = t_Buffer.u32_Size - at_Section[OBJECT_SECTION_TABLE].u32_Offset;
+   put_u32(&t_Buffer, ou32_Size1By);
+   at_Section[OBJECT_SECTION_TABLE].u32_Size = t_Buffer.u32_Size - at_Section[OBJECT_SECTION_TABLE].u32_Offset;
+   at_Section[2].u32_Type = 1;                              //no executable stack
+   at_Section[2].u32_Offset = t_Buffer.u32_Size;
+   at_Section[2].u32_AddrAlign = 1;
+
+   //------------------------------------------------------------//
+   // symbol table                                               //
+   //------------------------------------------------------------//
+   put_align(&t_Buffer, ((t_Buffer.u8_Is64 != 0) ? 8 : 4));
+   at_Section[OBJECT_SECTION_SYMTAB].u32_Type = 2;         //SHT_SYMTAB
+   at_Section[OBJECT_SECTION_SYMTAB].u32_Offset = t_Buffer.u32_Size;
+   at_Section[OBJECT_SECTION_SYMTAB].u32_Link = OBJECT_SECTION_STRTAB;
+   at_Section[OBJECT_SECTION_SYMTAB].u32_Info = 2;         //index of the first global symbol
+   at_Section[OBJECT_SECTION_SYMTAB].u32_AddrAlign = ((t_Buffer.u8_Is64 != 0) ? 8 : 4);
+   at_Section[OBJECT_SECTION_SYMTAB].u32_EntSize = ((t_Buffer.u8_Is64 != 0) ? 24 : 16);
+   put_symbol(&t_Buffer, 0, 0, 0, 0, 0);
+   put_symbol(&t_Buffer, 0, 0, 0, 0x03, OBJECT_SECTION_TABLE);                         //STB_LOCAL, STT_SECTION
+   put_symbol(&t_Buffer, u32_Symbol, 0, ou32_Size1By, 0x11, OBJECT_SECTION_TABLE);     //STB_GLOBAL, STT_OBJECT
+   put_symbol(&t_Buffer, u32_SymbolSize, u32_SizeOffset, 4, 0x11, OBJECT_SECTION_TABLE);
+   at_Section[OBJECT_SECTION_SYMTAB].u32_Size = OBJECT_NUM_OF_SYMBOLS * at_Section[OBJECT_SECTION_SYMTAB].u32_EntSize;
+
+   //------------------------------------------------------------//
+   // string tables                                              //
+   //------------------------------------------------------------//
+   at_Section[OBJECT_SECTION_STRTAB].u32_Type = 3;         //SHT_STRTAB
+   at_Section[OBJECT_SECTION_STRTAB].u32_Offset = t_Buffer.u32_Size;
+   at_Section[OBJECT_SECTION_STRTAB].u32_Size = t_StrTab.u32_Size;
+   at_Section[OBJECT_SECTION_STRTAB].u32_AddrAlign = 1;
+   put_bytes(&t_Buffer, t_StrTab.pu8_Data, t_StrTab.u32_Size);
+   at_Section[OBJECT_SECTION_SHSTRTAB].u32_Type = 3;
+   at_Section[OBJECT_SECTION_SHSTRTAB].u32_Offset = t_Buffer.u32_Size;
+   at_Section[OBJECT_SECTION_SHSTRTAB].u32_Size = t_ShStrTab.u32_Size;
+   at_Section[OBJECT_SECTION_SHSTRTAB].u32_AddrAlign = 1;
+   put_bytes(&t_Buffer, t_ShStrTab.pu8_Data, t_ShStrTab.u32_Size);
+
+   //------------------------------------------------------------//
+   // section headers                                            //
+   //------------------------------------------------------------//
+   put_align(&t_Buffer, ((t_Buffer.u8_Is64 != 0) ? 8 : 4));
+   t_Buffer.pu8_Data[u32_SectionHeaders] = (uint8_t)t_Buffer.u32_Size;
+   t_Buffer.pu8_Data[u32_SectionHeaders + 1] = (uint8_t)(t_Buffer.u32_Size >> 8);
+   t_Buffer.pu8_Data[u32_SectionHeaders + 2] = (uint8_t)(t_Buffer.u32_Size >> 16);
+   t_Buffer.pu8_Data[u32_SectionHeaders + 3] = (uint8_t)(t_Buffer.u32_Size >> 24);
+   for (u32_Section = 0; u32_Section < OBJECT_NUM_OF_SECTIONS; ++u32_Section)
+   {
+      const T_object_section * const pt_Section = &at_Section[u32_Section];
+
+      put_u32(&t_Buffer, pt_Section->u32_Name);
+      put_u32(&t_Buffer, pt_Section->u32_Type);
+      put_word(&t_Buffer, pt_Section->u32_Flags);
+      put_word(&t_Buffer, 0); //address
+      put_word(&t_Buffer, pt_Section->u32_Offset);
+      put_word(&t_Buffer, pt_Section->u32_Size);
+      put_u32(&t_Buffer, pt_Section->u32_Link);
+      put_u32(&t_Buffer, pt_Section->u32_Info);
+      put_word(&t_Buffer, pt_Section->u32_AddrAlign);
+      put_word(&t_Buffer, pt_Section->u32_EntSize);
+   }
+
+   //write to file
+   s32_Result = write_file(opc_File, t_Buffer.pu8_Data, t_Buffer.u32_Size);
+   free(t_Buffer.pu8_Data);
+   free(t_StrTab.pu8_Data);
+   free(t_ShStrTab.pu8_Data);
+   return s32_Result;
+}
+
+
+int32_t object_write_blob(const char * const opc_File, const uint8_t * const opu8_Data, const uint32_t ou32_Size1By)
+{
+   return write_file(opc_File, opu8_Data, ou32_Size1By);
+}
+
+
+
+
+
+
+
+
+
+static void put_bytes(T_object_buffer * const opt_Buffer, const void * const opv_Data, const uint32_t ou32_Size)
+{
+   //grow buffer
+   if ((opt_Buffer->u32_Size + ou32_Size) > opt_Buffer->u32_MaxSize)
+   {
+      opt_Buffer->u32_MaxSize = 2 * (opt_Buffer->u32_Size + ou32_Size) + 256;
+      opt_Buffer->pu8_Data = realloc(opt_Buffer->pu8_Data, opt_Buffer->u32_MaxSize);
+   }
+   memcpy(&opt_Buffer->pu8_Data[opt_Buffer->u32_Size], opv_Data, ou32_Size);
+   opt_Buffer->u32_Size += ou32_Size;
+}
+
+
+static void put_u8(T_object_buffer * const opt_Buffer, const uint8_t ou8_Value)
+{
+   put_bytes(opt_Buffer, &ou8_Value, 1);
+}
+
+
+static void put_u16(T_object_buffer * const opt_Buffer, const uint16_t ou16_Value)
+{
+   put_u8(opt_Buffer, (uint8_t)ou16_Value);
+   put_u8(opt_Buffer, (uint8_t)(ou16_Value >> 8));
+}
+
+
+static void put_u32(T_object_buffer * const opt_Buffer, const uint32_t ou32_Value)
+{
+   put_u16(opt_Buffer, (uint16_t)ou32_Value);
+   put_u16(opt_Buffer, (uint16_t)(ou32_Value >> 16));
+}
+
+
+//address, offset or size (4 or 8 bytes)
+static void put_word(T_object_buffer * const opt_Buffer, const uint32_t ou32_Value)
+{
+   put_u32(opt_Buffer, ou32_Value);
+   if (opt_Buffer->u8_Is64 != 0)
+   {
+      put_u32(opt_Buffer, 0);
+   }
+}
+
+
+static void put_align(T_object_buffer * const opt_Buffer, const uint32_t ou32_Align)
+{
+   while ((opt_Buffer->u32_Size % ou32_Align) != 0)
+   {
+      put_u8(opt_Buffer, 0);
+   }
+}
+
+
+//the order of the fields differs between ELF32 and ELF64
+static void put_symbol(T_object_buffer * const opt_Buffer, const uint32_t ou32_Name, const uint32_t ou32_Value, const uint32_t ou32_Size,
+                       const uint8_t ou8_Info, const uint16_t ou16_Section)
+{
+   put_u32(opt_Buffer, ou32_Name);
+   if (opt_Buffer->u8_Is64 == 0)
+   {
+      put_u32(opt_Buffer, ou32_Value);
+      put_u32(opt_Buffer, ou32_Size);
+   }
+   put_u8(opt_Buffer, ou8_Info);
+   put_u8(opt_Buffer, 0); //default visibility
+   put_u16(opt_Buffer, ou16_Section);
+   if (opt_Buffer->u8_Is64 != 0)
+   {
+      put_word(opt_Buffer, ou32_Value);
+      put_word(opt_Buffer, ou32_Size);
+   }
+}
+
+
+static int32_t write_file(const char * const opc_File, const uint8_t * const opu8_Data, const uint32_t ou32_Size1By)
+{
+   FILE * pv_File;
+   int32_t s32_Result;
+
+   pv_File = fopen(opc_File, "wb");
+   if (pv_File == NULL)
+   {
+      return -1;
+   }
+   s32_Result = ((fwrite(opu8_Data, 1, ou32_Size1By, pv_File) == ou32_Size1By) ? 0 : -1);
+   if (fclose(pv_File) != 0)
+   {
+      s32_Result = -1;
+   }
+   return s32_Result;
+}
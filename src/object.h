@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     object.h
+   \brief    Functions to write tables as linker-ready object files
+
+   A relocatable ELF object holds the table in a configurable section, a global
+   symbol for the table and a global symbol <symbol>_size (uint32_t, size of the
+   table in bytes). The blob is the plain table (e.g. for objcopy or .incbin).
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _OBJECT_H
+#define _OBJECT_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef enum
+{
+   OBJECT_MACHINE_ARM = 0,          //ELF32, little endian, EABI5
+   OBJECT_MACHINE_X86_64            //ELF64, little endian
+} T_object_machine;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//returns -1 if the file cannot be written
+extern int32_t object_write_elf(const char * const opc_File, const T_object_machine oe_Machine, const char * const opc_Section,
+                                const char * const opc_Symbol, const uint8_t * const opu8_Data, const uint32_t ou32_Size1By);
+extern int32_t object_write_blob(const char * const opc_File, const uint8_t * const opu8_Data, const uint32_t ou32_Size1By);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
@@ -0,0 +1,450 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     palette.c
+   \brief    Functions to encode signal sequences as indices into value palettes
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "palette.h"
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   char * pc_Name;
+   uint64_t u64_Order;
+   int32_t s32_Added;                     //position of adding (tie breaker of u64_Order)
+   T_sound_signal * pat_SignalSequence;   //duration in grid units
+   int32_t s32_Length;                    //including the terminating signal
+   uint32_t u32_Offset;                   //offset within encoded sequence [bytes] (result of palette_build)
+} T_palette_song;
+
+
+typedef struct
+{
+   uint16_t u16_GridNumerator;            //grid [ms] = numerator / denominator
+   uint16_t u16_GridDenominator;
+   T_palette_song * pat_Song;
+   int32_t s32_NumOfSongs;
+   int32_t s32_MaxSongs;
+   int32_t s32_NumOfInputSignals;
+   int32_t s32_NumOfSignals;
+   uint32_t u32_MaxError1us;              //max. difference of a song's total length due to quantization
+   uint16_t au16_Frequency[PALETTE_MAX_VALUES];
+   uint32_t u32_NumOfFrequencies;
+   uint16_t au16_Duration[PALETTE_MAX_VALUES];
+   uint32_t u32_NumOfDurations;
+   uint8_t u8_BytesPerSignal;
+   uint8_t * pu8_Sequence;
+   uint32_t u32_SequenceSize;
+} T_palette_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static int compare_song_order(const void * opv_A, const void * opv_B);
+static int compare_value(const void * opv_A, const void * opv_B);
+static uint32_t collect_values(uint16_t * const opau16_Values, const int32_t os32_Length);
+static uint8_t get_index(const uint16_t * const opau16_Values, const uint32_t ou32_NumOfValues, const uint16_t ou16_Value);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_PALETTE_HANDLE palette_open(const uint16_t ou16_GridNumerator, const uint16_t ou16_GridDenominator)
+{
+   T_palette_instance * pt_PaletteInstance;
+
+   //preconditional check
+   if ((ou16_GridNumerator == 0) || (ou16_GridDenominator == 0))
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // allocate palette instance                                  //
+   //------------------------------------------------------------//
+   pt_PaletteInstance = calloc(1, sizeof(T_palette_instance));
+   pt_PaletteInstance->u16_GridNumerator = ou16_GridNumerator;
+   pt_PaletteInstance->u16_GridDenominator = ou16_GridDenominator;
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return palette instance handle
+   return pt_PaletteInstance;
+}
+
+
+void palette_close(T_PALETTE_HANDLE opv_Handle)
+{
+   T_palette_instance * const pt_PaletteInstance = (T_palette_instance *)opv_Handle;
+   int32_t s32_Song;
+
+   //release songs, encoded sequence and instance itself
+   for (s32_Song = 0; s32_Song < pt_PaletteInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      free(pt_PaletteInstance->pat_Song[s32_Song].pc_Name);
+      free(pt_PaletteInstance->pat_Song[s32_Song].pat_SignalSequence);
+   }
+   free(pt_PaletteInstance->pat_Song);
+   free(pt_PaletteInstance->pu8_Sequence);
+   free(pt_PaletteInstance);
+}
+
+
+/*
+   The end of each signal (absolute time) is rounded to the grid, so the rounding errors
+   don't accumulate. Signals, that become zero, are dropped (the time is taken by their
+   neighbours); subsequent signals of the same frequency are combined.
+*/
+int32_t palette_add_signal_sequence(T_PALETTE_HANDLE opv_Handle, const char * const opc_Name, const uint64_t ou64_Order,
+                                    const int32_t os32_Length, const T_sound_signal * opt_SignalSequence)
+{
+   T_palette_instance * const pt_PaletteInstance = (T_palette_instance *)opv_Handle;
+   const uint64_t u64_Numerator = pt_PaletteInstance->u16_GridNumerator;
+   const uint64_t u64_Denominator = pt_PaletteInstance->u16_GridDenominator;
+   T_palette_song * pt_Song;
+   T_sound_signal * pt_Write;
+   uint64_t u64_Time1ms;
+   uint64_t u64_Grid;
+   int64_t s64_Error1us;
+   int32_t s32_Count;
+
+   //preconditional check
+   if (os32_Length <= 0)
+   {
+      return -1;
+   }
+
+   //grow song list
+   if (pt_PaletteInstance->s32_NumOfSongs >= pt_PaletteInstance->s32_MaxSongs)
+   {
+      pt_PaletteInstance->s32_MaxSongs = ((pt_PaletteInstance->s32_MaxSongs > 0) ? (2 * pt_PaletteInstance->s32_MaxSongs) : 16);
+      pt_PaletteInstance->pat_Song = realloc(pt_PaletteInstance->pat_Song, pt_PaletteInstance->s32_MaxSongs * sizeof(T_palette_song));
+   }
+   pt_Song = &pt_PaletteInstance->pat_Song[pt_PaletteInstance->s32_NumOfSongs];
+   pt_Song->pc_Name = strdup(opc_Name);
+   pt_Song->u64_Order = ou64_Order;
+   pt_Song->s32_Added = pt_PaletteInstance->s32_NumOfSongs;
+   pt_Song->u32_Offset = 0;
+   //a signal is split, if its duration exceeds 16 bit
+   pt_Song->pat_SignalSequence = malloc(((os32_Length * ((u64_Denominator / u64_Numerator) + 2)) + 1) * sizeof(T_sound_signal));
+
+   //------------------------------------------------------------//
+   // quantize (terminating signal is added separately)          //
+   //------------------------------------------------------------//
+   pt_Write = pt_Song->pat_SignalSequence;
+   u64_Time1ms = 0;
+   u64_Grid = 0;
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      const T_sound_signal * const pt_Signal = &opt_SignalSequence[s32_Count];
+      uint64_t u64_End;
+      uint64_t u64_Duration;
+
+      if (pt_Signal->u16_Duration1ms == 0)
+      {
+         continue;
+      }
+      u64_Time1ms += pt_Signal->u16_Duration1ms;
+      u64_End = ((u64_Time1ms * u64_Denominator) + (u64_Numerator / 2)) / u64_Numerator;
+      u64_Duration = u64_End - u64_Grid;
+      if (u64_Duration == 0)
+      {
+         continue;
+      }
+      u64_Grid = u64_End;
+
+      //same frequency -> extend previous signal
+      if ((pt_Write > pt_Song->pat_SignalSequence) && (pt_Write[-1].u16_Frequency1Hz == pt_Signal->u16_Frequency1Hz) &&
+          ((pt_Write[-1].u16_Duration1ms + u64_Duration) <= 0xFFFFu))
+      {
+         pt_Write[-1].u16_Duration1ms += (uint16_t)u64_Duration;
+         continue;
+      }
+      while (u64_Duration > 0)
+      {
+         pt_Write->u16_Frequency1Hz = pt_Signal->u16_Frequency1Hz;
+         pt_Write->u16_Duration1ms = (uint16_t)((u64_Duration > 0xFFFFu) ? 0xFFFFu : u64_Duration);
+         u64_Duration -= pt_Write->u16_Duration1ms;
+         ++pt_Write;
+      }
+   }
+   pt_Write->u16_Frequency1Hz = 0;
+   pt_Write->u16_Duration1ms = 0;
+   ++pt_Write;
+   pt_Song->s32_Length = (int32_t)(pt_Write - pt_Song->pat_SignalSequence);
+
+   //length error [us] (at most half a grid)
+   s64_Error1us = (int64_t)((u64_Grid * u64_Numerator * 1000u) / u64_Denominator) - (int64_t)(u64_Time1ms * 1000u);
+   s64_Error1us = ((s64_Error1us < 0) ? -s64_Error1us : s64_Error1us);
+   if ((uint64_t)s64_Error1us > pt_PaletteInstance->u32_MaxError1us)
+   {
+      pt_PaletteInstance->u32_MaxError1us = (uint32_t)s64_Error1us;
+   }
+   pt_PaletteInstance->s32_NumOfInputSignals += os32_Length;
+   pt_PaletteInstance->s32_NumOfSignals += pt_Song->s32_Length;
+
+   //return number of songs
+   return ++pt_PaletteInstance->s32_NumOfSongs;
+}
+
+
+int32_t palette_build(T_PALETTE_HANDLE opv_Handle)
+{
+   T_palette_instance * const pt_PaletteInstance = (T_palette_instance *)opv_Handle;
+   uint16_t * pu16_Values;
+   uint8_t * pu8_Write;
+   int32_t s32_Song;
+
+   //preconditional check
+   if (pt_PaletteInstance->s32_NumOfSongs <= 0)
+   {
+      return -1;
+   }
+
+   //------------------------------------------------------------//
+   // assign song IDs                                            //
+   //------------------------------------------------------------//
+   qsort(pt_PaletteInstance->pat_Song, pt_PaletteInstance->s32_NumOfSongs, sizeof(T_palette_song), compare_song_order);
+
+   //------------------------------------------------------------//
+   // collect distinct frequencies and durations                 //
+   //------------------------------------------------------------//
+   pu16_Values = malloc(pt_PaletteInstance->s32_NumOfSignals * sizeof(uint16_t));
+   for (uint32_t u32_Field = 0; u32_Field < 2; ++u32_Field)
+   {
+      uint16_t * const pau16_Palette = ((u32_Field == 0) ? pt_PaletteInstance->au16_Frequency : pt_PaletteInstance->au16_Duration);
+      uint32_t u32_NumOfValues;
+      int32_t s32_Value;
+
+      s32_Value = 0;
+      for (s32_Song = 0; s32_Song < pt_PaletteInstance->s32_NumOfSongs; ++s32_Song)
+      {
+         const T_palette_song * const pt_Song = &pt_PaletteInstance->pat_Song[s32_Song];
+
+         for (int32_t s32_Count = 0; s32_Count < pt_Song->s32_Length; ++s32_Count)
+         {
+            pu16_Values[s32_Value++] = ((u32_Field == 0) ? pt_Song->pat_SignalSequence[s32_Count].u16_Frequency1Hz :
+                                                           pt_Song->pat_SignalSequence[s32_Count].u16_Duration1ms);
+         }
+      }
+      u32_NumOfValues = collect_values(pu16_Values, s32_Value);
+      if (u32_NumOfValues > PALETTE_MAX_VALUES)
+      {
+         printf("[E] Too many distinct %s (%d), use a coarser grid!\n", ((u32_Field == 0) ? "frequencies" : "durations"), u32_NumOfValues);
+         free(pu16_Values);
+         return -1;
+      }
+      memcpy(pau16_Palette, pu16_Values, u32_NumOfValues * sizeof(uint16_t));
+      if (u32_Field == 0)
+      {
+         pt_PaletteInstance->u32_NumOfFrequencies = u32_NumOfValues;
+      }
+      else
+      {
+         pt_PaletteInstance->u32_NumOfDurations = u32_NumOfValues;
+      }
+   }
+   free(pu16_Values);
+
+   //------------------------------------------------------------//
+   // encode                                                     //
+   //------------------------------------------------------------//
+   pt_PaletteInstance->u8_BytesPerSignal = (((pt_PaletteInstance->u32_NumOfFrequencies <= 16) && (pt_PaletteInstance->u32_NumOfDurations <= 16)) ? 1 : 2);
+   free(pt_PaletteInstance->pu8_Sequence);
+   pt_PaletteInstance->u32_SequenceSize = (uint32_t)pt_PaletteInstance->s32_NumOfSignals * pt_PaletteInstance->u8_BytesPerSignal;
+   pt_PaletteInstance->pu8_Sequence = malloc(pt_PaletteInstance->u32_SequenceSize);
+   pu8_Write = pt_PaletteInstance->pu8_Sequence;
+   for (s32_Song = 0; s32_Song < pt_PaletteInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      T_palette_song * const pt_Song = &pt_PaletteInstance->pat_Song[s32_Song];
+
+      pt_Song->u32_Offset = (uint32_t)(pu8_Write - pt_PaletteInstance->pu8_Sequence);
+      for (int32_t s32_Count = 0; s32_Count < pt_Song->s32_Length; ++s32_Count)
+      {
+         const uint8_t u8_Frequency = get_index(pt_PaletteInstance->au16_Frequency, pt_PaletteInstance->u32_NumOfFrequencies,
+                                                pt_Song->pat_SignalSequence[s32_Count].u16_Frequency1Hz);
+         const uint8_t u8_Duration = get_index(pt_PaletteInstance->au16_Duration, pt_PaletteInstance->u32_NumOfDurations,
+                                               pt_Song->pat_SignalSequence[s32_Count].u16_Duration1ms);
+
+         if (pt_PaletteInstance->u8_BytesPerSignal == 1)
+         {
+            *pu8_Write++ = (uint8_t)((u8_Frequency << 4) | u8_Duration);
+         }
+         else
+         {
+            *pu8_Write++ = u8_Frequency;
+            *pu8_Write++ = u8_Duration;
+         }
+      }
+   }
+
+   //return size of encoded sequences
+   return (int32_t)pt_PaletteInstance->u32_SequenceSize;
+}
+
+
+/*
+   Size of all arrays written by palette_write [bytes]: grid, palettes, bytes per signal, sequences and index.
+*/
+int32_t palette_get_size(T_PALETTE_HANDLE opv_Handle, uint8_t * const opu8_BytesPerSignal)
+{
+   T_palette_instance * const pt_PaletteInstance = (T_palette_instance *)opv_Handle;
+
+   *opu8_BytesPerSignal = pt_PaletteInstance->u8_BytesPerSignal;
+   return (int32_t)((2 * 2) + (2 * (pt_PaletteInstance->u32_NumOfFrequencies + pt_PaletteInstance->u32_NumOfDurations)) + 1 +
+                    pt_PaletteInstance->u32_SequenceSize + (4 * (uint32_t)pt_PaletteInstance->s32_NumOfSongs));
+}
+
+
+void palette_print_statistic(T_PALETTE_HANDLE opv_Handle)
+{
+   T_palette_instance * const pt_PaletteInstance = (T_palette_instance *)opv_Handle;
+   const uint32_t u32_TableSize1By = (uint32_t)pt_PaletteInstance->s32_NumOfInputSignals * 4;
+   const uint32_t u32_Size1By = pt_PaletteInstance->u32_SequenceSize +
+                                (2 * (pt_PaletteInstance->u32_NumOfFrequencies + pt_PaletteInstance->u32_NumOfDurations));
+
+   printf("Palette: %d songs, grid %d/%d ms\n", pt_PaletteInstance->s32_NumOfSongs, pt_PaletteInstance->u16_GridNumerator, pt_PaletteInstance->u16_GridDenominator);
+   printf("\tFrequencies: %d\n", pt_PaletteInstance->u32_NumOfFrequencies);
+   printf("\tDurations: %d\n", pt_PaletteInstance->u32_NumOfDurations);
+   printf("\tSignals: %d of %d, %d byte(s) each\n", pt_PaletteInstance->s32_NumOfSignals, pt_PaletteInstance->s32_NumOfInputSignals,
+          pt_PaletteInstance->u8_BytesPerSignal);
+   printf("\tSize: %d bytes (palettes included), table: %d bytes (%d%%)\n", u32_Size1By, u32_TableSize1By,
+          ((u32_TableSize1By > 0) ? ((100 * u32_Size1By) / u32_TableSize1By) : 0));
+   printf("\tMax. length error: %d us\n", pt_PaletteInstance->u32_MaxError1us);
+}
+
+
+void palette_write(const char * const opc_File, T_PALETTE_HANDLE opv_Handle)
+{
+   T_palette_instance * const pt_PaletteInstance = (T_palette_instance *)opv_Handle;
+   FILE * pv_File;
+   uint32_t u32_Count;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = fopen(opc_File, "w");
+
+   //------------------------------------------------------------//
+   // write palettes to file                                     //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint16_t gau16_SoundPaletteGrid[] = { %d, %d }; //duration unit [1ms] = numerator / denominator\n\n",
+           pt_PaletteInstance->u16_GridNumerator, pt_PaletteInstance->u16_GridDenominator);
+   fprintf(pv_File, "const uint16_t gau16_SoundPaletteFrequency[] = { //Frequency [1Hz]\n");
+   for (u32_Count = 0; u32_Count < pt_PaletteInstance->u32_NumOfFrequencies; ++u32_Count)
+   {
+      fprintf(pv_File, "  %d,%s", pt_PaletteInstance->au16_Frequency[u32_Count], (((u32_Count % 16) == 15) ? "\n" : ""));
+   }
+   fprintf(pv_File, "\n};\n\n");
+   fprintf(pv_File, "const uint16_t gau16_SoundPaletteDuration[] = { //Duration [grid]\n");
+   for (u32_Count = 0; u32_Count < pt_PaletteInstance->u32_NumOfDurations; ++u32_Count)
+   {
+      fprintf(pv_File, "  %d,%s", pt_PaletteInstance->au16_Duration[u32_Count], (((u32_Count % 16) == 15) ? "\n" : ""));
+   }
+   fprintf(pv_File, "\n};\n\n");
+
+   //------------------------------------------------------------//
+   // write encoded sequences to file                            //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint8_t gu8_SoundPaletteBytesPerSignal = %d;\n\n", pt_PaletteInstance->u8_BytesPerSignal);
+   if (pt_PaletteInstance->u8_BytesPerSignal == 1)
+   {
+      fprintf(pv_File, "const uint8_t gau8_SoundPaletteSequence[] = { //8-bit : Frequency index (high nibble), Duration index (low nibble); ");
+   }
+   else
+   {
+      fprintf(pv_File, "const uint8_t gau8_SoundPaletteSequence[] = { //2x8-bit value pair : Frequency index, Duration index; ");
+   }
+   fprintf(pv_File, "each song terminated by 0 Hz, 0 grid\n");
+   for (u32_Count = 0; u32_Count < pt_PaletteInstance->u32_SequenceSize; ++u32_Count)
+   {
+      fprintf(pv_File, "  %d,%s", pt_PaletteInstance->pu8_Sequence[u32_Count], (((u32_Count % 16) == 15) ? "\n" : ""));
+   }
+   fprintf(pv_File, "\n};\n\n");
+
+   //------------------------------------------------------------//
+   // write index to file                                        //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint32_t gau32_SoundPaletteIndex[] = { //song ID -> offset of first signal in gau8_SoundPaletteSequence [bytes]\n");
+   for (int32_t s32_Song = 0; s32_Song < pt_PaletteInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      const T_palette_song * const pt_Song = &pt_PaletteInstance->pat_Song[s32_Song];
+
+      fprintf(pv_File, "  %d, // %d: %s\n", pt_Song->u32_Offset, s32_Song, pt_Song->pc_Name);
+   }
+   fprintf(pv_File, "};\n\n");
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   fclose(pv_File);
+}
+
+
+
+
+
+
+
+
+
+static int compare_song_order(const void * opv_A, const void * opv_B)
+{
+   const T_palette_song * const pt_A = (const T_palette_song *)opv_A;
+   const T_palette_song * const pt_B = (const T_palette_song *)opv_B;
+
+   if (pt_A->u64_Order != pt_B->u64_Order)
+   {
+      return ((pt_A->u64_Order < pt_B->u64_Order) ? -1 : 1);
+   }
+   return ((pt_A->s32_Added < pt_B->s32_Added) ? -1 : ((pt_A->s32_Added > pt_B->s32_Added) ? 1 : 0));
+}
+
+
+static int compare_value(const void * opv_A, const void * opv_B)
+{
+   const uint16_t u16_A = *(const uint16_t *)opv_A;
+   const uint16_t u16_B = *(const uint16_t *)opv_B;
+
+   return ((u16_A < u16_B) ? -1 : ((u16_A > u16_B) ? 1 : 0));
+}
+
+
+//sort ascending and remove duplicates; returns the number of distinct values
+static uint32_t collect_values(uint16_t * const opau16_Values, const int32_t os32_Length)
+{
+   uint32_t u32_NumOfValues;
+   int32_t s32_Count;
+
+   qsort(opau16_Values, os32_Length, sizeof(uint16_t), compare_value);
+   u32_NumOfValues = 0;
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      if ((u32_NumOfValues == 0) || (opau16_Values[u32_NumOfValues - 1] != opau16_Values[s32_Count]))
+      {
+         opau16_Values[u32_NumOfValues++] = opau16_Values[s32_Count];
+      }
+   }
+   return u32_NumOfValues;
+}
+
+
+static uint8_t get_index(const uint16_t * const opau16_Values, const uint32_t ou32_NumOfValues, const uint16_t ou16_Value)
+{
+   const uint16_t * const pu16_Value = bsearch(&ou16_Value, opau16_Values, ou32_NumOfValues, sizeof(uint16_t), compare_value);
+
+   return (uint8_t)(pu16_Value - opau16_Values);
+}
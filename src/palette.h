@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     palette.h
+   \brief    Functions to encode signal sequences as indices into value palettes
+
+   Durations are quantized to a grid (numerator / denominator milliseconds, e.g.
+   500 / 64 for 1/64 beat). The distinct frequencies and durations of all songs
+   are collected into two palettes; each signal is stored as frequency and
+   duration index: one byte (two nibbles), if both palettes hold at most 16
+   values, otherwise two bytes.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _PALETTE_H
+#define _PALETTE_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "sound.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define PALETTE_MAX_VALUES    (256)    //max. number of distinct frequencies respectively durations
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_PALETTE_HANDLE;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+extern T_PALETTE_HANDLE palette_open(const uint16_t ou16_GridNumerator, const uint16_t ou16_GridDenominator);
+extern void palette_close(T_PALETTE_HANDLE opv_Handle);
+
+//add song (quantized copy); songs are ordered by ascending ou64_Order in palette_build
+extern int32_t palette_add_signal_sequence(T_PALETTE_HANDLE opv_Handle, const char * const opc_Name, const uint64_t ou64_Order,
+                                           const int32_t os32_Length, const T_sound_signal * opt_SignalSequence);
+//returns the size of the encoded sequences [bytes], -1 if there are too many distinct values
+extern int32_t palette_build(T_PALETTE_HANDLE opv_Handle);
+//size of the written arrays [bytes] (after palette_build)
+extern int32_t palette_get_size(T_PALETTE_HANDLE opv_Handle, uint8_t * const opu8_BytesPerSignal);
+extern void palette_print_statistic(T_PALETTE_HANDLE opv_Handle);
+extern void palette_write(const char * const opc_File, T_PALETTE_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
@@ -0,0 +1,288 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     pipeline.c
+   \brief    Functions to convert a track in pipelined stages (decode, convert, write)
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "midi_event.h"
+#include "sound.h"
+#include "ring.h"
+#include "pipeline.h"
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   int32_t s32_Count;                  //number of note events, -1: invalid data
+   uint8_t u8_Last;
+   T_midi_event_note at_NoteEvents[];
+} T_pipeline_event_block;
+
+
+typedef struct
+{
+   int32_t s32_Count;                  //number of signals, -1: invalid data
+   uint8_t u8_Last;
+   T_sound_signal at_Signals[];
+} T_pipeline_signal_block;
+
+
+typedef struct
+{
+   T_MIDI_EVENT_HANDLE pv_MidiEvent;
+   T_RING_HANDLE pv_EventRing;         //decode -> convert
+   T_RING_HANDLE pv_SignalRing;        //convert -> write
+   uint32_t u32_BlockSize;
+   uint16_t u16_TimeDivision;
+   uint32_t u32_MaxGapTicks;
+} T_pipeline_instance;
+
+
+//state of the convert stage (sink of the stream conversion)
+typedef struct
+{
+   T_pipeline_instance * pt_PipelineInstance;
+   T_pipeline_signal_block * pt_Block; //block being filled, NULL if none
+} T_pipeline_converter;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void * decode_stage(void * opv_PipelineInstance);
+static void * convert_stage(void * opv_PipelineInstance);
+static void push_signal(const T_sound_signal * const opt_Signal, void * const opv_Converter);
+static T_pipeline_signal_block * get_signal_block(T_pipeline_converter * const opt_Converter);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+int32_t pipeline_convert_track(T_MIDI_EVENT_HANDLE opv_MidiEvent, const uint16_t ou16_TimeDivision, const uint32_t ou32_MaxGapTicks,
+                               const uint32_t ou32_BlockSize, const char * const opc_File)
+{
+   T_pipeline_instance t_PipelineInstance;
+   pthread_t t_DecodeThread;
+   pthread_t t_ConvertThread;
+   FILE * pv_File;
+   int32_t s32_Signal;
+   int32_t s32_Error;                  //0, -1: invalid data, -2: file cannot be opened
+   uint8_t u8_Last;
+
+   //preconditional check
+   if (ou32_BlockSize == 0)
+   {
+      return -1;
+   }
+
+   //------------------------------------------------------------//
+   // start decode and convert stage                             //
+   //------------------------------------------------------------//
+   t_PipelineInstance.pv_MidiEvent = opv_MidiEvent;
+   t_PipelineInstance.u32_BlockSize = ou32_BlockSize;
+   t_PipelineInstance.u16_TimeDivision = ou16_TimeDivision;
+   t_PipelineInstance.u32_MaxGapTicks = ou32_MaxGapTicks;
+   t_PipelineInstance.pv_EventRing = ring_open(sizeof(T_pipeline_event_block) + (ou32_BlockSize * sizeof(T_midi_event_note)), PIPELINE_NUM_OF_BLOCKS);
+   t_PipelineInstance.pv_SignalRing = ring_open(sizeof(T_pipeline_signal_block) + (ou32_BlockSize * sizeof(T_sound_signal)), PIPELINE_NUM_OF_BLOCKS);
+   if (pthread_create(&t_DecodeThread, NULL, decode_stage, &t_PipelineInstance) != 0)
+   {
+      printf("[E] Cannot start decode stage!\n");
+      ring_close(t_PipelineInstance.pv_EventRing);
+      ring_close(t_PipelineInstance.pv_SignalRing);
+      return -2;
+   }
+   if (pthread_create(&t_ConvertThread, NULL, convert_stage, &t_PipelineInstance) != 0)
+   {
+      printf("[E] Cannot start convert stage!\n");
+      //consume the decoded blocks, so the decode stage runs to its end and can be joined
+      do
+      {
+         u8_Last = ((const T_pipeline_event_block *)ring_get_read_slot(t_PipelineInstance.pv_EventRing))->u8_Last;
+         ring_release_read_slot(t_PipelineInstance.pv_EventRing);
+      } while (u8_Last == 0);
+      pthread_join(t_DecodeThread, NULL);
+      ring_close(t_PipelineInstance.pv_EventRing);
+      ring_close(t_PipelineInstance.pv_SignalRing);
+      return -2;
+   }
+
+   //------------------------------------------------------------//
+   // write stage (this thread)                                  //
+   //------------------------------------------------------------//
+   //the file is created with the first signal (a track without notes does not produce an output)
+   pv_File = NULL;
+   s32_Signal = 0;
+   s32_Error = 0;
+   do
+   {
+      const T_pipeline_signal_block * const pt_Block = ring_get_read_slot(t_PipelineInstance.pv_SignalRing);
+      int32_t s32_Count;
+
+      u8_Last = pt_Block->u8_Last;
+      if ((pt_Block->s32_Count < 0) && (s32_Error == 0))
+      {
+         s32_Error = -1;
+      }
+      if ((s32_Error == 0) && (pt_Block->s32_Count > 0) && (pv_File == NULL))
+      {
+         pv_File = fopen(opc_File, "w");
+         if (pv_File == NULL)
+         {
+            //the remaining blocks are consumed anyway, so both stages run to their end
+            printf("[E] Cannot open file %s!\n", opc_File);
+            s32_Error = -2;
+         }
+         else
+         {
+            fprintf(pv_File, "const uint16_t gau16_SoundSequence[] = { //2x16-bit value pair : Duration [1ms], Frequeny [1Hz]\n");
+         }
+      }
+      for (s32_Count = 0; (s32_Error == 0) && (s32_Count < pt_Block->s32_Count); ++s32_Count)
+      {
+         fprintf(pv_File, "  %d, %d, ", pt_Block->at_Signals[s32_Count].u16_Duration1ms, pt_Block->at_Signals[s32_Count].u16_Frequency1Hz);
+         if ((s32_Signal % 8) == 7)
+         {
+            fprintf(pv_File, "\n");
+         }
+         ++s32_Signal;
+      }
+      ring_release_read_slot(t_PipelineInstance.pv_SignalRing);
+   } while (u8_Last == 0);
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   pthread_join(t_DecodeThread, NULL);
+   pthread_join(t_ConvertThread, NULL);
+   ring_close(t_PipelineInstance.pv_EventRing);
+   ring_close(t_PipelineInstance.pv_SignalRing);
+   if (pv_File != NULL)
+   {
+      if (s32_Error == 0)
+      {
+         fprintf(pv_File, " 0, 0\n};\n\n");
+         fclose(pv_File);
+      }
+      else
+      {
+         //don't leave an incomplete table
+         fclose(pv_File);
+         remove(opc_File);
+      }
+   }
+   return ((s32_Error == 0) ? s32_Signal : s32_Error);
+}
+
+
+
+
+
+
+
+
+
+static void * decode_stage(void * opv_PipelineInstance)
+{
+   T_pipeline_instance * const pt_PipelineInstance = (T_pipeline_instance *)opv_PipelineInstance;
+   uint8_t u8_Last;
+
+   do
+   {
+      T_pipeline_event_block * const pt_Block = ring_get_write_slot(pt_PipelineInstance->pv_EventRing);
+
+      pt_Block->s32_Count = midi_event_get_next_note_events(pt_PipelineInstance->pv_MidiEvent, pt_Block->at_NoteEvents,
+                                                            (int32_t)pt_PipelineInstance->u32_BlockSize);
+      //end of track (or invalid data)
+      u8_Last = ((pt_Block->s32_Count <= 0) ? 1 : 0);
+      pt_Block->u8_Last = u8_Last;
+      ring_commit_write_slot(pt_PipelineInstance->pv_EventRing);
+   } while (u8_Last == 0);
+   return NULL;
+}
+
+
+static void * convert_stage(void * opv_PipelineInstance)
+{
+   T_pipeline_converter t_Converter;
+   T_pipeline_signal_block * pt_Block;
+   T_SOUND_STREAM_HANDLE pv_Stream;
+   int32_t s32_Error;
+   uint8_t u8_Last;
+
+   t_Converter.pt_PipelineInstance = (T_pipeline_instance *)opv_PipelineInstance;
+   t_Converter.pt_Block = NULL;
+   pv_Stream = sound_stream_open(t_Converter.pt_PipelineInstance->u16_TimeDivision, t_Converter.pt_PipelineInstance->u32_MaxGapTicks,
+                                 push_signal, &t_Converter);
+
+   //for each block of note events
+   s32_Error = 0;
+   do
+   {
+      const T_pipeline_event_block * const pt_EventBlock = ring_get_read_slot(t_Converter.pt_PipelineInstance->pv_EventRing);
+
+      u8_Last = pt_EventBlock->u8_Last;
+      if (pt_EventBlock->s32_Count < 0)
+      {
+         s32_Error = -1;
+      }
+      if (pt_EventBlock->s32_Count > 0)
+      {
+         sound_stream_add_note_events(pv_Stream, pt_EventBlock->s32_Count, pt_EventBlock->at_NoteEvents);
+      }
+      ring_release_read_slot(t_Converter.pt_PipelineInstance->pv_EventRing);
+   } while (u8_Last == 0);
+
+   //the last event is kept in each case; the last signal switches off
+   if (s32_Error == 0)
+   {
+      sound_stream_flush(pv_Stream);
+   }
+   sound_stream_close(pv_Stream);
+
+   //last block
+   pt_Block = get_signal_block(&t_Converter);
+   if (s32_Error != 0)
+   {
+      pt_Block->s32_Count = -1;
+   }
+   pt_Block->u8_Last = 1;
+   ring_commit_write_slot(t_Converter.pt_PipelineInstance->pv_SignalRing);
+   return NULL;
+}
+
+
+static void push_signal(const T_sound_signal * const opt_Signal, void * const opv_Converter)
+{
+   T_pipeline_converter * const pt_Converter = (T_pipeline_converter *)opv_Converter;
+   T_pipeline_signal_block * const pt_Block = get_signal_block(pt_Converter);
+
+   pt_Block->at_Signals[pt_Block->s32_Count++] = *opt_Signal;
+   //pass full block to the write stage
+   if ((uint32_t)pt_Block->s32_Count >= pt_Converter->pt_PipelineInstance->u32_BlockSize)
+   {
+      ring_commit_write_slot(pt_Converter->pt_PipelineInstance->pv_SignalRing);
+      pt_Converter->pt_Block = NULL;
+   }
+}
+
+
+static T_pipeline_signal_block * get_signal_block(T_pipeline_converter * const opt_Converter)
+{
+   if (opt_Converter->pt_Block == NULL)
+   {
+      opt_Converter->pt_Block = ring_get_write_slot(opt_Converter->pt_PipelineInstance->pv_SignalRing);
+      opt_Converter->pt_Block->s32_Count = 0;
+      opt_Converter->pt_Block->u8_Last = 0;
+   }
+   return opt_Converter->pt_Block;
+}
@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     pipeline.h
+   \brief    Functions to convert a track in pipelined stages (decode, convert, write)
+
+   Each stage runs on a thread of its own. The stages pass blocks of note events
+   respectively signals through bounded ring buffers, so decoding of the next block
+   overlaps with conversion and formatting of the current one.
+   The result equals the table output of sound_write_signal_sequence, except the
+   last note event: as it has no subsequent event, it does not define a signal.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _PIPELINE_H
+#define _PIPELINE_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "midi_event.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define PIPELINE_NUM_OF_BLOCKS   (4)   //blocks in flight between two stages
+
+/* -- Types --------------------------------------------------------------- */
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//returns number of written signals (including the terminating one), 0 if there are no note events, -1 on invalid data,
+//-2 if a stage cannot be started or the file cannot be opened
+extern int32_t pipeline_convert_track(T_MIDI_EVENT_HANDLE opv_MidiEvent, const uint16_t ou16_TimeDivision, const uint32_t ou32_MaxGapTicks,
+                                      const uint32_t ou32_BlockSize, const char * const opc_File);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
@@ -0,0 +1,549 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     play.c
+   \brief    Functions to play a signal sequence in real time (timing validation on Linux)
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include "ring.h"
+#include "play.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define PLAY_PCM_AMPLITUDE       (8192)
+#define PLAY_PCM_BLOCK           (256)    //samples per write
+#define PLAY_PCM_CHANGES         (4096)   //frequency changes queued for the pcm writer thread
+#define PLAY_PCM_POLL_1NS        (2000000u) //sleep of the pcm writer thread while the queue is empty
+
+/* -- Types --------------------------------------------------------------- */
+//frequency change passed from the scheduler thread to the pcm writer thread
+typedef struct
+{
+   uint64_t u64_Time1ns;
+   uint16_t u16_Frequency1Hz;
+   uint8_t u8_Stop;                       //1: writer thread terminates
+} T_play_change;
+
+
+typedef struct
+{
+   T_play_sink pf_Sink;
+   void * pv_Context;
+   T_play_clock e_Clock;
+   uint32_t u32_Priority;
+   uint8_t u8_Realtime;                   //1: SCHED_FIFO granted
+   //built in sinks
+   int s32_Fifo;                          //-1: not opened
+   FILE * pv_Pcm;
+   T_RING_HANDLE pv_PcmRing;              //frequency changes (scheduler thread -> writer thread)
+   pthread_t t_PcmWriter;
+   uint64_t u64_PcmSamples;               //samples written
+   uint16_t u16_PcmFrequency1Hz;          //frequency of the current signal
+   uint32_t u32_PcmPhase;
+   //sequence to play (scheduler thread)
+   int32_t s32_Length;
+   const T_sound_signal * pt_SignalSequence;
+   int32_t s32_Missed;
+   //statistic of all sequences
+   uint64_t u64_NumOfSignals;
+   uint64_t u64_NumOfMissed;              //woken up after the end of the signal
+   uint64_t u64_Duration1ns;
+   uint64_t u64_MinLatency1ns;
+   uint64_t u64_MaxLatency1ns;
+   uint64_t u64_SumLatency1ns;
+   uint64_t u64_MaxJitter1ns;
+   uint64_t au64_Latency[PLAY_HISTOGRAM_BUCKETS];
+   uint64_t au64_Jitter[PLAY_HISTOGRAM_BUCKETS];
+} T_play_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static uint64_t get_time_1ns(void);
+static void wait_until(const int os32_Timer, const uint64_t ou64_Deadline1ns);
+static uint32_t get_bucket(const uint64_t ou64_Time1ns);
+static void record(T_play_instance * const opt_PlayInstance, const uint64_t ou64_Latency1ns, const uint64_t ou64_PreviousLatency1ns,
+                   const uint8_t ou8_First);
+static void * scheduler(void * opv_Instance);
+static void sink_null(const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz, void * const opv_Context);
+static void sink_fifo(const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz, void * const opv_Context);
+static void sink_pcm(const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz, void * const opv_Context);
+static void * pcm_writer(void * opv_Instance);
+static void write_pcm(T_play_instance * const opt_PlayInstance, const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_PLAY_HANDLE play_open(T_play_sink opf_Sink, void * const opv_Context, const T_play_clock oe_Clock, const uint32_t ou32_Priority)
+{
+   T_play_instance * pt_PlayInstance;
+
+   //preconditional check
+   if (opf_Sink == NULL)
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // allocate play instance                                     //
+   //------------------------------------------------------------//
+   pt_PlayInstance = calloc(1, sizeof(T_play_instance));
+   pt_PlayInstance->pf_Sink = opf_Sink;
+   pt_PlayInstance->pv_Context = opv_Context;
+   pt_PlayInstance->e_Clock = oe_Clock;
+   pt_PlayInstance->u32_Priority = ou32_Priority;
+   pt_PlayInstance->s32_Fifo = -1;
+   pt_PlayInstance->u64_MinLatency1ns = UINT64_MAX;
+
+   //keep all pages resident (no page faults while playing)
+   if ((ou32_Priority > 0) && (mlockall(MCL_CURRENT | MCL_FUTURE) != 0))
+   {
+      printf("[W] Cannot lock memory!\n");
+   }
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return play instance handle
+   return pt_PlayInstance;
+}
+
+
+T_PLAY_HANDLE play_open_sink(const char * const opc_Sink, const T_play_clock oe_Clock, const uint32_t ou32_Priority)
+{
+   T_play_instance * pt_PlayInstance;
+
+   if (strcmp(opc_Sink, "null") == 0)
+   {
+      return play_open(sink_null, NULL, oe_Clock, ou32_Priority);
+   }
+   if (strncmp(opc_Sink, "fifo:", 5) == 0)
+   {
+      //created if missing, open blocks until a reader is connected
+      if ((mkfifo(&opc_Sink[5], 0644) != 0) && (errno != EEXIST))
+      {
+         printf("[E] Cannot create fifo %s!\n", &opc_Sink[5]);
+         return 0;
+      }
+      signal(SIGPIPE, SIG_IGN);
+      pt_PlayInstance = play_open(sink_fifo, NULL, oe_Clock, ou32_Priority);
+      pt_PlayInstance->pv_Context = pt_PlayInstance;
+      pt_PlayInstance->s32_Fifo = open(&opc_Sink[5], O_WRONLY);
+      if (pt_PlayInstance->s32_Fifo < 0)
+      {
+         printf("[E] Cannot open fifo %s!\n", &opc_Sink[5]);
+         play_close(pt_PlayInstance);
+         return 0;
+      }
+      return pt_PlayInstance;
+   }
+   if (strncmp(opc_Sink, "pcm:", 4) == 0)
+   {
+      pt_PlayInstance = play_open(sink_pcm, NULL, oe_Clock, ou32_Priority);
+      pt_PlayInstance->pv_Context = pt_PlayInstance;
+      pt_PlayInstance->pv_Pcm = fopen(&opc_Sink[4], "wb");
+      if (pt_PlayInstance->pv_Pcm == NULL)
+      {
+         printf("[E] Cannot open pcm file %s!\n", &opc_Sink[4]);
+         play_close(pt_PlayInstance);
+         return 0;
+      }
+      //the file is written by a thread of its own, so the scheduler thread never blocks on the file
+      pt_PlayInstance->pv_PcmRing = ring_open(sizeof(T_play_change), PLAY_PCM_CHANGES);
+      if (pthread_create(&pt_PlayInstance->t_PcmWriter, NULL, pcm_writer, pt_PlayInstance) != 0)
+      {
+         printf("[E] Cannot start pcm writer thread!\n");
+         ring_close(pt_PlayInstance->pv_PcmRing);
+         pt_PlayInstance->pv_PcmRing = NULL;
+         play_close(pt_PlayInstance);
+         return 0;
+      }
+      return pt_PlayInstance;
+   }
+   printf("[E] Invalid sink %s!\n", opc_Sink);
+   return 0;
+}
+
+
+void play_close(T_PLAY_HANDLE opv_Handle)
+{
+   T_play_instance * const pt_PlayInstance = (T_play_instance *)opv_Handle;
+
+   //release sinks and instance itself
+   if (pt_PlayInstance->s32_Fifo >= 0)
+   {
+      close(pt_PlayInstance->s32_Fifo);
+   }
+   if (pt_PlayInstance->pv_PcmRing != NULL)
+   {
+      T_play_change * const pt_Change = ring_get_write_slot(pt_PlayInstance->pv_PcmRing);
+
+      //the writer thread drains the queue before it terminates
+      pt_Change->u8_Stop = 1;
+      ring_commit_write_slot(pt_PlayInstance->pv_PcmRing);
+      pthread_join(pt_PlayInstance->t_PcmWriter, NULL);
+      ring_close(pt_PlayInstance->pv_PcmRing);
+   }
+   if (pt_PlayInstance->pv_Pcm != NULL)
+   {
+      fclose(pt_PlayInstance->pv_Pcm);
+   }
+   free(pt_PlayInstance);
+}
+
+
+int32_t play_signal_sequence(T_PLAY_HANDLE opv_Handle, const int32_t os32_Length, const T_sound_signal * const opt_SignalSequence)
+{
+   T_play_instance * const pt_PlayInstance = (T_play_instance *)opv_Handle;
+   pthread_t t_Thread;
+   pthread_attr_t t_Attributes;
+   struct sched_param t_Parameter;
+   int s32_Error;
+
+   //preconditional check
+   if (os32_Length <= 0)
+   {
+      return -1;
+   }
+   pt_PlayInstance->s32_Length = os32_Length;
+   pt_PlayInstance->pt_SignalSequence = opt_SignalSequence;
+   pt_PlayInstance->s32_Missed = 0;
+
+   //------------------------------------------------------------//
+   // start scheduler thread (SCHED_FIFO, if permitted)          //
+   //------------------------------------------------------------//
+   s32_Error = EPERM;
+   if (pt_PlayInstance->u32_Priority > 0)
+   {
+      pthread_attr_init(&t_Attributes);
+      pthread_attr_setinheritsched(&t_Attributes, PTHREAD_EXPLICIT_SCHED);
+      pthread_attr_setschedpolicy(&t_Attributes, SCHED_FIFO);
+      t_Parameter.sched_priority = (int)pt_PlayInstance->u32_Priority;
+      pthread_attr_setschedparam(&t_Attributes, &t_Parameter);
+      s32_Error = pthread_create(&t_Thread, &t_Attributes, scheduler, pt_PlayInstance);
+      pthread_attr_destroy(&t_Attributes);
+      if (s32_Error != 0)
+      {
+         printf("[W] SCHED_FIFO priority %d not permitted, using normal scheduling!\n", pt_PlayInstance->u32_Priority);
+      }
+   }
+   pt_PlayInstance->u8_Realtime = ((s32_Error == 0) ? 1 : 0);
+   if (s32_Error != 0)
+   {
+      if (pthread_create(&t_Thread, NULL, scheduler, pt_PlayInstance) != 0)
+      {
+         return -1;
+      }
+   }
+   pthread_join(t_Thread, NULL);
+
+   //return number of missed deadlines
+   return pt_PlayInstance->s32_Missed;
+}
+
+
+void play_print_statistic(T_PLAY_HANDLE opv_Handle)
+{
+   T_play_instance * const pt_PlayInstance = (T_play_instance *)opv_Handle;
+   uint32_t u32_Buckets;
+
+   if (pt_PlayInstance->u64_NumOfSignals == 0)
+   {
+      return;
+   }
+   printf("Playback: %llu signals, %llu ms, %s, %s\n", (unsigned long long)pt_PlayInstance->u64_NumOfSignals,
+          (unsigned long long)(pt_PlayInstance->u64_Duration1ns / 1000000u),
+          ((pt_PlayInstance->u8_Realtime != 0) ? "SCHED_FIFO" : "SCHED_OTHER"),
+          ((pt_PlayInstance->e_Clock == PLAY_CLOCK_TIMERFD) ? "timerfd" : "clock_nanosleep"));
+   printf("\tLatency [us]: min %llu, mean %llu, max %llu\n", (unsigned long long)(pt_PlayInstance->u64_MinLatency1ns / 1000u),
+          (unsigned long long)((pt_PlayInstance->u64_SumLatency1ns / pt_PlayInstance->u64_NumOfSignals) / 1000u),
+          (unsigned long long)(pt_PlayInstance->u64_MaxLatency1ns / 1000u));
+   printf("\tJitter [us]: max %llu\n", (unsigned long long)(pt_PlayInstance->u64_MaxJitter1ns / 1000u));
+   printf("\tMissed deadlines: %llu\n", (unsigned long long)pt_PlayInstance->u64_NumOfMissed);
+
+   //histograms up to the highest used bucket
+   u32_Buckets = get_bucket((pt_PlayInstance->u64_MaxLatency1ns > pt_PlayInstance->u64_MaxJitter1ns) ?
+                            pt_PlayInstance->u64_MaxLatency1ns : pt_PlayInstance->u64_MaxJitter1ns) + 1;
+   printf("\tHistogram [us]: latency, jitter\n");
+   for (uint32_t u32_Bucket = 0; u32_Bucket < u32_Buckets; ++u32_Bucket)
+   {
+      char acn_Range[32];
+
+      if (u32_Bucket == 0)
+      {
+         snprintf(acn_Range, sizeof(acn_Range), "<1");
+      }
+      else if (u32_Bucket == (PLAY_HISTOGRAM_BUCKETS - 1))
+      {
+         snprintf(acn_Range, sizeof(acn_Range), ">=%u", 1u << (u32_Bucket - 1));
+      }
+      else
+      {
+         snprintf(acn_Range, sizeof(acn_Range), "%u..%u", 1u << (u32_Bucket - 1), 1u << u32_Bucket);
+      }
+      printf("\t\t%12s %10llu %10llu\n", acn_Range, (unsigned long long)pt_PlayInstance->au64_Latency[u32_Bucket],
+             (unsigned long long)pt_PlayInstance->au64_Jitter[u32_Bucket]);
+   }
+}
+
+
+
+
+
+
+
+
+
+static uint64_t get_time_1ns(void)
+{
+   struct timespec t_Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &t_Now);
+   return ((uint64_t)t_Now.tv_sec * 1000000000u) + (uint64_t)t_Now.tv_nsec;
+}
+
+
+/*
+   Sleep until the absolute deadline (monotonic clock): timerfd if given (>= 0), otherwise clock_nanosleep.
+*/
+static void wait_until(const int os32_Timer, const uint64_t ou64_Deadline1ns)
+{
+   struct timespec t_Deadline;
+
+   t_Deadline.tv_sec = (time_t)(ou64_Deadline1ns / 1000000000u);
+   t_Deadline.tv_nsec = (long)(ou64_Deadline1ns % 1000000000u);
+   if (os32_Timer >= 0)
+   {
+      struct itimerspec t_Timer;
+      uint64_t u64_Expirations;
+
+      memset(&t_Timer, 0, sizeof(t_Timer));
+      t_Timer.it_value = t_Deadline;
+      if ((timerfd_settime(os32_Timer, TFD_TIMER_ABSTIME, &t_Timer, NULL) == 0) &&
+          (read(os32_Timer, &u64_Expirations, sizeof(u64_Expirations)) == (ssize_t)sizeof(u64_Expirations)))
+      {
+         return;
+      }
+   }
+   while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t_Deadline, NULL) == EINTR)
+   {
+   }
+}
+
+
+//0: < 1us, n: [2^(n-1), 2^n) us, last bucket: everything above
+static uint32_t get_bucket(const uint64_t ou64_Time1ns)
+{
+   uint64_t u64_Time1us = ou64_Time1ns / 1000u;
+   uint32_t u32_Bucket = 0;
+
+   while ((u64_Time1us > 0) && (u32_Bucket < (PLAY_HISTOGRAM_BUCKETS - 1)))
+   {
+      u64_Time1us >>= 1;
+      ++u32_Bucket;
+   }
+   return u32_Bucket;
+}
+
+
+static void record(T_play_instance * const opt_PlayInstance, const uint64_t ou64_Latency1ns, const uint64_t ou64_PreviousLatency1ns,
+                   const uint8_t ou8_First)
+{
+   ++opt_PlayInstance->u64_NumOfSignals;
+   opt_PlayInstance->u64_SumLatency1ns += ou64_Latency1ns;
+   if (ou64_Latency1ns < opt_PlayInstance->u64_MinLatency1ns)
+   {
+      opt_PlayInstance->u64_MinLatency1ns = ou64_Latency1ns;
+   }
+   if (ou64_Latency1ns > opt_PlayInstance->u64_MaxLatency1ns)
+   {
+      opt_PlayInstance->u64_MaxLatency1ns = ou64_Latency1ns;
+   }
+   ++opt_PlayInstance->au64_Latency[get_bucket(ou64_Latency1ns)];
+
+   //jitter: change of the latency from signal to signal (= error of the signal duration)
+   if (ou8_First == 0)
+   {
+      const uint64_t u64_Jitter1ns = ((ou64_Latency1ns > ou64_PreviousLatency1ns) ? (ou64_Latency1ns - ou64_PreviousLatency1ns) :
+                                                                                   (ou64_PreviousLatency1ns - ou64_Latency1ns));
+
+      if (u64_Jitter1ns > opt_PlayInstance->u64_MaxJitter1ns)
+      {
+         opt_PlayInstance->u64_MaxJitter1ns = u64_Jitter1ns;
+      }
+      ++opt_PlayInstance->au64_Jitter[get_bucket(u64_Jitter1ns)];
+   }
+}
+
+
+/*
+   Start each signal at its absolute deadline, so latencies do not accumulate. The end of the
+   last signal is passed as a rest, unless the sequence is terminated by a 0, 0 signal anyway.
+   Several sequences are passed to the sink one after another (time continues).
+*/
+static void * scheduler(void * opv_Instance)
+{
+   T_play_instance * const pt_PlayInstance = (T_play_instance *)opv_Instance;
+   const T_sound_signal * const pt_SignalSequence = pt_PlayInstance->pt_SignalSequence;
+   const int32_t s32_Length = pt_PlayInstance->s32_Length;
+   const uint8_t u8_End = ((pt_SignalSequence[s32_Length - 1].u16_Duration1ms != 0) ? 1 : 0);
+   const uint64_t u64_Offset1ns = pt_PlayInstance->u64_Duration1ns;
+   uint64_t u64_Start1ns;
+   uint64_t u64_Deadline1ns;
+   uint64_t u64_Latency1ns;
+   int s32_Timer;
+
+   s32_Timer = ((pt_PlayInstance->e_Clock == PLAY_CLOCK_TIMERFD) ? timerfd_create(CLOCK_MONOTONIC, 0) : -1);
+
+   //first deadline shortly ahead, so the first signal is measured like all others
+   u64_Start1ns = get_time_1ns() + 1000000u;
+   u64_Deadline1ns = u64_Start1ns;
+   u64_Latency1ns = 0;
+   for (int32_t s32_Count = 0; s32_Count < (s32_Length + u8_End); ++s32_Count)
+   {
+      const uint16_t u16_Frequency1Hz = ((s32_Count < s32_Length) ? pt_SignalSequence[s32_Count].u16_Frequency1Hz : 0);
+      const uint64_t u64_Duration1ns = ((s32_Count < s32_Length) ? ((uint64_t)pt_SignalSequence[s32_Count].u16_Duration1ms * 1000000u) : 0);
+      uint64_t u64_Now1ns;
+      uint64_t u64_Previous1ns;
+
+      wait_until(s32_Timer, u64_Deadline1ns);
+      u64_Now1ns = get_time_1ns();
+      u64_Previous1ns = u64_Latency1ns;
+      u64_Latency1ns = ((u64_Now1ns > u64_Deadline1ns) ? (u64_Now1ns - u64_Deadline1ns) : 0);
+      record(pt_PlayInstance, u64_Latency1ns, u64_Previous1ns, ((s32_Count == 0) ? 1 : 0));
+      if ((u64_Duration1ns > 0) && (u64_Latency1ns >= u64_Duration1ns))
+      {
+         ++pt_PlayInstance->s32_Missed;
+      }
+      pt_PlayInstance->pf_Sink(u64_Offset1ns + (u64_Deadline1ns - u64_Start1ns), u16_Frequency1Hz, pt_PlayInstance->pv_Context);
+      u64_Deadline1ns += u64_Duration1ns;
+   }
+   pt_PlayInstance->u64_NumOfMissed += (uint64_t)pt_PlayInstance->s32_Missed;
+   pt_PlayInstance->u64_Duration1ns += u64_Deadline1ns - u64_Start1ns;
+
+   if (s32_Timer >= 0)
+   {
+      close(s32_Timer);
+   }
+   return NULL;
+}
+
+
+static void sink_null(const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz, void * const opv_Context)
+{
+   (void)ou64_Time1ns;
+   (void)ou16_Frequency1Hz;
+   (void)opv_Context;
+}
+
+
+//one line per signal, written at once (no buffering): "<time [us]> <frequency [Hz]>"
+static void sink_fifo(const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz, void * const opv_Context)
+{
+   T_play_instance * const pt_PlayInstance = (T_play_instance *)opv_Context;
+   char acn_Line[64];
+   int s32_Length;
+
+   s32_Length = snprintf(acn_Line, sizeof(acn_Line), "%llu %d\n", (unsigned long long)(ou64_Time1ns / 1000u), ou16_Frequency1Hz);
+   if (write(pt_PlayInstance->s32_Fifo, acn_Line, (size_t)s32_Length) < 0)
+   {
+      //reader gone: the remaining signals are scheduled anyway
+   }
+}
+
+
+/*
+   Queue the change for the writer thread (the queue only waits if the writer is
+   PLAY_PCM_CHANGES changes behind).
+*/
+static void sink_pcm(const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz, void * const opv_Context)
+{
+   T_play_instance * const pt_PlayInstance = (T_play_instance *)opv_Context;
+   T_play_change * const pt_Change = ring_get_write_slot(pt_PlayInstance->pv_PcmRing);
+
+   pt_Change->u64_Time1ns = ou64_Time1ns;
+   pt_Change->u16_Frequency1Hz = ou16_Frequency1Hz;
+   pt_Change->u8_Stop = 0;
+   ring_commit_write_slot(pt_PlayInstance->pv_PcmRing);
+}
+
+
+//writes the queued changes to the pcm file (normal scheduling), sleeps while the queue is empty
+static void * pcm_writer(void * opv_Instance)
+{
+   T_play_instance * const pt_PlayInstance = (T_play_instance *)opv_Instance;
+
+   for (;;)
+   {
+      const T_play_change * const pt_Change = ring_try_get_read_slot(pt_PlayInstance->pv_PcmRing);
+      uint8_t u8_Stop;
+
+      if (pt_Change == NULL)
+      {
+         const struct timespec t_Poll = { 0, PLAY_PCM_POLL_1NS };
+
+         nanosleep(&t_Poll, NULL);
+         continue;
+      }
+      u8_Stop = pt_Change->u8_Stop;
+      if (u8_Stop == 0)
+      {
+         write_pcm(pt_PlayInstance, pt_Change->u64_Time1ns, pt_Change->u16_Frequency1Hz);
+      }
+      ring_release_read_slot(pt_PlayInstance->pv_PcmRing);
+      if (u8_Stop != 0)
+      {
+         break;
+      }
+   }
+   return NULL;
+}
+
+
+/*
+   Square wave of the previous frequency up to the start of the new signal (sample exact, the
+   phase is continued across signals).
+*/
+static void write_pcm(T_play_instance * const opt_PlayInstance, const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz)
+{
+   const uint64_t u64_End = ((ou64_Time1ns * PLAY_PCM_RATE_1HZ) + 500000000u) / 1000000000u;
+   const uint32_t u32_Step = (uint32_t)(((uint64_t)opt_PlayInstance->u16_PcmFrequency1Hz << 32) / PLAY_PCM_RATE_1HZ);
+   int16_t as16_Block[PLAY_PCM_BLOCK];
+
+   while (opt_PlayInstance->u64_PcmSamples < u64_End)
+   {
+      uint32_t u32_Samples = PLAY_PCM_BLOCK;
+
+      if ((u64_End - opt_PlayInstance->u64_PcmSamples) < u32_Samples)
+      {
+         u32_Samples = (uint32_t)(u64_End - opt_PlayInstance->u64_PcmSamples);
+      }
+      for (uint32_t u32_Sample = 0; u32_Sample < u32_Samples; ++u32_Sample)
+      {
+         as16_Block[u32_Sample] = ((u32_Step == 0) ? 0 : ((opt_PlayInstance->u32_PcmPhase < 0x80000000u) ? PLAY_PCM_AMPLITUDE : -PLAY_PCM_AMPLITUDE));
+         opt_PlayInstance->u32_PcmPhase += u32_Step;
+      }
+      fwrite(as16_Block, sizeof(int16_t), u32_Samples, opt_PlayInstance->pv_Pcm);
+      opt_PlayInstance->u64_PcmSamples += u32_Samples;
+   }
+   opt_PlayInstance->u16_PcmFrequency1Hz = ou16_Frequency1Hz;
+}
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     play.h
+   \brief    Functions to play a signal sequence in real time (timing validation on Linux)
+
+   Each signal is started at its absolute deadline (monotonic clock, sum of the
+   previous durations) by a scheduler thread, optionally with SCHED_FIFO priority.
+   The frequency change is passed to a sink. For each signal, the latency (wake up
+   after the deadline) and the jitter (difference to the latency of the previous
+   signal) are recorded in histograms.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _PLAY_H
+#define _PLAY_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "sound.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define PLAY_PCM_RATE_1HZ        (44100)  //pcm sink: 16-bit signed mono, host byte order
+#define PLAY_HISTOGRAM_BUCKETS   (18)     //<1us, 1..2us, 2..4us, ..., >= 65536us
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_PLAY_HANDLE;
+
+
+typedef enum
+{
+   PLAY_CLOCK_NANOSLEEP = 0,              //clock_nanosleep (TIMER_ABSTIME)
+   PLAY_CLOCK_TIMERFD                     //timerfd (TFD_TIMER_ABSTIME)
+} T_play_clock;
+
+
+//called at the start of each signal (ou64_Time1ns: deadline relative to the start of the first sequence, 0 Hz: rest)
+typedef void (*T_play_sink)(const uint64_t ou64_Time1ns, const uint16_t ou16_Frequency1Hz, void * const opv_Context);
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//ou32_Priority: SCHED_FIFO priority (0: normal scheduling)
+extern T_PLAY_HANDLE play_open(T_play_sink opf_Sink, void * const opv_Context, const T_play_clock oe_Clock, const uint32_t ou32_Priority);
+//built in sinks: "null", "fifo:<path>" (one line per signal: time [us], frequency [Hz]), "pcm:<path>" (square wave)
+extern T_PLAY_HANDLE play_open_sink(const char * const opc_Sink, const T_play_clock oe_Clock, const uint32_t ou32_Priority);
+extern void play_close(T_PLAY_HANDLE opv_Handle);
+
+//blocks until the sequence is played; returns the number of missed deadlines, -1 on error
+extern int32_t play_signal_sequence(T_PLAY_HANDLE opv_Handle, const int32_t os32_Length, const T_sound_signal * const opt_SignalSequence);
+extern void play_print_statistic(T_PLAY_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
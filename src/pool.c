@@ -0,0 +1,378 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     pool.c
+   \brief    Functions to combine the signal sequences of several songs into one pool
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "pool.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define POOL_HASH_FACTOR      (0x9E3779B97F4A7C15uLL)   //odd 64-bit constant (golden ratio)
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   char * pc_Name;
+   uint64_t u64_Order;
+   int32_t s32_Added;                     //position of adding (tie breaker of u64_Order)
+   T_sound_signal * pat_SignalSequence;
+   int32_t s32_Length;
+   int32_t s32_Offset;                    //offset within pool (result of pool_build)
+} T_pool_song;
+
+
+typedef struct
+{
+   uint64_t u64_Hash;
+   int32_t s32_Offset;                    //-1: empty slot
+   int32_t s32_Length;
+} T_pool_slot;
+
+
+typedef struct
+{
+   T_pool_song * pat_Song;
+   int32_t s32_NumOfSongs;
+   int32_t s32_MaxSongs;
+   T_sound_signal * pat_Pool;
+   int32_t s32_PoolLength;
+   int32_t s32_TotalLength;               //sum of all song lengths (without deduplication)
+} T_pool_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static int compare_song_order(const void * opv_A, const void * opv_B);
+static int compare_song_length(const void * opv_A, const void * opv_B);
+static uint64_t get_hash(const uint64_t ou64_Hash, const T_sound_signal * const opt_Signal);
+static T_pool_slot * find_slot(T_pool_slot * const opat_Slot, const uint32_t ou32_Mask, const uint64_t ou64_Hash, const int32_t os32_Length,
+                               const T_sound_signal * const opt_Pool, const T_sound_signal * const opt_SignalSequence);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_POOL_HANDLE pool_open(void)
+{
+   T_pool_instance * pt_PoolInstance;
+
+   //------------------------------------------------------------//
+   // allocate pool instance                                     //
+   //------------------------------------------------------------//
+   pt_PoolInstance = calloc(1, sizeof(T_pool_instance));
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return pool instance handle
+   return pt_PoolInstance;
+}
+
+
+void pool_close(T_POOL_HANDLE opv_Handle)
+{
+   T_pool_instance * const pt_PoolInstance = (T_pool_instance *)opv_Handle;
+   int32_t s32_Song;
+
+   //release songs, pool and instance itself
+   for (s32_Song = 0; s32_Song < pt_PoolInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      free(pt_PoolInstance->pat_Song[s32_Song].pc_Name);
+      free(pt_PoolInstance->pat_Song[s32_Song].pat_SignalSequence);
+   }
+   free(pt_PoolInstance->pat_Song);
+   free(pt_PoolInstance->pat_Pool);
+   free(pt_PoolInstance);
+}
+
+
+int32_t pool_add_signal_sequence(T_POOL_HANDLE opv_Handle, const char * const opc_Name, const uint64_t ou64_Order,
+                                 const int32_t os32_Length, const T_sound_signal * opt_SignalSequence)
+{
+   T_pool_instance * const pt_PoolInstance = (T_pool_instance *)opv_Handle;
+   T_pool_song * pt_Song;
+   int32_t s32_Length;
+
+   //preconditional check
+   if (os32_Length <= 0)
+   {
+      return -1;
+   }
+
+   //grow song list
+   if (pt_PoolInstance->s32_NumOfSongs >= pt_PoolInstance->s32_MaxSongs)
+   {
+      pt_PoolInstance->s32_MaxSongs = ((pt_PoolInstance->s32_MaxSongs > 0) ? (2 * pt_PoolInstance->s32_MaxSongs) : 16);
+      pt_PoolInstance->pat_Song = realloc(pt_PoolInstance->pat_Song, pt_PoolInstance->s32_MaxSongs * sizeof(T_pool_song));
+   }
+
+   //copy sequence; make sure it is terminated by a 0, 0 signal
+   s32_Length = os32_Length;
+   pt_Song = &pt_PoolInstance->pat_Song[pt_PoolInstance->s32_NumOfSongs];
+   pt_Song->pc_Name = strdup(opc_Name);
+   pt_Song->u64_Order = ou64_Order;
+   pt_Song->s32_Added = pt_PoolInstance->s32_NumOfSongs;
+   pt_Song->pat_SignalSequence = malloc((os32_Length + 1) * sizeof(T_sound_signal));
+   memcpy(pt_Song->pat_SignalSequence, opt_SignalSequence, os32_Length * sizeof(T_sound_signal));
+   if ((opt_SignalSequence[os32_Length - 1].u16_Duration1ms != 0) || (opt_SignalSequence[os32_Length - 1].u16_Frequency1Hz != 0))
+   {
+      pt_Song->pat_SignalSequence[s32_Length].u16_Duration1ms = 0;
+      pt_Song->pat_SignalSequence[s32_Length].u16_Frequency1Hz = 0;
+      ++s32_Length;
+   }
+   pt_Song->s32_Length = s32_Length;
+   pt_Song->s32_Offset = -1;
+   pt_PoolInstance->s32_TotalLength += s32_Length;
+
+   //return number of songs
+   return ++pt_PoolInstance->s32_NumOfSongs;
+}
+
+
+/*
+   Songs are placed longest first (ties by song ID, so the result is deterministic).
+   The hash of every tail of a placed song is recorded. A subsequent song, whose hash
+   (and content) matches a recorded tail, refers to it instead of being placed again.
+   Hashes of all tails are computed backwards in one pass, so the whole build is linear.
+*/
+int32_t pool_build(T_POOL_HANDLE opv_Handle)
+{
+   T_pool_instance * const pt_PoolInstance = (T_pool_instance *)opv_Handle;
+   T_pool_song ** ppt_Order;
+   T_pool_slot * pt_Slot;
+   uint32_t u32_NumOfSlots;
+   int32_t s32_Song;
+
+   //preconditional check
+   if (pt_PoolInstance->s32_NumOfSongs <= 0)
+   {
+      return -1;
+   }
+
+   //------------------------------------------------------------//
+   // allocate pool and hash table                               //
+   //------------------------------------------------------------//
+   free(pt_PoolInstance->pat_Pool);
+   pt_PoolInstance->pat_Pool = malloc(pt_PoolInstance->s32_TotalLength * sizeof(T_sound_signal));
+   pt_PoolInstance->s32_PoolLength = 0;
+   //at least twice the number of tails (load factor <= 0.5)
+   u32_NumOfSlots = 1;
+   while (u32_NumOfSlots < (2u * (uint32_t)pt_PoolInstance->s32_TotalLength))
+   {
+      u32_NumOfSlots <<= 1;
+   }
+   pt_Slot = malloc(u32_NumOfSlots * sizeof(T_pool_slot));
+   for (uint32_t u32_Slot = 0; u32_Slot < u32_NumOfSlots; ++u32_Slot)
+   {
+      pt_Slot[u32_Slot].s32_Offset = -1;
+   }
+
+   //------------------------------------------------------------//
+   // assign song IDs                                            //
+   //------------------------------------------------------------//
+   qsort(pt_PoolInstance->pat_Song, pt_PoolInstance->s32_NumOfSongs, sizeof(T_pool_song), compare_song_order);
+
+   //------------------------------------------------------------//
+   // order songs by length                                      //
+   //------------------------------------------------------------//
+   ppt_Order = malloc(pt_PoolInstance->s32_NumOfSongs * sizeof(T_pool_song *));
+   for (s32_Song = 0; s32_Song < pt_PoolInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      ppt_Order[s32_Song] = &pt_PoolInstance->pat_Song[s32_Song];
+   }
+   qsort(ppt_Order, pt_PoolInstance->s32_NumOfSongs, sizeof(T_pool_song *), compare_song_length);
+
+   //------------------------------------------------------------//
+   // place songs                                                //
+   //------------------------------------------------------------//
+   for (s32_Song = 0; s32_Song < pt_PoolInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      T_pool_song * const pt_Song = ppt_Order[s32_Song];
+      T_pool_slot * pt_Match;
+      uint64_t u64_Hash;
+      int32_t s32_Count;
+
+      //hash of whole song
+      u64_Hash = 0;
+      for (s32_Count = pt_Song->s32_Length - 1; s32_Count >= 0; --s32_Count)
+      {
+         u64_Hash = get_hash(u64_Hash, &pt_Song->pat_SignalSequence[s32_Count]);
+      }
+
+      //already contained (as whole song or as tail)?
+      pt_Match = find_slot(pt_Slot, u32_NumOfSlots - 1, u64_Hash, pt_Song->s32_Length, pt_PoolInstance->pat_Pool, pt_Song->pat_SignalSequence);
+      if (pt_Match->s32_Offset >= 0)
+      {
+         pt_Song->s32_Offset = pt_Match->s32_Offset;
+         continue;
+      }
+
+      //append to pool and record the hashes of all its tails
+      pt_Song->s32_Offset = pt_PoolInstance->s32_PoolLength;
+      memcpy(&pt_PoolInstance->pat_Pool[pt_Song->s32_Offset], pt_Song->pat_SignalSequence, pt_Song->s32_Length * sizeof(T_sound_signal));
+      pt_PoolInstance->s32_PoolLength += pt_Song->s32_Length;
+      u64_Hash = 0;
+      for (s32_Count = pt_Song->s32_Length - 1; s32_Count >= 0; --s32_Count)
+      {
+         const int32_t s32_Offset = pt_Song->s32_Offset + s32_Count;
+
+         u64_Hash = get_hash(u64_Hash, &pt_Song->pat_SignalSequence[s32_Count]);
+         //equal hash and length is sufficient here: a collision only misses a deduplication
+         pt_Match = find_slot(pt_Slot, u32_NumOfSlots - 1, u64_Hash, pt_Song->s32_Length - s32_Count, pt_PoolInstance->pat_Pool, NULL);
+         if (pt_Match->s32_Offset < 0) //keep first occurrence
+         {
+            pt_Match->u64_Hash = u64_Hash;
+            pt_Match->s32_Offset = s32_Offset;
+            pt_Match->s32_Length = pt_Song->s32_Length - s32_Count;
+         }
+      }
+   }
+
+   free(ppt_Order);
+   free(pt_Slot);
+   return pt_PoolInstance->s32_PoolLength;
+}
+
+
+void pool_print_index(T_POOL_HANDLE opv_Handle)
+{
+   T_pool_instance * const pt_PoolInstance = (T_pool_instance *)opv_Handle;
+   int32_t s32_Song;
+
+   printf("Pool: %d songs, %d of %d signals\n", pt_PoolInstance->s32_NumOfSongs, pt_PoolInstance->s32_PoolLength, pt_PoolInstance->s32_TotalLength);
+   for (s32_Song = 0; s32_Song < pt_PoolInstance->s32_NumOfSongs; ++s32_Song)
+   {
+      const T_pool_song * const pt_Song = &pt_PoolInstance->pat_Song[s32_Song];
+
+      printf("%d : %s, offset %d, %d signals\n", s32_Song, pt_Song->pc_Name, pt_Song->s32_Offset, pt_Song->s32_Length);
+   }
+}
+
+
+void pool_write(const char * const opc_File, T_POOL_HANDLE opv_Handle)
+{
+   T_pool_instance * const pt_PoolInstance = (T_pool_instance *)opv_Handle;
+   const T_sound_signal * pt_Signal;
+   FILE * pv_File;
+   int32_t s32_Count;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = fopen(opc_File, "w");
+
+   //------------------------------------------------------------//
+   // write pool to file                                         //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint16_t gau16_SoundPool[] = { //2x16-bit value pair : Duration [1ms], Frequeny [1Hz]; each song terminated by 0, 0\n");
+   pt_Signal = pt_PoolInstance->pat_Pool;
+   for (s32_Count = 0; s32_Count < pt_PoolInstance->s32_PoolLength; ++s32_Count)
+   {
+      fprintf(pv_File, "  %d, %d, ", pt_Signal->u16_Duration1ms, pt_Signal->u16_Frequency1Hz);
+      if ((s32_Count % 8) == 7)
+      {
+         fprintf(pv_File, "\n");
+      }
+      ++pt_Signal;
+   }
+   fprintf(pv_File, "\n};\n\n");
+
+   //------------------------------------------------------------//
+   // write index to file                                        //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint32_t gau32_SoundIndex[] = { //song ID -> index of first value pair in gau16_SoundPool\n");
+   for (s32_Count = 0; s32_Count < pt_PoolInstance->s32_NumOfSongs; ++s32_Count)
+   {
+      const T_pool_song * const pt_Song = &pt_PoolInstance->pat_Song[s32_Count];
+
+      fprintf(pv_File, "  %d, // %d: %s\n", pt_Song->s32_Offset, s32_Count, pt_Song->pc_Name);
+   }
+   fprintf(pv_File, "};\n\n");
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   fclose(pv_File);
+}
+
+
+
+
+
+
+
+
+
+static int compare_song_order(const void * opv_A, const void * opv_B)
+{
+   const T_pool_song * const pt_A = (const T_pool_song *)opv_A;
+   const T_pool_song * const pt_B = (const T_pool_song *)opv_B;
+
+   if (pt_A->u64_Order != pt_B->u64_Order)
+   {
+      return ((pt_A->u64_Order < pt_B->u64_Order) ? -1 : 1);
+   }
+   return ((pt_A->s32_Added < pt_B->s32_Added) ? -1 : ((pt_A->s32_Added > pt_B->s32_Added) ? 1 : 0));
+}
+
+
+static int compare_song_length(const void * opv_A, const void * opv_B)
+{
+   const T_pool_song * const pt_A = *(const T_pool_song * const *)opv_A;
+   const T_pool_song * const pt_B = *(const T_pool_song * const *)opv_B;
+
+   //longest first
+   if (pt_A->s32_Length != pt_B->s32_Length)
+   {
+      return ((pt_A->s32_Length > pt_B->s32_Length) ? -1 : 1);
+   }
+   //equal length: by song ID (= position in song list)
+   return ((pt_A < pt_B) ? -1 : ((pt_A > pt_B) ? 1 : 0));
+}
+
+
+static uint64_t get_hash(const uint64_t ou64_Hash, const T_sound_signal * const opt_Signal)
+{
+   const uint64_t u64_Signal = ((uint64_t)opt_Signal->u16_Duration1ms << 16) | opt_Signal->u16_Frequency1Hz;
+
+   return ((ou64_Hash ^ u64_Signal) * POOL_HASH_FACTOR) + 1;
+}
+
+
+/*
+   Open addressing (linear probing). Returns the slot holding an equal sequence,
+   or the empty slot, where it shall be inserted.
+   Content is only compared, if opt_SignalSequence is given.
+*/
+static T_pool_slot * find_slot(T_pool_slot * const opat_Slot, const uint32_t ou32_Mask, const uint64_t ou64_Hash, const int32_t os32_Length,
+                               const T_sound_signal * const opt_Pool, const T_sound_signal * const opt_SignalSequence)
+{
+   uint32_t u32_Slot;
+
+   u32_Slot = (uint32_t)(ou64_Hash >> 32) & ou32_Mask;
+   for (;;)
+   {
+      T_pool_slot * const pt_Slot = &opat_Slot[u32_Slot];
+
+      if (pt_Slot->s32_Offset < 0)
+      {
+         return pt_Slot;
+      }
+      if ((pt_Slot->u64_Hash == ou64_Hash) && (pt_Slot->s32_Length == os32_Length) &&
+          ((opt_SignalSequence == NULL) || (memcmp(&opt_Pool[pt_Slot->s32_Offset], opt_SignalSequence, os32_Length * sizeof(T_sound_signal)) == 0)))
+      {
+         return pt_Slot;
+      }
+      u32_Slot = (u32_Slot + 1) & ou32_Mask;
+   }
+}
@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     pool.h
+   \brief    Functions to combine the signal sequences of several songs into one pool
+
+   Identical songs are stored only once. A song, that is equal to the end (tail)
+   of another song, is stored as a reference into that song.
+   An index maps the song ID to the offset of its first signal within the pool.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _POOL_H
+#define _POOL_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "sound.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_POOL_HANDLE;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+extern T_POOL_HANDLE pool_open(void);
+extern void pool_close(T_POOL_HANDLE opv_Handle);
+
+//add song (sequence is copied); song IDs are assigned by ascending ou64_Order in pool_build (independent of the order of adding)
+extern int32_t pool_add_signal_sequence(T_POOL_HANDLE opv_Handle, const char * const opc_Name, const uint64_t ou64_Order,
+                                        const int32_t os32_Length, const T_sound_signal * opt_SignalSequence);
+extern int32_t pool_build(T_POOL_HANDLE opv_Handle);
+extern void pool_print_index(T_POOL_HANDLE opv_Handle);
+extern void pool_write(const char * const opc_File, T_POOL_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
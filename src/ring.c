@@ -0,0 +1,182 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     ring.c
+   \brief    Bounded single producer / single consumer ring buffer of fixed size blocks
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sched.h>
+#include "ring.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define RING_CACHE_LINE       (64)
+#define RING_SPIN_COUNT       (64)  //polls before the waiting thread yields
+
+/* -- Types --------------------------------------------------------------- */
+/*
+   Head and tail are free running counters; head is written by the producer only,
+   tail by the consumer only. Each one is kept in a cache line of its own, together
+   with the cached copy of the other side's counter (reduces cache line transfers).
+*/
+typedef struct
+{
+   uint8_t * pu8_Slots;
+   uint32_t u32_SlotSize1By;
+   uint32_t u32_NumOfSlots;
+   uint8_t au8_Pad0[RING_CACHE_LINE];
+   uint32_t u32_Head;                  //number of committed slots (producer)
+   uint32_t u32_CachedTail;
+   uint8_t au8_Pad1[RING_CACHE_LINE];
+   uint32_t u32_Tail;                  //number of released slots (consumer)
+   uint32_t u32_CachedHead;
+   uint8_t au8_Pad2[RING_CACHE_LINE];
+} T_ring_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void wait_for_slot(uint32_t * const opu32_Spin);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_RING_HANDLE ring_open(const uint32_t ou32_SlotSize1By, const uint32_t ou32_NumOfSlots)
+{
+   T_ring_instance * pt_RingInstance;
+
+   //preconditional check
+   if ((ou32_SlotSize1By == 0) || (ou32_NumOfSlots == 0))
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // allocate ring instance and slots                           //
+   //------------------------------------------------------------//
+   pt_RingInstance = calloc(1, sizeof(T_ring_instance));
+   pt_RingInstance->u32_SlotSize1By = (ou32_SlotSize1By + (RING_CACHE_LINE - 1)) & ~(uint32_t)(RING_CACHE_LINE - 1);
+   pt_RingInstance->u32_NumOfSlots = ou32_NumOfSlots;
+   pt_RingInstance->pu8_Slots = malloc((size_t)pt_RingInstance->u32_SlotSize1By * ou32_NumOfSlots);
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return ring instance handle
+   return pt_RingInstance;
+}
+
+
+void ring_close(T_RING_HANDLE opv_Handle)
+{
+   T_ring_instance * const pt_RingInstance = (T_ring_instance *)opv_Handle;
+
+   //release slots and instance itself
+   free(pt_RingInstance->pu8_Slots);
+   free(pt_RingInstance);
+}
+
+
+void * ring_get_write_slot(T_RING_HANDLE opv_Handle)
+{
+   T_ring_instance * const pt_RingInstance = (T_ring_instance *)opv_Handle;
+   const uint32_t u32_Head = pt_RingInstance->u32_Head;
+   uint32_t u32_Spin = 0;
+
+   //backpressure: wait until the consumer released the oldest slot
+   while ((u32_Head - pt_RingInstance->u32_CachedTail) >= pt_RingInstance->u32_NumOfSlots)
+   {
+      pt_RingInstance->u32_CachedTail = __atomic_load_n(&pt_RingInstance->u32_Tail, __ATOMIC_ACQUIRE);
+      if ((u32_Head - pt_RingInstance->u32_CachedTail) >= pt_RingInstance->u32_NumOfSlots)
+      {
+         wait_for_slot(&u32_Spin);
+      }
+   }
+   return &pt_RingInstance->pu8_Slots[(size_t)(u32_Head % pt_RingInstance->u32_NumOfSlots) * pt_RingInstance->u32_SlotSize1By];
+}
+
+
+void ring_commit_write_slot(T_RING_HANDLE opv_Handle)
+{
+   T_ring_instance * const pt_RingInstance = (T_ring_instance *)opv_Handle;
+
+   //publish the content of the slot together with the new head
+   __atomic_store_n(&pt_RingInstance->u32_Head, pt_RingInstance->u32_Head + 1, __ATOMIC_RELEASE);
+}
+
+
+const void * ring_get_read_slot(T_RING_HANDLE opv_Handle)
+{
+   T_ring_instance * const pt_RingInstance = (T_ring_instance *)opv_Handle;
+   const uint32_t u32_Tail = pt_RingInstance->u32_Tail;
+   uint32_t u32_Spin = 0;
+
+   //wait until the producer committed a slot
+   while (u32_Tail == pt_RingInstance->u32_CachedHead)
+   {
+      pt_RingInstance->u32_CachedHead = __atomic_load_n(&pt_RingInstance->u32_Head, __ATOMIC_ACQUIRE);
+      if (u32_Tail == pt_RingInstance->u32_CachedHead)
+      {
+         wait_for_slot(&u32_Spin);
+      }
+   }
+   return &pt_RingInstance->pu8_Slots[(size_t)(u32_Tail % pt_RingInstance->u32_NumOfSlots) * pt_RingInstance->u32_SlotSize1By];
+}
+
+
+const void * ring_try_get_read_slot(T_RING_HANDLE opv_Handle)
+{
+   T_ring_instance * const pt_RingInstance = (T_ring_instance *)opv_Handle;
+   const uint32_t u32_Tail = pt_RingInstance->u32_Tail;
+
+   if (u32_Tail == pt_RingInstance->u32_CachedHead)
+   {
+      pt_RingInstance->u32_CachedHead = __atomic_load_n(&pt_RingInstance->u32_Head, __ATOMIC_ACQUIRE);
+      if (u32_Tail == pt_RingInstance->u32_CachedHead)
+      {
+         return NULL;
+      }
+   }
+   return &pt_RingInstance->pu8_Slots[(size_t)(u32_Tail % pt_RingInstance->u32_NumOfSlots) * pt_RingInstance->u32_SlotSize1By];
+}
+
+
+void ring_release_read_slot(T_RING_HANDLE opv_Handle)
+{
+   T_ring_instance * const pt_RingInstance = (T_ring_instance *)opv_Handle;
+
+   //hand the slot back to the producer
+   __atomic_store_n(&pt_RingInstance->u32_Tail, pt_RingInstance->u32_Tail + 1, __ATOMIC_RELEASE);
+}
+
+
+
+
+
+
+
+
+
+/*
+   Poll a few times (the other side is usually about to finish its block), then
+   give the CPU to the other stages (there may be fewer CPUs than stages).
+*/
+static void wait_for_slot(uint32_t * const opu32_Spin)
+{
+   if (*opu32_Spin < RING_SPIN_COUNT)
+   {
+      ++(*opu32_Spin);
+   }
+   else
+   {
+      sched_yield();
+   }
+}
@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     ring.h
+   \brief    Bounded single producer / single consumer ring buffer of fixed size blocks
+
+   The blocks are stored within the ring; the producer fills a free slot in place
+   and commits it, the consumer processes a filled slot in place and releases it.
+   Exactly one thread may write and one thread may read. No locks are used, a
+   thread waits (spin, then yield) while the ring is full respectively empty.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _RING_H
+#define _RING_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_RING_HANDLE;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+extern T_RING_HANDLE ring_open(const uint32_t ou32_SlotSize1By, const uint32_t ou32_NumOfSlots);
+extern void ring_close(T_RING_HANDLE opv_Handle);
+
+//producer: get free slot (waits while ring is full), commit it after filling
+extern void * ring_get_write_slot(T_RING_HANDLE opv_Handle);
+extern void ring_commit_write_slot(T_RING_HANDLE opv_Handle);
+//consumer: get filled slot (waits while ring is empty), release it after processing
+extern const void * ring_get_read_slot(T_RING_HANDLE opv_Handle);
+//consumer: get filled slot without waiting (NULL while ring is empty)
+extern const void * ring_try_get_read_slot(T_RING_HANDLE opv_Handle);
+extern void ring_release_read_slot(T_RING_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
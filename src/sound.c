@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include "sound.h"
 
@@ -26,11 +27,38 @@ typedef struct
 } T_sound_instance;
 
 
+/*
+   State of a stream conversion: midi_event_strip_redundant_note_events and
+   sound_get_signal_sequence with one event look-ahead each.
+*/
+typedef struct
+{
+   T_sound_sink pf_Sink;               //NULL: signals are collected
+   void * pv_Context;
+   uint32_t u32_MaxGapTicks;
+   double f64_ScaleTicksToMs;
+   T_midi_event_note t_Pending;        //event, that is not yet known to be kept
+   uint8_t u8_HasPending;
+   T_midi_event_note t_Kept;           //kept event, waiting for the delta time of its successor
+   uint8_t u8_HasKept;
+   T_sound_signal t_Signal;            //signal, that may still be extended
+   uint8_t u8_HasSignal;
+   int32_t s32_NumOfSignals;           //passed to the sink, respectively collected
+   int32_t s32_MaxSignals;
+   T_sound_signal * pat_SignalSequence;
+} T_sound_stream_instance;
+
+
 /* -- Global Variables ---------------------------------------------------- */
 
 /* -- Module Global Variables --------------------------------------------- */
 
 /* -- Module Global Function Prototypes ----------------------------------- */
+static void keep_event(T_sound_stream_instance * const opt_StreamInstance, const T_midi_event_note * const opt_NoteEvent);
+static void add_signal(T_sound_stream_instance * const opt_StreamInstance, const T_midi_event_note * const opt_NoteEvent, const uint32_t ou32_DeltaTime);
+static void push_signal(T_sound_stream_instance * const opt_StreamInstance, const T_sound_signal * const opt_Signal);
+static void write_signal_sequence(FILE * const opv_File, const char * const opc_Symbol, const int32_t os32_Length,
+                                  const T_sound_signal * opt_SignalSequence);
 
 /* -- Implementation ------------------------------------------------------ */
 
@@ -38,7 +66,6 @@ typedef struct
 T_SOUND_HANDLE sound_open(const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents, const uint16_t ou16_TimeDivision)
 {
    T_sound_instance * pt_SoundInstance;
-   double f64_ScaleTo1ms;
 
    //preconditional check
    if (os32_Length <= 0)
@@ -56,24 +83,7 @@ T_SOUND_HANDLE sound_open(const int32_t os32_Length, const T_midi_event_note * o
    //------------------------------------------------------------//
    // calculate scale factor for time delay values               //
    //------------------------------------------------------------//
-   if (ou16_TimeDivision <= 0x7FFFu)
-   {
-      //ticks per beat -> assum 500ms per beat
-      f64_ScaleTo1ms = 500; //500ms
-      f64_ScaleTo1ms = f64_ScaleTo1ms / ou16_TimeDivision;
-   }
-   else
-   {
-      uint32_t u32_TicksPerFrame;
-      uint32_t u32_FramesPerSec;
-
-      u32_TicksPerFrame = ou16_TimeDivision & 0x00FFu;
-      u32_FramesPerSec = ((ou16_TimeDivision & 0x7F00u) >> 8);
-
-      f64_ScaleTo1ms = 1000; //1000ms
-      f64_ScaleTo1ms = (f64_ScaleTo1ms / u32_FramesPerSec) / u32_TicksPerFrame;
-   }
-   pt_SoundInstance->f64_ScaleTicksToMs = f64_ScaleTo1ms;
+   pt_SoundInstance->f64_ScaleTicksToMs = sound_get_ms_per_tick(ou16_TimeDivision);
 
 
    //------------------------------------------------------------//
@@ -104,10 +114,6 @@ int32_t sound_get_signal_sequence(T_SOUND_HANDLE opv_Handle, T_sound_signal ** o
    T_sound_instance * const pt_SoundInstance = (T_sound_instance *)opv_Handle;
    const T_midi_event_note * pt_NoteEvent;
    T_sound_signal * pt_SignalSequence;
-   const double f64_C = 8.175798916;
-   double f64_Exp;
-   double f64_2Exp;
-   double f64_Frequency1Hz;
    uint16_t u16_Frequency1Hz;
    int32_t s32_Count;
    double f64_Duration1ms;
@@ -124,7 +130,8 @@ int32_t sound_get_signal_sequence(T_SOUND_HANDLE opv_Handle, T_sound_signal ** o
    {
       uint32_t u32_DeltaTime;
 
-      u32_DeltaTime = pt_NoteEvent[1].u32_DeltaTime;
+      //the subsequent event defines the duration (the last event has none)
+      u32_DeltaTime = (((s32_Count + 1) < pt_SoundInstance->s32_Length) ? pt_NoteEvent[1].u32_DeltaTime : 0);
       if (u32_DeltaTime != 0)
       {
          //-----------------------------------------------------//
@@ -133,14 +140,7 @@ int32_t sound_get_signal_sequence(T_SOUND_HANDLE opv_Handle, T_sound_signal ** o
          u16_Frequency1Hz = 0;
          if (pt_NoteEvent->u8_OnOff != 0)
          {
-            //calculate exponent (note/12)
-            f64_Exp = pt_NoteEvent->u8_Note;
-            f64_Exp = f64_Exp / 12;
-            //power of 2
-            f64_2Exp = pow(2.0, f64_Exp);
-            //frequency
-            f64_Frequency1Hz = f64_C * f64_2Exp;
-            u16_Frequency1Hz = (uint16_t)f64_Frequency1Hz;
+            u16_Frequency1Hz = sound_get_note_frequency(pt_NoteEvent->u8_Note);
          }
          pt_SignalSequence->u16_Frequency1Hz = u16_Frequency1Hz;
 
@@ -174,6 +174,148 @@ int32_t sound_get_signal_sequence(T_SOUND_HANDLE opv_Handle, T_sound_signal ** o
    return s32_Signal + 1;
 }
 
+double sound_get_ms_per_tick(const uint16_t ou16_TimeDivision)
+{
+   double f64_ScaleTo1ms;
+
+   if (ou16_TimeDivision <= 0x7FFFu)
+   {
+      //ticks per beat -> assum 500ms per beat
+      f64_ScaleTo1ms = 500; //500ms
+      f64_ScaleTo1ms = f64_ScaleTo1ms / ou16_TimeDivision;
+   }
+   else
+   {
+      uint32_t u32_TicksPerFrame;
+      uint32_t u32_FramesPerSec;
+
+      u32_TicksPerFrame = ou16_TimeDivision & 0x00FFu;
+      u32_FramesPerSec = ((ou16_TimeDivision & 0x7F00u) >> 8);
+
+      f64_ScaleTo1ms = 1000; //1000ms
+      f64_ScaleTo1ms = (f64_ScaleTo1ms / u32_FramesPerSec) / u32_TicksPerFrame;
+   }
+   return f64_ScaleTo1ms;
+}
+
+uint16_t sound_get_note_frequency(const uint8_t ou8_Note)
+{
+   const double f64_C = 8.175798916;
+   double f64_Exp;
+   double f64_2Exp;
+   double f64_Frequency1Hz;
+
+   //calculate exponent (note/12)
+   f64_Exp = ou8_Note;
+   f64_Exp = f64_Exp / 12;
+   //power of 2
+   f64_2Exp = pow(2.0, f64_Exp);
+   //frequency
+   f64_Frequency1Hz = f64_C * f64_2Exp;
+   return (uint16_t)f64_Frequency1Hz;
+}
+
+/*
+   Stream conversion: note events are converted to signals as soon as they are passed (e.g. while
+   decoding block by block), no note event array is required. The signals are passed to opf_Sink
+   (e.g. a writer), or collected if opf_Sink is NULL (memory proportional to the output).
+*/
+T_SOUND_STREAM_HANDLE sound_stream_open(const uint16_t ou16_TimeDivision, const uint32_t ou32_MaxGapTicks, T_sound_sink opf_Sink,
+                                        void * const opv_Context)
+{
+   T_sound_stream_instance * pt_StreamInstance;
+
+   pt_StreamInstance = calloc(1, sizeof(T_sound_stream_instance));
+   pt_StreamInstance->pf_Sink = opf_Sink;
+   pt_StreamInstance->pv_Context = opv_Context;
+   pt_StreamInstance->u32_MaxGapTicks = ou32_MaxGapTicks;
+   pt_StreamInstance->f64_ScaleTicksToMs = sound_get_ms_per_tick(ou16_TimeDivision);
+   return pt_StreamInstance;
+}
+
+
+void sound_stream_close(T_SOUND_STREAM_HANDLE opv_Handle)
+{
+   T_sound_stream_instance * const pt_StreamInstance = (T_sound_stream_instance *)opv_Handle;
+
+   free(pt_StreamInstance->pat_SignalSequence);
+   free(pt_StreamInstance);
+}
+
+
+/*
+   An event is redundant (see midi_event_strip_redundant_note_events), if the subsequent
+   event has delta time 0, or if it is a note off followed by a note on within the max. gap.
+   Its delta time is carried over to the subsequent event.
+*/
+void sound_stream_add_note_events(T_SOUND_STREAM_HANDLE opv_Handle, const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents)
+{
+   T_sound_stream_instance * const pt_StreamInstance = (T_sound_stream_instance *)opv_Handle;
+   int32_t s32_Count;
+
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      uint32_t u32_Carry;
+
+      if (pt_StreamInstance->u8_HasPending == 0)
+      {
+         pt_StreamInstance->t_Pending = *opt_NoteEvents++;
+         pt_StreamInstance->u8_HasPending = 1;
+         continue;
+      }
+      u32_Carry = 0;
+      if ((opt_NoteEvents->u32_DeltaTime == 0) ||
+          ((pt_StreamInstance->t_Pending.u8_OnOff == 0) && (opt_NoteEvents->u8_OnOff != 0) &&
+           (opt_NoteEvents->u32_DeltaTime <= pt_StreamInstance->u32_MaxGapTicks)))
+      {
+         u32_Carry = pt_StreamInstance->t_Pending.u32_DeltaTime;
+      }
+      else
+      {
+         keep_event(pt_StreamInstance, &pt_StreamInstance->t_Pending);
+      }
+      pt_StreamInstance->t_Pending = *opt_NoteEvents++;
+      pt_StreamInstance->t_Pending.u32_DeltaTime += u32_Carry;
+   }
+}
+
+
+/*
+   End of the note events: the last event is kept in each case, the last signal switches off.
+   Returns the number of signals (including the terminating one, 0 if there was no note event).
+*/
+int32_t sound_stream_flush(T_SOUND_STREAM_HANDLE opv_Handle)
+{
+   T_sound_stream_instance * const pt_StreamInstance = (T_sound_stream_instance *)opv_Handle;
+
+   if (pt_StreamInstance->u8_HasPending != 0)
+   {
+      const T_sound_signal t_Off = { 0, 0 };
+
+      keep_event(pt_StreamInstance, &pt_StreamInstance->t_Pending);
+      if (pt_StreamInstance->u8_HasSignal != 0)
+      {
+         push_signal(pt_StreamInstance, &pt_StreamInstance->t_Signal);
+      }
+      push_signal(pt_StreamInstance, &t_Off);
+      pt_StreamInstance->u8_HasPending = 0;
+      pt_StreamInstance->u8_HasKept = 0;
+      pt_StreamInstance->u8_HasSignal = 0;
+   }
+   return pt_StreamInstance->s32_NumOfSignals;
+}
+
+
+//collected signals (no sink), valid until sound_stream_close
+int32_t sound_stream_get_signal_sequence(T_SOUND_STREAM_HANDLE opv_Handle, T_sound_signal ** oppt_SignalSequence)
+{
+   T_sound_stream_instance * const pt_StreamInstance = (T_sound_stream_instance *)opv_Handle;
+
+   *oppt_SignalSequence = pt_StreamInstance->pat_SignalSequence;
+   return pt_StreamInstance->s32_NumOfSignals;
+}
+
+
 void sound_print_signal_sequence(const int32_t os32_Length, const T_sound_signal * opt_SignalSequence)
 {
    int32_t s32_Count;
@@ -188,7 +330,6 @@ void sound_print_signal_sequence(const int32_t os32_Length, const T_sound_signal
 void sound_write_signal_sequence(const char * const opc_File, const int32_t os32_Length, const T_sound_signal * opt_SignalSequence)
 {
    FILE * pv_File;
-   int32_t s32_Count;
 
    //------------------------------------------------------------//
    // open file to write                                         //
@@ -198,20 +339,309 @@ void sound_write_signal_sequence(const char * const opc_File, const int32_t os32
    //------------------------------------------------------------//
    // write to file                                              //
    //------------------------------------------------------------//
-   fprintf(pv_File, "const uint16_t gau16_SoundSequence[] = { //2x16-bit value pair : Duration [1ms], Frequeny [1Hz]\n");
+   write_signal_sequence(pv_File, "gau16_SoundSequence", os32_Length, opt_SignalSequence);
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   fclose(pv_File);
+}
+
+
+/*
+   Several tables in one file (e.g. one per midi channel), each with its own symbol.
+*/
+void sound_write_signal_sequences(const char * const opc_File, const uint32_t ou32_NumOfSequences, const char * const * const opapc_Symbol,
+                                  const int32_t * const opas32_Length, const T_sound_signal * const * const opapt_SignalSequence)
+{
+   FILE * pv_File;
+   uint32_t u32_Sequence;
+
+   pv_File = fopen(opc_File, "w");
+   if (pv_File == NULL)
+   {
+      printf("[E] Cannot write %s!\n", opc_File);
+      return;
+   }
+   for (u32_Sequence = 0; u32_Sequence < ou32_NumOfSequences; ++u32_Sequence)
+   {
+      write_signal_sequence(pv_File, opapc_Symbol[u32_Sequence], opas32_Length[u32_Sequence], opapt_SignalSequence[u32_Sequence]);
+   }
+   fclose(pv_File);
+}
+
+
+/*
+   Binary image of the table written by sound_write_signal_sequence (including the additional
+   terminating signal): pairs of 16-bit duration and frequency, little endian.
+   opu8_Table must hold (os32_Length + 1) * 4 bytes. Returns the size [bytes].
+*/
+uint32_t sound_get_signal_table(const int32_t os32_Length, const T_sound_signal * opt_SignalSequence, uint8_t * const opu8_Table)
+{
+   uint8_t * pu8_Table;
+   int32_t s32_Count;
+
+   pu8_Table = opu8_Table;
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      *pu8_Table++ = (uint8_t)opt_SignalSequence->u16_Duration1ms;
+      *pu8_Table++ = (uint8_t)(opt_SignalSequence->u16_Duration1ms >> 8);
+      *pu8_Table++ = (uint8_t)opt_SignalSequence->u16_Frequency1Hz;
+      *pu8_Table++ = (uint8_t)(opt_SignalSequence->u16_Frequency1Hz >> 8);
+      ++opt_SignalSequence;
+   }
+   memset(pu8_Table, 0, 4);
+   pu8_Table += 4;
+   return (uint32_t)(pu8_Table - opu8_Table);
+}
+
+
+
+/*
+   Single pass, compacting the signals in place. Each signal costs a timer interrupt on
+   the target; a signal shorter than ou16_MinDuration1ms is removed and its duration is
+   added to a neighbour (according to oe_Absorb), so the total length stays the same.
+   Neighbours of equal frequency are combined afterwards. The terminating signal is kept.
+   A signal is only kept shorter than the minimum, if the song itself is shorter, or
+   if the neighbour's duration would exceed 16 bit.
+*/
+int32_t sound_filter_short_signals(const int32_t os32_Length, T_sound_signal * opt_SignalSequence, const uint16_t ou16_MinDuration1ms,
+                                   const T_sound_absorb oe_Absorb)
+{
+   T_sound_signal * pt_Write;
+   uint32_t u32_Carry;
+   int32_t s32_Count;
+   int32_t s32_Last;
+
+   //preconditional check
+   if (os32_Length <= 0)
+   {
+      return -1;
+   }
+
+   //for each signal (except the terminating one)
+   s32_Last = os32_Length - 1;
+   pt_Write = opt_SignalSequence;
+   u32_Carry = 0;
+   for (s32_Count = 0; s32_Count < s32_Last; ++s32_Count)
+   {
+      T_sound_signal * const pt_Previous = ((pt_Write > opt_SignalSequence) ? &pt_Write[-1] : NULL);
+      const T_sound_signal * const pt_Next = (((s32_Count + 1) < s32_Last) ? &opt_SignalSequence[s32_Count + 1] : NULL);
+      T_sound_signal t_Signal;
+      uint32_t u32_Duration1ms;
+
+      t_Signal = opt_SignalSequence[s32_Count];
+      u32_Duration1ms = t_Signal.u16_Duration1ms + u32_Carry;
+      u32_Carry = 0;
+
+      //short signal
+      if ((u32_Duration1ms < ou16_MinDuration1ms) && ((pt_Previous != NULL) || (pt_Next != NULL)))
+      {
+         uint8_t u8_ToPrevious;
+
+         switch (oe_Absorb)
+         {
+         case SOUND_ABSORB_NEXT:
+            u8_ToPrevious = ((pt_Next == NULL) ? 1 : 0);
+            break;
+
+         case SOUND_ABSORB_SOUNDING:
+            u8_ToPrevious = (((pt_Next == NULL) || ((pt_Previous != NULL) && ((pt_Previous->u16_Frequency1Hz != 0) || (pt_Next->u16_Frequency1Hz == 0)))) ? 1 : 0);
+            break;
+
+         case SOUND_ABSORB_PREVIOUS:
+         default:
+            u8_ToPrevious = ((pt_Previous != NULL) ? 1 : 0);
+            break;
+         }
+
+         if (u8_ToPrevious == 0)
+         {
+            //the subsequent signal is read after this one (in place is safe)
+            u32_Carry = u32_Duration1ms;
+            continue;
+         }
+         if ((pt_Previous->u16_Duration1ms + u32_Duration1ms) <= 0xFFFFu)
+         {
+            pt_Previous->u16_Duration1ms += (uint16_t)u32_Duration1ms;
+            continue;
+         }
+      }
+
+      //keep signal (combine with previous one of the same frequency)
+      if ((pt_Previous != NULL) && (pt_Previous->u16_Frequency1Hz == t_Signal.u16_Frequency1Hz) &&
+          ((pt_Previous->u16_Duration1ms + u32_Duration1ms) <= 0xFFFFu))
+      {
+         pt_Previous->u16_Duration1ms += (uint16_t)u32_Duration1ms;
+         continue;
+      }
+      while (u32_Duration1ms > 0xFFFFu)
+      {
+         //carried duration exceeds 16 bit
+         pt_Write->u16_Frequency1Hz = t_Signal.u16_Frequency1Hz;
+         pt_Write->u16_Duration1ms = 0xFFFFu;
+         u32_Duration1ms -= 0xFFFFu;
+         ++pt_Write;
+      }
+      pt_Write->u16_Frequency1Hz = t_Signal.u16_Frequency1Hz;
+      pt_Write->u16_Duration1ms = (uint16_t)u32_Duration1ms;
+      ++pt_Write;
+   }
+
+   //terminating signal
+   *pt_Write++ = opt_SignalSequence[s32_Last];
+
+   //return number of remaining signals
+   return (int32_t)(pt_Write - opt_SignalSequence);
+}
+
+
+void sound_get_interrupt_statistic(const int32_t os32_Length, const T_sound_signal * opt_SignalSequence,
+                                   T_sound_interrupt_statistic * const opt_Statistic)
+{
+   uint32_t u32_WindowStart1ms;
+   int32_t s32_WindowStart;
+   int32_t s32_Count;
+
+   opt_Statistic->u32_NumOfSignals = 0;
+   opt_Statistic->u32_Duration1ms = 0;
+   opt_Statistic->u16_MinDuration1ms = 0xFFFFu;
+   opt_Statistic->u32_MaxPerSecond = 0;
+
+   //for each signal (except the terminating one): count the signals, that start within one second from here on
+   u32_WindowStart1ms = 0;
+   s32_WindowStart = 0;
+   for (s32_Count = 0; s32_Count < (os32_Length - 1); ++s32_Count)
+   {
+      const uint16_t u16_Duration1ms = opt_SignalSequence[s32_Count].u16_Duration1ms;
+
+      //signals, that started more than a second before this one, leave the window
+      while ((opt_Statistic->u32_Duration1ms - u32_WindowStart1ms) >= 1000)
+      {
+         u32_WindowStart1ms += opt_SignalSequence[s32_WindowStart++].u16_Duration1ms;
+      }
+      if ((uint32_t)(s32_Count - s32_WindowStart + 1) > opt_Statistic->u32_MaxPerSecond)
+      {
+         opt_Statistic->u32_MaxPerSecond = (uint32_t)(s32_Count - s32_WindowStart + 1);
+      }
+
+      if (u16_Duration1ms < opt_Statistic->u16_MinDuration1ms)
+      {
+         opt_Statistic->u16_MinDuration1ms = u16_Duration1ms;
+      }
+      opt_Statistic->u32_Duration1ms += u16_Duration1ms;
+      ++opt_Statistic->u32_NumOfSignals;
+   }
+   if (opt_Statistic->u32_NumOfSignals == 0)
+   {
+      opt_Statistic->u16_MinDuration1ms = 0;
+   }
+}
+
+
+void sound_print_interrupt_statistic(const T_sound_interrupt_statistic * const opt_Statistic)
+{
+   printf("Interrupts\n");
+   printf("\tSignals: %d in %d ms\n", opt_Statistic->u32_NumOfSignals, opt_Statistic->u32_Duration1ms);
+   if (opt_Statistic->u16_MinDuration1ms > 0)
+   {
+      printf("\tShortest signal: %d ms (peak rate %.1f Hz)\n", opt_Statistic->u16_MinDuration1ms, 1000.0 / opt_Statistic->u16_MinDuration1ms);
+   }
+   else
+   {
+      printf("\tShortest signal: 0 ms (unbounded peak rate)\n");
+   }
+   printf("\tMax. per second: %d\n", opt_Statistic->u32_MaxPerSecond);
+}
+
+
+
+
+
+
+
+
+
+//the subsequent kept event defines the duration of the previous one
+static void keep_event(T_sound_stream_instance * const opt_StreamInstance, const T_midi_event_note * const opt_NoteEvent)
+{
+   if (opt_StreamInstance->u8_HasKept != 0)
+   {
+      add_signal(opt_StreamInstance, &opt_StreamInstance->t_Kept, opt_NoteEvent->u32_DeltaTime);
+   }
+   opt_StreamInstance->t_Kept = *opt_NoteEvent;
+   opt_StreamInstance->u8_HasKept = 1;
+}
+
+
+//see sound_get_signal_sequence
+static void add_signal(T_sound_stream_instance * const opt_StreamInstance, const T_midi_event_note * const opt_NoteEvent, const uint32_t ou32_DeltaTime)
+{
+   T_sound_signal t_Signal;
+   double f64_Duration1ms;
+
+   if (ou32_DeltaTime == 0)
+   {
+      return;
+   }
+   t_Signal.u16_Frequency1Hz = 0;
+   if (opt_NoteEvent->u8_OnOff != 0)
+   {
+      t_Signal.u16_Frequency1Hz = sound_get_note_frequency(opt_NoteEvent->u8_Note);
+   }
+   f64_Duration1ms = ou32_DeltaTime;
+   f64_Duration1ms = f64_Duration1ms * opt_StreamInstance->f64_ScaleTicksToMs;
+   t_Signal.u16_Duration1ms = (uint16_t)f64_Duration1ms;
+
+   //same frequency -> extend previous signal
+   if ((opt_StreamInstance->u8_HasSignal != 0) && (opt_StreamInstance->t_Signal.u16_Frequency1Hz == t_Signal.u16_Frequency1Hz))
+   {
+      opt_StreamInstance->t_Signal.u16_Duration1ms += t_Signal.u16_Duration1ms;
+      return;
+   }
+   if (opt_StreamInstance->u8_HasSignal != 0)
+   {
+      push_signal(opt_StreamInstance, &opt_StreamInstance->t_Signal);
+   }
+   opt_StreamInstance->t_Signal = t_Signal;
+   opt_StreamInstance->u8_HasSignal = 1;
+}
+
+
+static void push_signal(T_sound_stream_instance * const opt_StreamInstance, const T_sound_signal * const opt_Signal)
+{
+   if (opt_StreamInstance->pf_Sink != NULL)
+   {
+      opt_StreamInstance->pf_Sink(opt_Signal, opt_StreamInstance->pv_Context);
+   }
+   else
+   {
+      if (opt_StreamInstance->s32_NumOfSignals >= opt_StreamInstance->s32_MaxSignals)
+      {
+         opt_StreamInstance->s32_MaxSignals = ((opt_StreamInstance->s32_MaxSignals > 0) ? (2 * opt_StreamInstance->s32_MaxSignals) : 1024);
+         opt_StreamInstance->pat_SignalSequence = realloc(opt_StreamInstance->pat_SignalSequence,
+                                                          opt_StreamInstance->s32_MaxSignals * sizeof(T_sound_signal));
+      }
+      opt_StreamInstance->pat_SignalSequence[opt_StreamInstance->s32_NumOfSignals] = *opt_Signal;
+   }
+   ++opt_StreamInstance->s32_NumOfSignals;
+}
+
+
+static void write_signal_sequence(FILE * const opv_File, const char * const opc_Symbol, const int32_t os32_Length,
+                                  const T_sound_signal * opt_SignalSequence)
+{
+   int32_t s32_Count;
+
+   fprintf(opv_File, "const uint16_t %s[] = { //2x16-bit value pair : Duration [1ms], Frequeny [1Hz]\n", opc_Symbol);
    for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
    {
-      fprintf(pv_File, "  %d, %d, ", opt_SignalSequence->u16_Duration1ms, opt_SignalSequence->u16_Frequency1Hz);
+      fprintf(opv_File, "  %d, %d, ", opt_SignalSequence->u16_Duration1ms, opt_SignalSequence->u16_Frequency1Hz);
       if ((s32_Count % 8) == 7)
       {
-         fprintf(pv_File, "\n");
+         fprintf(opv_File, "\n");
       }
       ++opt_SignalSequence;
    }
-   fprintf(pv_File, " 0, 0\n};\n\n");
-
-   //------------------------------------------------------------//
-   // close file                                                 //
-   //------------------------------------------------------------//
-   fclose(pv_File);
+   fprintf(opv_File, " 0, 0\n};\n\n");
 }
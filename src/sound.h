@@ -25,6 +25,7 @@ extern "C" {
 
 /* -- Types --------------------------------------------------------------- */
 typedef void * T_SOUND_HANDLE;
+typedef void * T_SOUND_STREAM_HANDLE;
 
 
 typedef struct
@@ -34,6 +35,27 @@ typedef struct
 } T_sound_signal;
 
 
+typedef enum
+{
+   SOUND_ABSORB_PREVIOUS = 0,       //a short signal extends the previous signal
+   SOUND_ABSORB_NEXT,               //a short signal extends the subsequent signal
+   SOUND_ABSORB_SOUNDING            //a short signal extends the neighbour, that plays a note (previous one, if equal)
+} T_sound_absorb;
+
+
+typedef struct
+{
+   uint32_t u32_NumOfSignals;       //number of timer interrupts (excluding the terminating signal)
+   uint32_t u32_Duration1ms;        //total length
+   uint16_t u16_MinDuration1ms;     //shortest signal -> peak interrupt rate
+   uint32_t u32_MaxPerSecond;       //max. number of signals starting within any second
+} T_sound_interrupt_statistic;
+
+
+//receives the signals of a stream conversion one by one
+typedef void (*T_sound_sink)(const T_sound_signal * const opt_Signal, void * const opv_Context);
+
+
 /* -- Global Variables ---------------------------------------------------- */
 
 /* -- Function Prototypes ------------------------------------------------- */
@@ -43,7 +65,30 @@ extern void sound_close(T_SOUND_HANDLE opv_Handle);
 extern int32_t sound_get_signal_sequence(T_SOUND_HANDLE opv_Handle, T_sound_signal ** oppt_SignalSequence);
 extern void sound_print_signal_sequence(const int32_t os32_Length, const T_sound_signal * opt_SignalSequence);
 extern void sound_write_signal_sequence(const char * const opc_File, const int32_t os32_Length, const T_sound_signal * opt_SignalSequence);
+//one table per sequence, each named by its symbol
+extern void sound_write_signal_sequences(const char * const opc_File, const uint32_t ou32_NumOfSequences, const char * const * const opapc_Symbol,
+                                         const int32_t * const opas32_Length, const T_sound_signal * const * const opapt_SignalSequence);
+//binary image of the written table (little endian); opu8_Table: (os32_Length + 1) * 4 bytes
+extern uint32_t sound_get_signal_table(const int32_t os32_Length, const T_sound_signal * opt_SignalSequence, uint8_t * const opu8_Table);
+//absorb signals shorter than ou16_MinDuration1ms into their neighbours (in place, total length is preserved)
+extern int32_t sound_filter_short_signals(const int32_t os32_Length, T_sound_signal * opt_SignalSequence, const uint16_t ou16_MinDuration1ms,
+                                          const T_sound_absorb oe_Absorb);
+extern void sound_get_interrupt_statistic(const int32_t os32_Length, const T_sound_signal * opt_SignalSequence,
+                                          T_sound_interrupt_statistic * const opt_Statistic);
+extern void sound_print_interrupt_statistic(const T_sound_interrupt_statistic * const opt_Statistic);
 
+//single pass: redundant events are stripped and signals generated while the note events are passed
+//opf_Sink: NULL -> signals are collected (sound_stream_get_signal_sequence)
+extern T_SOUND_STREAM_HANDLE sound_stream_open(const uint16_t ou16_TimeDivision, const uint32_t ou32_MaxGapTicks, T_sound_sink opf_Sink,
+                                               void * const opv_Context);
+extern void sound_stream_close(T_SOUND_STREAM_HANDLE opv_Handle);
+extern void sound_stream_add_note_events(T_SOUND_STREAM_HANDLE opv_Handle, const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents);
+extern int32_t sound_stream_flush(T_SOUND_STREAM_HANDLE opv_Handle);
+extern int32_t sound_stream_get_signal_sequence(T_SOUND_STREAM_HANDLE opv_Handle, T_sound_signal ** oppt_SignalSequence);
+
+extern double sound_get_ms_per_tick(const uint16_t ou16_TimeDivision);
+extern uint16_t sound_get_note_frequency(const uint8_t ou8_Note);
+
 /* -- Implementation ------------------------------------------------------ */
 
 
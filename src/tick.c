@@ -0,0 +1,282 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     tick.c
+   \brief    Functions to generate tempo independent sound sequences (durations in ticks)
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "sound.h"
+#include "tick.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define TICK_MAX_DURATION           (0xFFFFu)     //16 bit per signal, longer signals are split
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   uint16_t u16_TicksPerBeat;
+   uint8_t u8_Smpte;                   //ticks per second instead of per beat -> no tempo changes
+   T_midi_event_tempo * pat_Tempo;     //sorted by time
+   uint32_t u32_NumOfTempos;
+   uint32_t u32_StartTick;             //absolute time of the first signal
+   uint32_t u32_DurationTicks;
+   T_tick_signal * pat_SignalSequence;
+} T_tick_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static uint32_t get_tempo(const T_tick_instance * const opt_TickInstance, const uint32_t ou32_Tick);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_TICK_HANDLE tick_open(const uint16_t ou16_TimeDivision)
+{
+   T_tick_instance * pt_TickInstance;
+
+   pt_TickInstance = calloc(1, sizeof(T_tick_instance));
+   if (ou16_TimeDivision <= 0x7FFFu)
+   {
+      pt_TickInstance->u16_TicksPerBeat = ou16_TimeDivision;
+   }
+   else
+   {
+      //frames per second * ticks per frame, one "beat" per second
+      pt_TickInstance->u16_TicksPerBeat = (uint16_t)(((ou16_TimeDivision & 0x7F00u) >> 8) * (ou16_TimeDivision & 0x00FFu));
+      pt_TickInstance->u8_Smpte = 1;
+   }
+   return pt_TickInstance;
+}
+
+
+void tick_close(T_TICK_HANDLE opv_Handle)
+{
+   T_tick_instance * const pt_TickInstance = (T_tick_instance *)opv_Handle;
+
+   free(pt_TickInstance->pat_SignalSequence);
+   free(pt_TickInstance->pat_Tempo);
+   free(pt_TickInstance);
+}
+
+
+void tick_add_tempo_map(T_TICK_HANDLE opv_Handle, const uint32_t ou32_NumOfTempos, const T_midi_event_tempo * const opat_Tempo)
+{
+   T_tick_instance * const pt_TickInstance = (T_tick_instance *)opv_Handle;
+   uint32_t u32_Tempo;
+
+   if ((pt_TickInstance->u8_Smpte != 0) || (ou32_NumOfTempos == 0))
+   {
+      return;
+   }
+   pt_TickInstance->pat_Tempo = realloc(pt_TickInstance->pat_Tempo, (pt_TickInstance->u32_NumOfTempos + ou32_NumOfTempos) * sizeof(T_midi_event_tempo));
+   //insertion into the sorted list (a later track wins at the same time)
+   for (u32_Tempo = 0; u32_Tempo < ou32_NumOfTempos; ++u32_Tempo)
+   {
+      uint32_t u32_Index = pt_TickInstance->u32_NumOfTempos;
+
+      while ((u32_Index > 0) && (pt_TickInstance->pat_Tempo[u32_Index - 1].u32_Tick > opat_Tempo[u32_Tempo].u32_Tick))
+      {
+         pt_TickInstance->pat_Tempo[u32_Index] = pt_TickInstance->pat_Tempo[u32_Index - 1];
+         --u32_Index;
+      }
+      pt_TickInstance->pat_Tempo[u32_Index] = opat_Tempo[u32_Tempo];
+      ++pt_TickInstance->u32_NumOfTempos;
+   }
+}
+
+
+/*
+   As sound_get_signal_sequence, but the durations are kept in ticks (no scaling, no truncation).
+   The last note event has no subsequent event, so it doesn't produce a signal.
+*/
+int32_t tick_get_signal_sequence(T_TICK_HANDLE opv_Handle, const uint32_t ou32_StartTick, const int32_t os32_Length,
+                                 const T_midi_event_note * opt_NoteEvents, T_tick_signal ** oppt_SignalSequence)
+{
+   T_tick_instance * const pt_TickInstance = (T_tick_instance *)opv_Handle;
+   T_tick_signal * pt_SignalSequence;
+   int32_t s32_Signal;
+   int32_t s32_Count;
+
+   //preconditional check
+   if (os32_Length <= 0)
+   {
+      return 0;
+   }
+
+   //the sequence starts with the first note event
+   free(pt_TickInstance->pat_SignalSequence);
+   pt_TickInstance->pat_SignalSequence = malloc((os32_Length + 1) * sizeof(T_tick_signal));
+   pt_TickInstance->u32_StartTick = ou32_StartTick + opt_NoteEvents[0].u32_DeltaTime;
+   pt_TickInstance->u32_DurationTicks = 0;
+   *oppt_SignalSequence = pt_TickInstance->pat_SignalSequence;
+   pt_SignalSequence = pt_TickInstance->pat_SignalSequence;
+   s32_Signal = 0;
+   for (s32_Count = 0; (s32_Count + 1) < os32_Length; ++s32_Count)
+   {
+      const uint32_t u32_DeltaTime = opt_NoteEvents[s32_Count + 1].u32_DeltaTime;
+      uint16_t u16_Frequency1Hz;
+
+      if (u32_DeltaTime == 0)
+      {
+         continue;
+      }
+      u16_Frequency1Hz = ((opt_NoteEvents[s32_Count].u8_OnOff != 0) ? sound_get_note_frequency(opt_NoteEvents[s32_Count].u8_Note) : 0);
+      pt_TickInstance->u32_DurationTicks += u32_DeltaTime;
+      //same frequency -> extend previous signal
+      if ((s32_Signal > 0) && (pt_SignalSequence[-1].u16_Frequency1Hz == u16_Frequency1Hz))
+      {
+         pt_SignalSequence[-1].u32_DurationTicks += u32_DeltaTime;
+         continue;
+      }
+      pt_SignalSequence->u32_DurationTicks = u32_DeltaTime;
+      pt_SignalSequence->u16_Frequency1Hz = u16_Frequency1Hz;
+      ++pt_SignalSequence;
+      ++s32_Signal;
+   }
+
+   //the last signal switches off
+   pt_SignalSequence->u32_DurationTicks = 0;
+   pt_SignalSequence->u16_Frequency1Hz = 0;
+   return s32_Signal + 1;
+}
+
+
+void tick_print_statistic(T_TICK_HANDLE opv_Handle)
+{
+   const T_tick_instance * const pt_TickInstance = (const T_tick_instance *)opv_Handle;
+   double f64_Duration1ms;
+   uint32_t u32_Tick;
+   uint32_t u32_Tempo;
+
+   //exact duration at the original tempo (piecewise constant between the tempo changes)
+   f64_Duration1ms = 0;
+   u32_Tick = pt_TickInstance->u32_StartTick;
+   for (u32_Tempo = 0; u32_Tempo <= pt_TickInstance->u32_NumOfTempos; ++u32_Tempo)
+   {
+      const uint32_t u32_EndTick = pt_TickInstance->u32_StartTick + pt_TickInstance->u32_DurationTicks;
+      uint32_t u32_NextTick;
+
+      u32_NextTick = ((u32_Tempo < pt_TickInstance->u32_NumOfTempos) ? pt_TickInstance->pat_Tempo[u32_Tempo].u32_Tick : UINT32_MAX);
+      if (u32_NextTick <= u32_Tick)
+      {
+         continue;
+      }
+      if (u32_NextTick > u32_EndTick)
+      {
+         u32_NextTick = u32_EndTick;
+      }
+      f64_Duration1ms += ((double)(u32_NextTick - u32_Tick) * get_tempo(pt_TickInstance, u32_Tick)) / (1000.0 * pt_TickInstance->u16_TicksPerBeat);
+      u32_Tick = u32_NextTick;
+      if (u32_Tick >= u32_EndTick)
+      {
+         break;
+      }
+   }
+   printf("Ticks\n");
+   printf("\tTicks per beat: %d%s\n", pt_TickInstance->u16_TicksPerBeat, (pt_TickInstance->u8_Smpte != 0) ? " (SMPTE, 1 beat = 1 s)" : "");
+   printf("\tTempo changes: %d\n", pt_TickInstance->u32_NumOfTempos);
+   printf("\tDuration: %d ticks, %.1f ms at original tempo\n", pt_TickInstance->u32_DurationTicks, f64_Duration1ms);
+}
+
+
+void tick_write_signal_sequence(const char * const opc_File, T_TICK_HANDLE opv_Handle, const int32_t os32_Length,
+                                const T_tick_signal * opt_SignalSequence)
+{
+   const T_tick_instance * const pt_TickInstance = (const T_tick_instance *)opv_Handle;
+   FILE * pv_File;
+   int32_t s32_Count;
+   int32_t s32_Column;
+   uint32_t u32_Tempo;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = fopen(opc_File, "w");
+
+   //------------------------------------------------------------//
+   // write tempo map (relative to the first signal)             //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint16_t gu16_SoundTicksPerBeat = %d;\n\n", pt_TickInstance->u16_TicksPerBeat);
+   fprintf(pv_File, "const uint32_t gau32_SoundTempoMap[] = { //2x32-bit value pair : Tick, Tempo [1us per beat]\n");
+   fprintf(pv_File, "  0, %d, ", get_tempo(pt_TickInstance, pt_TickInstance->u32_StartTick));
+   for (u32_Tempo = 0; u32_Tempo < pt_TickInstance->u32_NumOfTempos; ++u32_Tempo)
+   {
+      const T_midi_event_tempo * const pt_Tempo = &pt_TickInstance->pat_Tempo[u32_Tempo];
+
+      if ((pt_Tempo->u32_Tick > pt_TickInstance->u32_StartTick) &&
+          (pt_Tempo->u32_Tick < (pt_TickInstance->u32_StartTick + pt_TickInstance->u32_DurationTicks)))
+      {
+         fprintf(pv_File, "  %d, %d, ", pt_Tempo->u32_Tick - pt_TickInstance->u32_StartTick, pt_Tempo->u32_TempoUs);
+      }
+   }
+   fprintf(pv_File, " 0xFFFFFFFF, 0\n};\n\n");
+
+   //------------------------------------------------------------//
+   // write signals                                              //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint16_t gau16_SoundTickSequence[] = { //2x16-bit value pair : Duration [ticks], Frequeny [1Hz]\n");
+   s32_Column = 0;
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      uint32_t u32_Duration = opt_SignalSequence->u32_DurationTicks;
+
+      //the terminating signal is written below
+      if (u32_Duration == 0)
+      {
+         break;
+      }
+      //long signals are split (same frequency)
+      while (u32_Duration > 0)
+      {
+         const uint32_t u32_Part = ((u32_Duration > TICK_MAX_DURATION) ? TICK_MAX_DURATION : u32_Duration);
+
+         fprintf(pv_File, "  %d, %d, ", u32_Part, opt_SignalSequence->u16_Frequency1Hz);
+         if ((s32_Column % 8) == 7)
+         {
+            fprintf(pv_File, "\n");
+         }
+         ++s32_Column;
+         u32_Duration -= u32_Part;
+      }
+      ++opt_SignalSequence;
+   }
+   fprintf(pv_File, " 0, 0\n};\n\n");
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   fclose(pv_File);
+}
+
+
+
+
+
+
+
+
+
+//tempo at the given time (the last change at or before it)
+static uint32_t get_tempo(const T_tick_instance * const opt_TickInstance, const uint32_t ou32_Tick)
+{
+   uint32_t u32_TempoUs;
+   uint32_t u32_Tempo;
+
+   u32_TempoUs = ((opt_TickInstance->u8_Smpte != 0) ? 1000000u : TICK_DEFAULT_TEMPO_US);
+   for (u32_Tempo = 0; (u32_Tempo < opt_TickInstance->u32_NumOfTempos) && (opt_TickInstance->pat_Tempo[u32_Tempo].u32_Tick <= ou32_Tick); ++u32_Tempo)
+   {
+      u32_TempoUs = opt_TickInstance->pat_Tempo[u32_Tempo].u32_TempoUs;
+   }
+   return u32_TempoUs;
+}
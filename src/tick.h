@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     tick.h
+   \brief    Functions to generate tempo independent sound sequences (durations in ticks)
+
+   The durations of the signals are kept in midi ticks and the tempo map of the
+   song is written alongside, so the target converts ticks to timer periods at
+   run time (with any speed factor, see target/tick_player.c). There is no
+   truncation per signal, so the timing doesn't drift.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _TICK_H
+#define _TICK_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "midi_event.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define TICK_DEFAULT_TEMPO_US       (500000u)   //120 beats per minute, if the song doesn't set a tempo
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_TICK_HANDLE;
+
+
+typedef struct
+{
+   uint32_t u32_DurationTicks;
+   uint16_t u16_Frequency1Hz;
+} T_tick_signal;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+extern T_TICK_HANDLE tick_open(const uint16_t ou16_TimeDivision);
+extern void tick_close(T_TICK_HANDLE opv_Handle);
+
+//tempo changes of a track (all tracks share one tempo map)
+extern void tick_add_tempo_map(T_TICK_HANDLE opv_Handle, const uint32_t ou32_NumOfTempos, const T_midi_event_tempo * const opat_Tempo);
+//note events (stripped); ou32_StartTick: absolute time, the delta time of the first event refers to
+//returns number of signals (including the terminating one)
+extern int32_t tick_get_signal_sequence(T_TICK_HANDLE opv_Handle, const uint32_t ou32_StartTick, const int32_t os32_Length,
+                                        const T_midi_event_note * opt_NoteEvents, T_tick_signal ** oppt_SignalSequence);
+extern void tick_print_statistic(T_TICK_HANDLE opv_Handle);
+extern void tick_write_signal_sequence(const char * const opc_File, T_TICK_HANDLE opv_Handle, const int32_t os32_Length,
+                                       const T_tick_signal * opt_SignalSequence);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
@@ -0,0 +1,209 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     timer.c
+   \brief    Functions to convert frequencies into timer reload values of a target
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "timer.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define TIMER_MAX_COUNTS            (0x10000uL)   //16 bit auto-reload register
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   uint32_t u32_Clock1Hz;
+   uint32_t au32_Prescaler[TIMER_MAX_PRESCALERS];
+   uint32_t u32_NumOfPrescalers;
+} T_timer_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_TIMER_HANDLE timer_open(const uint32_t ou32_Clock1Hz, const char * const opc_Prescalers)
+{
+   T_timer_instance * pt_TimerInstance;
+   const char * pc_List;
+
+   //preconditional check
+   if (ou32_Clock1Hz == 0)
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // allocate timer instance                                    //
+   //------------------------------------------------------------//
+   pt_TimerInstance = calloc(1, sizeof(T_timer_instance));
+   pt_TimerInstance->u32_Clock1Hz = ou32_Clock1Hz;
+
+   //------------------------------------------------------------//
+   // parse prescalers (default: no prescaler)                   //
+   //------------------------------------------------------------//
+   pc_List = ((opc_Prescalers != NULL) ? opc_Prescalers : "1");
+   while (*pc_List != 0)
+   {
+      char * pc_End;
+      const long s32_Prescaler = strtol(pc_List, &pc_End, 10);
+
+      //invalid value or too many prescalers
+      if ((pc_End == pc_List) || (s32_Prescaler <= 0) || (pt_TimerInstance->u32_NumOfPrescalers >= TIMER_MAX_PRESCALERS))
+      {
+         free(pt_TimerInstance);
+         return 0;
+      }
+      pt_TimerInstance->au32_Prescaler[pt_TimerInstance->u32_NumOfPrescalers++] = (uint32_t)s32_Prescaler;
+      pc_List = ((*pc_End == ',') ? &pc_End[1] : pc_End);
+   }
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return timer instance handle
+   return pt_TimerInstance;
+}
+
+
+void timer_close(T_TIMER_HANDLE opv_Handle)
+{
+   //release instance
+   free(opv_Handle);
+}
+
+
+/*
+   The prescaler with the smallest pitch error wins; on equal error, the first one of the list.
+   Frequencies below the range of the largest prescaler are clamped to the max. reload value.
+*/
+void timer_get_reload(T_TIMER_HANDLE opv_Handle, const uint16_t ou16_Frequency1Hz, T_timer_reload * const opt_Reload)
+{
+   T_timer_instance * const pt_TimerInstance = (T_timer_instance *)opv_Handle;
+   uint32_t u32_Prescaler;
+
+   //rest -> timer off
+   memset(opt_Reload, 0, sizeof(T_timer_reload));
+   if (ou16_Frequency1Hz == 0)
+   {
+      return;
+   }
+   opt_Reload->f64_Error1Cent = HUGE_VAL;
+   for (u32_Prescaler = 0; u32_Prescaler < pt_TimerInstance->u32_NumOfPrescalers; ++u32_Prescaler)
+   {
+      const double f64_Input1Hz = (double)pt_TimerInstance->u32_Clock1Hz / pt_TimerInstance->au32_Prescaler[u32_Prescaler];
+      double f64_Counts;
+      double f64_Frequency1Hz;
+      double f64_Error1Cent;
+
+      //counts per period, rounded and limited to the auto-reload register
+      f64_Counts = floor((f64_Input1Hz / ou16_Frequency1Hz) + 0.5);
+      f64_Counts = ((f64_Counts < 2.0) ? 2.0 : ((f64_Counts > TIMER_MAX_COUNTS) ? TIMER_MAX_COUNTS : f64_Counts));
+      f64_Frequency1Hz = f64_Input1Hz / f64_Counts;
+      f64_Error1Cent = 1200.0 * log2(f64_Frequency1Hz / ou16_Frequency1Hz);
+      if (fabs(f64_Error1Cent) < fabs(opt_Reload->f64_Error1Cent))
+      {
+         opt_Reload->u8_Prescaler = (uint8_t)u32_Prescaler;
+         opt_Reload->u16_Reload = (uint16_t)(f64_Counts - 1.0);
+         opt_Reload->f64_Frequency1Hz = f64_Frequency1Hz;
+         opt_Reload->f64_Error1Cent = f64_Error1Cent;
+      }
+   }
+}
+
+
+void timer_print_error(T_TIMER_HANDLE opv_Handle, const int32_t os32_Length, const T_sound_signal * opt_SignalSequence)
+{
+   T_timer_instance * const pt_TimerInstance = (T_timer_instance *)opv_Handle;
+   uint8_t au8_Printed[0x10000 / 8];
+   double f64_MaxError1Cent;
+   int32_t s32_Count;
+
+   memset(au8_Printed, 0, sizeof(au8_Printed));
+   f64_MaxError1Cent = 0.0;
+   printf("Timer clock %d Hz\n", pt_TimerInstance->u32_Clock1Hz);
+   printf("\tFrequency [1Hz], Prescaler, Reload, Output [1Hz], Error [cent]\n");
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      const uint16_t u16_Frequency1Hz = opt_SignalSequence[s32_Count].u16_Frequency1Hz;
+      T_timer_reload t_Reload;
+
+      //each frequency once
+      if ((u16_Frequency1Hz == 0) || ((au8_Printed[u16_Frequency1Hz >> 3] & (1u << (u16_Frequency1Hz & 7u))) != 0))
+      {
+         continue;
+      }
+      au8_Printed[u16_Frequency1Hz >> 3] |= (uint8_t)(1u << (u16_Frequency1Hz & 7u));
+      timer_get_reload(opv_Handle, u16_Frequency1Hz, &t_Reload);
+      printf("\t%d, %d, %d, %.2f, %+.2f\n", u16_Frequency1Hz, pt_TimerInstance->au32_Prescaler[t_Reload.u8_Prescaler],
+             t_Reload.u16_Reload, t_Reload.f64_Frequency1Hz, t_Reload.f64_Error1Cent);
+      if (fabs(t_Reload.f64_Error1Cent) > fabs(f64_MaxError1Cent))
+      {
+         f64_MaxError1Cent = t_Reload.f64_Error1Cent;
+      }
+   }
+   printf("\tMax. error: %+.2f cent\n", f64_MaxError1Cent);
+}
+
+
+void timer_write_signal_sequence(const char * const opc_File, T_TIMER_HANDLE opv_Handle, const int32_t os32_Length,
+                                 const T_sound_signal * opt_SignalSequence)
+{
+   T_timer_instance * const pt_TimerInstance = (T_timer_instance *)opv_Handle;
+   FILE * pv_File;
+   int32_t s32_Count;
+   uint32_t u32_Prescaler;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = fopen(opc_File, "w");
+
+   //------------------------------------------------------------//
+   // write prescalers to file                                   //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint32_t gu32_SoundTimerClock = %d; //[1Hz]\n\n", pt_TimerInstance->u32_Clock1Hz);
+   fprintf(pv_File, "const uint32_t gau32_SoundTimerPrescaler[] = {");
+   for (u32_Prescaler = 0; u32_Prescaler < pt_TimerInstance->u32_NumOfPrescalers; ++u32_Prescaler)
+   {
+      fprintf(pv_File, " %d,", pt_TimerInstance->au32_Prescaler[u32_Prescaler]);
+   }
+   fprintf(pv_File, " };\n\n");
+
+   //------------------------------------------------------------//
+   // write to file                                              //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint16_t gau16_SoundTimerSequence[] = { //3x16-bit value triple : Duration [1ms], Prescaler index, Auto-reload value (0: off)\n");
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      T_timer_reload t_Reload;
+
+      timer_get_reload(opv_Handle, opt_SignalSequence->u16_Frequency1Hz, &t_Reload);
+      fprintf(pv_File, "  %d, %d, %d, ", opt_SignalSequence->u16_Duration1ms, t_Reload.u8_Prescaler, t_Reload.u16_Reload);
+      if ((s32_Count % 8) == 7)
+      {
+         fprintf(pv_File, "\n");
+      }
+      ++opt_SignalSequence;
+   }
+   fprintf(pv_File, " 0, 0, 0\n};\n\n");
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   fclose(pv_File);
+}
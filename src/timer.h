@@ -0,0 +1,65 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     timer.h
+   \brief    Functions to convert frequencies into timer reload values of a target
+
+   For each frequency, the prescaler and the auto-reload value (16 bit), whose
+   output frequency is closest to the requested one, are selected:
+      output frequency = clock / (prescaler * (reload + 1))
+   So the target doesn't have to divide the timer clock by the frequency.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _TIMER_H
+#define _TIMER_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "sound.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define TIMER_MAX_PRESCALERS        (16)
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_TIMER_HANDLE;
+
+
+typedef struct
+{
+   uint8_t u8_Prescaler;            //index into the list of prescalers
+   uint16_t u16_Reload;             //auto-reload value (0: off)
+   double f64_Frequency1Hz;         //output frequency
+   double f64_Error1Cent;           //pitch error (output vs. requested frequency)
+} T_timer_reload;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//opc_Prescalers: comma separated list (max. TIMER_MAX_PRESCALERS), e.g. "1,8,64"; returns 0 if the list is invalid
+extern T_TIMER_HANDLE timer_open(const uint32_t ou32_Clock1Hz, const char * const opc_Prescalers);
+extern void timer_close(T_TIMER_HANDLE opv_Handle);
+
+extern void timer_get_reload(T_TIMER_HANDLE opv_Handle, const uint16_t ou16_Frequency1Hz, T_timer_reload * const opt_Reload);
+//pitch error of each frequency of the sequence
+extern void timer_print_error(T_TIMER_HANDLE opv_Handle, const int32_t os32_Length, const T_sound_signal * opt_SignalSequence);
+extern void timer_write_signal_sequence(const char * const opc_File, T_TIMER_HANDLE opv_Handle, const int32_t os32_Length,
+                                        const T_sound_signal * opt_SignalSequence);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
@@ -0,0 +1,508 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     voice.c
+   \brief    Functions to distribute note events onto several voices (polyphony)
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "voice.h"
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   uint32_t u32_Duration1ms;           //not limited to 16 bit, clamped by emit_signal_sequence
+   uint16_t u16_Frequency1Hz;
+} T_voice_signal;
+
+
+typedef struct
+{
+   //currently played note
+   uint8_t u8_Active;
+   uint8_t u8_Channel;
+   uint8_t u8_Note;
+   uint8_t u8_Velocity;
+   uint8_t u8_Priority;
+   uint32_t u32_StartTick;
+   //currently open segment
+   uint32_t u32_SegmentTick;
+   uint16_t u16_SegmentFrequency1Hz;
+   //signal sequence of this voice
+   T_voice_signal * pat_Signal;
+   T_sound_signal * pat_SignalSequence;   //pat_Signal, as emitted
+   int32_t s32_Length;
+} T_voice_state;
+
+
+typedef struct
+{
+   uint8_t u8_NumOfVoices;
+   T_voice_state at_Voice[VOICE_MAX_VOICES];
+   T_voice_change * pat_ChangeSequence;
+   int32_t s32_ChangeLength;
+   double f64_ScaleTicksToMs;
+   uint32_t u32_NumOfNotes;
+   uint32_t u32_NumOfStolen;
+   uint32_t u32_NumOfDropped;
+} T_voice_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void allocate(T_voice_instance * const opt_VoiceInstance, const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents,
+                     const T_voice_steal oe_Steal, const uint8_t * const opau8_ChannelPriority);
+static T_voice_state * get_voice(T_voice_instance * const opt_VoiceInstance, const T_midi_event_note * const opt_NoteEvent,
+                                 const uint8_t ou8_Priority, const T_voice_steal oe_Steal);
+static void set_frequency(T_voice_instance * const opt_VoiceInstance, T_voice_state * const opt_Voice, const uint32_t ou32_Tick, const uint16_t ou16_Frequency1Hz);
+static void merge(T_voice_instance * const opt_VoiceInstance, const uint32_t ou32_EndTick);
+static void emit_signal_sequence(T_voice_state * const opt_Voice);
+static uint16_t clamp_ms(const uint32_t ou32_Duration1ms);
+static uint32_t get_ms(const T_voice_instance * const opt_VoiceInstance, const uint32_t ou32_Tick);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+T_VOICE_HANDLE voice_open(const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents, const uint16_t ou16_TimeDivision,
+                          const uint8_t ou8_NumOfVoices, const T_voice_steal oe_Steal, const uint8_t * const opau8_ChannelPriority)
+{
+   T_voice_instance * pt_VoiceInstance;
+   uint8_t u8_Voice;
+
+   //preconditional check
+   if ((os32_Length <= 0) || (ou8_NumOfVoices == 0) || (ou8_NumOfVoices > VOICE_MAX_VOICES))
+   {
+      return 0;
+   }
+
+   //------------------------------------------------------------//
+   // allocate voice instance and buffers                        //
+   //------------------------------------------------------------//
+   pt_VoiceInstance = calloc(1, sizeof(T_voice_instance));
+   pt_VoiceInstance->u8_NumOfVoices = ou8_NumOfVoices;
+   pt_VoiceInstance->f64_ScaleTicksToMs = sound_get_ms_per_tick(ou16_TimeDivision);
+   //each note event changes one voice -> at most one segment per event (plus the initial one)
+   for (u8_Voice = 0; u8_Voice < ou8_NumOfVoices; ++u8_Voice)
+   {
+      pt_VoiceInstance->at_Voice[u8_Voice].pat_Signal = malloc((os32_Length + 1) * sizeof(T_voice_signal));
+      pt_VoiceInstance->at_Voice[u8_Voice].pat_SignalSequence = malloc((os32_Length + 1) * sizeof(T_sound_signal));
+   }
+   pt_VoiceInstance->pat_ChangeSequence = malloc(((ou8_NumOfVoices * (os32_Length + 1)) + 1) * sizeof(T_voice_change));
+
+   //------------------------------------------------------------//
+   // distribute notes onto voices                               //
+   //------------------------------------------------------------//
+   allocate(pt_VoiceInstance, os32_Length, opt_NoteEvents, oe_Steal, opau8_ChannelPriority);
+
+   //------------------------------------------------------------//
+   // finalize                                                   //
+   //------------------------------------------------------------//
+   //return voice instance handle
+   return pt_VoiceInstance;
+}
+
+
+void voice_close(T_VOICE_HANDLE opv_Handle)
+{
+   T_voice_instance * const pt_VoiceInstance = (T_voice_instance *)opv_Handle;
+   uint8_t u8_Voice;
+
+   //release signal sequences, change sequence and instance itself
+   for (u8_Voice = 0; u8_Voice < pt_VoiceInstance->u8_NumOfVoices; ++u8_Voice)
+   {
+      free(pt_VoiceInstance->at_Voice[u8_Voice].pat_Signal);
+      free(pt_VoiceInstance->at_Voice[u8_Voice].pat_SignalSequence);
+   }
+   free(pt_VoiceInstance->pat_ChangeSequence);
+   free(pt_VoiceInstance);
+}
+
+
+int32_t voice_get_signal_sequence(T_VOICE_HANDLE opv_Handle, const uint8_t ou8_Voice, const T_sound_signal ** oppt_SignalSequence)
+{
+   T_voice_instance * const pt_VoiceInstance = (T_voice_instance *)opv_Handle;
+
+   //preconditional check
+   if (ou8_Voice >= pt_VoiceInstance->u8_NumOfVoices)
+   {
+      return -1;
+   }
+
+   *oppt_SignalSequence = pt_VoiceInstance->at_Voice[ou8_Voice].pat_SignalSequence;
+   return pt_VoiceInstance->at_Voice[ou8_Voice].s32_Length;
+}
+
+
+int32_t voice_get_change_sequence(T_VOICE_HANDLE opv_Handle, const T_voice_change ** oppt_ChangeSequence)
+{
+   T_voice_instance * const pt_VoiceInstance = (T_voice_instance *)opv_Handle;
+
+   *oppt_ChangeSequence = pt_VoiceInstance->pat_ChangeSequence;
+   return pt_VoiceInstance->s32_ChangeLength;
+}
+
+
+void voice_print_statistic(T_VOICE_HANDLE opv_Handle)
+{
+   T_voice_instance * const pt_VoiceInstance = (T_voice_instance *)opv_Handle;
+   uint8_t u8_Voice;
+
+   printf("Voices: %d\n", pt_VoiceInstance->u8_NumOfVoices);
+   printf("\tNotes: %d\n", pt_VoiceInstance->u32_NumOfNotes);
+   printf("\tStolen: %d\n", pt_VoiceInstance->u32_NumOfStolen);
+   printf("\tDropped: %d\n", pt_VoiceInstance->u32_NumOfDropped);
+   for (u8_Voice = 0; u8_Voice < pt_VoiceInstance->u8_NumOfVoices; ++u8_Voice)
+   {
+      printf("\tVoice %d: %d signals\n", u8_Voice, pt_VoiceInstance->at_Voice[u8_Voice].s32_Length);
+   }
+   printf("\tChanges: %d\n", pt_VoiceInstance->s32_ChangeLength);
+}
+
+
+void voice_write_signal_sequences(const char * const opc_File, T_VOICE_HANDLE opv_Handle)
+{
+   T_voice_instance * const pt_VoiceInstance = (T_voice_instance *)opv_Handle;
+   FILE * pv_File;
+   uint8_t u8_Voice;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = fopen(opc_File, "w");
+
+   //------------------------------------------------------------//
+   // write to file (one table per voice)                        //
+   //------------------------------------------------------------//
+   for (u8_Voice = 0; u8_Voice < pt_VoiceInstance->u8_NumOfVoices; ++u8_Voice)
+   {
+      const T_voice_state * const pt_Voice = &pt_VoiceInstance->at_Voice[u8_Voice];
+      const T_sound_signal * pt_Signal;
+      int32_t s32_Count;
+
+      fprintf(pv_File, "const uint16_t gau16_SoundSequenceVoice%d[] = { //2x16-bit value pair : Duration [1ms], Frequeny [1Hz]\n", u8_Voice);
+      pt_Signal = pt_Voice->pat_SignalSequence;
+      for (s32_Count = 0; s32_Count < pt_Voice->s32_Length; ++s32_Count)
+      {
+         fprintf(pv_File, "  %d, %d, ", pt_Signal->u16_Duration1ms, pt_Signal->u16_Frequency1Hz);
+         if ((s32_Count % 8) == 7)
+         {
+            fprintf(pv_File, "\n");
+         }
+         ++pt_Signal;
+      }
+      fprintf(pv_File, " 0, 0\n};\n\n");
+   }
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   fclose(pv_File);
+}
+
+
+void voice_write_change_sequence(const char * const opc_File, T_VOICE_HANDLE opv_Handle)
+{
+   T_voice_instance * const pt_VoiceInstance = (T_voice_instance *)opv_Handle;
+   const T_voice_change * pt_Change;
+   FILE * pv_File;
+   int32_t s32_Count;
+
+   //------------------------------------------------------------//
+   // open file to write                                         //
+   //------------------------------------------------------------//
+   pv_File = fopen(opc_File, "w");
+
+   //------------------------------------------------------------//
+   // write to file                                              //
+   //------------------------------------------------------------//
+   fprintf(pv_File, "const uint16_t gau16_SoundVoiceChanges[] = { //3x16-bit value triple : Delay [1ms], Voice (%d = end), Frequeny [1Hz]\n", VOICE_END);
+   pt_Change = pt_VoiceInstance->pat_ChangeSequence;
+   for (s32_Count = 0; s32_Count < pt_VoiceInstance->s32_ChangeLength; ++s32_Count)
+   {
+      fprintf(pv_File, "  %d, %d, %d,", pt_Change->u16_Delay1ms, pt_Change->u8_Voice, pt_Change->u16_Frequency1Hz);
+      if ((s32_Count % 6) == 5)
+      {
+         fprintf(pv_File, "\n");
+      }
+      ++pt_Change;
+   }
+   fprintf(pv_File, "\n};\n\n");
+
+   //------------------------------------------------------------//
+   // close file                                                 //
+   //------------------------------------------------------------//
+   fclose(pv_File);
+}
+
+
+
+
+
+
+
+
+
+/*
+   Walk through the note events once. A note on takes a free voice, otherwise a voice
+   of lower or equal channel priority is stolen (by oe_Steal). If all voices play notes of
+   higher priority, the note is dropped. A note off releases the voice playing that note.
+   Each step scans the (max. VOICE_MAX_VOICES) voices only, so it is O(1) per event.
+*/
+static void allocate(T_voice_instance * const opt_VoiceInstance, const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents,
+                     const T_voice_steal oe_Steal, const uint8_t * const opau8_ChannelPriority)
+{
+   uint32_t u32_Tick;
+   int32_t s32_Count;
+   uint8_t u8_Voice;
+
+   //for each note event
+   u32_Tick = 0;
+   for (s32_Count = 0; s32_Count < os32_Length; ++s32_Count)
+   {
+      const T_midi_event_note * const pt_NoteEvent = &opt_NoteEvents[s32_Count];
+      const uint8_t u8_Priority = ((opau8_ChannelPriority != NULL) ? opau8_ChannelPriority[pt_NoteEvent->u8_Channel & 0x0F] : 0);
+      T_voice_state * pt_Voice;
+
+      u32_Tick += pt_NoteEvent->u32_DeltaTime;
+      if (pt_NoteEvent->u8_OnOff != 0)
+      {
+         //-----------------------------------------------------//
+         // note on                                             //
+         //-----------------------------------------------------//
+         ++opt_VoiceInstance->u32_NumOfNotes;
+         pt_Voice = get_voice(opt_VoiceInstance, pt_NoteEvent, u8_Priority, oe_Steal);
+         if (pt_Voice == NULL)
+         {
+            ++opt_VoiceInstance->u32_NumOfDropped;
+            continue;
+         }
+         pt_Voice->u8_Active = 1;
+         pt_Voice->u8_Channel = pt_NoteEvent->u8_Channel;
+         pt_Voice->u8_Note = pt_NoteEvent->u8_Note;
+         pt_Voice->u8_Velocity = pt_NoteEvent->u8_Velocity;
+         pt_Voice->u8_Priority = u8_Priority;
+         pt_Voice->u32_StartTick = u32_Tick;
+         set_frequency(opt_VoiceInstance, pt_Voice, u32_Tick, sound_get_note_frequency(pt_NoteEvent->u8_Note));
+      }
+      else
+      {
+         //-----------------------------------------------------//
+         // note off                                            //
+         //-----------------------------------------------------//
+         for (u8_Voice = 0; u8_Voice < opt_VoiceInstance->u8_NumOfVoices; ++u8_Voice)
+         {
+            pt_Voice = &opt_VoiceInstance->at_Voice[u8_Voice];
+            if ((pt_Voice->u8_Active != 0) && (pt_Voice->u8_Channel == pt_NoteEvent->u8_Channel) && (pt_Voice->u8_Note == pt_NoteEvent->u8_Note))
+            {
+               pt_Voice->u8_Active = 0;
+               set_frequency(opt_VoiceInstance, pt_Voice, u32_Tick, 0);
+               break;
+            }
+         }
+         //no voice found -> note was dropped or stolen before
+      }
+   }
+
+   //close all voices at the end of the track
+   for (u8_Voice = 0; u8_Voice < opt_VoiceInstance->u8_NumOfVoices; ++u8_Voice)
+   {
+      T_voice_state * const pt_Voice = &opt_VoiceInstance->at_Voice[u8_Voice];
+
+      set_frequency(opt_VoiceInstance, pt_Voice, u32_Tick, 0);
+   }
+
+   //interleave voices into change sequence
+   merge(opt_VoiceInstance, u32_Tick);
+   for (u8_Voice = 0; u8_Voice < opt_VoiceInstance->u8_NumOfVoices; ++u8_Voice)
+   {
+      emit_signal_sequence(&opt_VoiceInstance->at_Voice[u8_Voice]);
+   }
+}
+
+
+static T_voice_state * get_voice(T_voice_instance * const opt_VoiceInstance, const T_midi_event_note * const opt_NoteEvent,
+                                 const uint8_t ou8_Priority, const T_voice_steal oe_Steal)
+{
+   T_voice_state * pt_Free;
+   T_voice_state * pt_Victim;
+   uint8_t u8_Voice;
+
+   pt_Free = NULL;
+   pt_Victim = NULL;
+   for (u8_Voice = 0; u8_Voice < opt_VoiceInstance->u8_NumOfVoices; ++u8_Voice)
+   {
+      T_voice_state * const pt_Voice = &opt_VoiceInstance->at_Voice[u8_Voice];
+
+      if (pt_Voice->u8_Active == 0)
+      {
+         //first free voice
+         if (pt_Free == NULL)
+         {
+            pt_Free = pt_Voice;
+         }
+         continue;
+      }
+      //same note retriggered -> reuse its voice
+      if ((pt_Voice->u8_Channel == opt_NoteEvent->u8_Channel) && (pt_Voice->u8_Note == opt_NoteEvent->u8_Note))
+      {
+         return pt_Voice;
+      }
+      //steal candidates: voices of lower or equal priority
+      if (pt_Voice->u8_Priority > ou8_Priority)
+      {
+         continue;
+      }
+      if ((pt_Victim == NULL) || (pt_Voice->u8_Priority < pt_Victim->u8_Priority))
+      {
+         pt_Victim = pt_Voice;
+      }
+      else if (pt_Voice->u8_Priority == pt_Victim->u8_Priority)
+      {
+         if ((oe_Steal == VOICE_STEAL_LOWEST_VELOCITY) && (pt_Voice->u8_Velocity != pt_Victim->u8_Velocity))
+         {
+            if (pt_Voice->u8_Velocity < pt_Victim->u8_Velocity)
+            {
+               pt_Victim = pt_Voice;
+            }
+         }
+         else if (pt_Voice->u32_StartTick < pt_Victim->u32_StartTick)
+         {
+            pt_Victim = pt_Voice;
+         }
+      }
+   }
+
+   if (pt_Free != NULL)
+   {
+      return pt_Free;
+   }
+   if (pt_Victim != NULL)
+   {
+      ++opt_VoiceInstance->u32_NumOfStolen;
+   }
+   return pt_Victim;
+}
+
+
+/*
+   Close the open segment of the voice at ou32_Tick and open a new one with the given frequency.
+   Durations are derived from absolute time, so the total duration of all voices is equal
+   and truncation does not accumulate.
+*/
+static void set_frequency(T_voice_instance * const opt_VoiceInstance, T_voice_state * const opt_Voice, const uint32_t ou32_Tick, const uint16_t ou16_Frequency1Hz)
+{
+   if (ou32_Tick > opt_Voice->u32_SegmentTick)
+   {
+      const uint32_t u32_Duration1ms = get_ms(opt_VoiceInstance, ou32_Tick) - get_ms(opt_VoiceInstance, opt_Voice->u32_SegmentTick);
+      T_voice_signal * const pt_Last = ((opt_Voice->s32_Length > 0) ? &opt_Voice->pat_Signal[opt_Voice->s32_Length - 1] : NULL);
+
+      if ((pt_Last != NULL) && (pt_Last->u16_Frequency1Hz == opt_Voice->u16_SegmentFrequency1Hz))
+      {
+         pt_Last->u32_Duration1ms += u32_Duration1ms;
+      }
+      else
+      {
+         T_voice_signal * const pt_Signal = &opt_Voice->pat_Signal[opt_Voice->s32_Length++];
+
+         pt_Signal->u32_Duration1ms = u32_Duration1ms;
+         pt_Signal->u16_Frequency1Hz = opt_Voice->u16_SegmentFrequency1Hz;
+      }
+      opt_Voice->u32_SegmentTick = ou32_Tick;
+   }
+   //a segment of zero length is just replaced
+   opt_Voice->u16_SegmentFrequency1Hz = ou16_Frequency1Hz;
+}
+
+
+/*
+   Merge the signal sequences of all voices by start time into one change sequence.
+   The initial silence of a voice is no change. The sequence is terminated by a
+   VOICE_END record, that carries the remaining time until the end of the track.
+*/
+static void merge(T_voice_instance * const opt_VoiceInstance, const uint32_t ou32_EndTick)
+{
+   int32_t as32_Index[VOICE_MAX_VOICES] = { 0 };
+   uint32_t au32_Start1ms[VOICE_MAX_VOICES] = { 0 };
+   uint32_t u32_Last1ms;
+   T_voice_change * pt_Change;
+
+   pt_Change = opt_VoiceInstance->pat_ChangeSequence;
+   u32_Last1ms = 0;
+   for (;;)
+   {
+      const T_voice_state * pt_Voice;
+      uint8_t u8_Next;
+      uint8_t u8_Voice;
+
+      //voice with earliest pending segment
+      u8_Next = VOICE_END;
+      for (u8_Voice = 0; u8_Voice < opt_VoiceInstance->u8_NumOfVoices; ++u8_Voice)
+      {
+         if ((as32_Index[u8_Voice] < opt_VoiceInstance->at_Voice[u8_Voice].s32_Length) &&
+             ((u8_Next == VOICE_END) || (au32_Start1ms[u8_Voice] < au32_Start1ms[u8_Next])))
+         {
+            u8_Next = u8_Voice;
+         }
+      }
+      if (u8_Next == VOICE_END)
+      {
+         break;
+      }
+
+      pt_Voice = &opt_VoiceInstance->at_Voice[u8_Next];
+      if ((as32_Index[u8_Next] > 0) || (pt_Voice->pat_Signal[0].u16_Frequency1Hz != 0))
+      {
+         pt_Change->u16_Delay1ms = clamp_ms(au32_Start1ms[u8_Next] - u32_Last1ms);
+         pt_Change->u8_Voice = u8_Next;
+         pt_Change->u16_Frequency1Hz = pt_Voice->pat_Signal[as32_Index[u8_Next]].u16_Frequency1Hz;
+         ++pt_Change;
+         u32_Last1ms = au32_Start1ms[u8_Next];
+      }
+      au32_Start1ms[u8_Next] += pt_Voice->pat_Signal[as32_Index[u8_Next]].u32_Duration1ms;
+      ++as32_Index[u8_Next];
+   }
+
+   //terminate
+   pt_Change->u16_Delay1ms = clamp_ms(get_ms(opt_VoiceInstance, ou32_EndTick) - u32_Last1ms);
+   pt_Change->u8_Voice = VOICE_END;
+   pt_Change->u16_Frequency1Hz = 0;
+   ++pt_Change;
+   opt_VoiceInstance->s32_ChangeLength = (int32_t)(pt_Change - opt_VoiceInstance->pat_ChangeSequence);
+}
+
+
+static uint32_t get_ms(const T_voice_instance * const opt_VoiceInstance, const uint32_t ou32_Tick)
+{
+   return (uint32_t)(ou32_Tick * opt_VoiceInstance->f64_ScaleTicksToMs);
+}
+
+
+/*
+   The emitted tables hold 16-bit durations, longer signals are clamped.
+*/
+static void emit_signal_sequence(T_voice_state * const opt_Voice)
+{
+   int32_t s32_Count;
+
+   for (s32_Count = 0; s32_Count < opt_Voice->s32_Length; ++s32_Count)
+   {
+      opt_Voice->pat_SignalSequence[s32_Count].u16_Duration1ms = clamp_ms(opt_Voice->pat_Signal[s32_Count].u32_Duration1ms);
+      opt_Voice->pat_SignalSequence[s32_Count].u16_Frequency1Hz = opt_Voice->pat_Signal[s32_Count].u16_Frequency1Hz;
+   }
+}
+
+
+static uint16_t clamp_ms(const uint32_t ou32_Duration1ms)
+{
+   return (uint16_t)((ou32_Duration1ms > 0xFFFFu) ? 0xFFFFu : ou32_Duration1ms);
+}
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     voice.h
+   \brief    Functions to distribute note events onto several voices (polyphony)
+
+   Each voice is an independent tone generator (e.g. a PWM timer) on the target.
+   The result is either one signal sequence per voice (all of the same total
+   duration) or a single sequence of frequency changes, tagged with the voice.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _VOICE_H
+#define _VOICE_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "midi_event.h"
+#include "sound.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define VOICE_MAX_VOICES      (16)
+#define VOICE_NUM_OF_CHANNELS (16)
+#define VOICE_END             (0xFF)   //voice of the terminating change record
+
+/* -- Types --------------------------------------------------------------- */
+typedef void * T_VOICE_HANDLE;
+
+
+typedef enum
+{
+   VOICE_STEAL_OLDEST = 0,          //replace the note, that was started first
+   VOICE_STEAL_LOWEST_VELOCITY      //replace the most quiet note (oldest one, if equal)
+} T_voice_steal;
+
+
+typedef struct
+{
+   uint16_t u16_Delay1ms;           //delay since previous change
+   uint8_t u8_Voice;
+   uint16_t u16_Frequency1Hz;
+} T_voice_change;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//opau8_ChannelPriority: priority of each of the 16 channels (higher value wins), NULL for equal priority
+extern T_VOICE_HANDLE voice_open(const int32_t os32_Length, const T_midi_event_note * opt_NoteEvents, const uint16_t ou16_TimeDivision,
+                                 const uint8_t ou8_NumOfVoices, const T_voice_steal oe_Steal, const uint8_t * const opau8_ChannelPriority);
+extern void voice_close(T_VOICE_HANDLE opv_Handle);
+
+extern int32_t voice_get_signal_sequence(T_VOICE_HANDLE opv_Handle, const uint8_t ou8_Voice, const T_sound_signal ** oppt_SignalSequence);
+extern int32_t voice_get_change_sequence(T_VOICE_HANDLE opv_Handle, const T_voice_change ** oppt_ChangeSequence);
+extern void voice_print_statistic(T_VOICE_HANDLE opv_Handle);
+extern void voice_write_signal_sequences(const char * const opc_File, T_VOICE_HANDLE opv_Handle);
+extern void voice_write_change_sequence(const char * const opc_File, T_VOICE_HANDLE opv_Handle);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
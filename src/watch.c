@@ -0,0 +1,475 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     watch.c
+   \brief    Functions to reconvert midi files of a directory, whenever they change
+
+   Each file passes the states idle -> pending (debounce) -> queued -> running -> idle.
+   A change while the file is converted marks it as dirty, so it is debounced and converted again.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include "watch.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define WATCH_MAX_NAME           (256)
+
+/* -- Types --------------------------------------------------------------- */
+typedef enum
+{
+   WATCH_STATE_IDLE = 0,
+   WATCH_STATE_PENDING,                   //changed, waiting for the end of the burst
+   WATCH_STATE_QUEUED,                    //waiting for a worker
+   WATCH_STATE_RUNNING
+} T_watch_state;
+
+
+typedef struct
+{
+   char acn_Name[WATCH_MAX_NAME];
+   T_watch_state e_State;
+   uint8_t u8_Dirty;                      //changed while running
+   uint64_t u64_Deadline1ms;              //end of debounce (pending, respectively dirty)
+   uint64_t u64_Changed1ms;               //time of the first change (latency report)
+} T_watch_file;
+
+
+typedef struct
+{
+   const char * pc_Directory;
+   const char * pc_OutputDirectory;
+   const char * pc_OutputExtension;
+   uint32_t u32_Debounce1ms;
+   T_watch_convert pf_Convert;
+   void * pv_Context;
+   T_watch_file * pat_File;
+   uint32_t u32_NumOfFiles;
+   uint32_t u32_MaxFiles;
+   uint8_t u8_Stop;
+   pthread_mutex_t t_Mutex;
+   pthread_cond_t t_Queued;               //a file was queued (or stop)
+   int s32_Wakeup;                        //eventfd: a dirty file became pending (the event loop recalculates its timeout)
+   FILE * pv_Log;                         //report lines (stdout of the conversions is discarded)
+} T_watch_instance;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+static volatile sig_atomic_t ms32_Stop;
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void handle_signal(int os32_Signal);
+static uint64_t get_time_1ms(void);
+static int32_t is_midi_file(const char * const opc_Name);
+static T_watch_file * get_file(T_watch_instance * const opt_WatchInstance, const char * const opc_Name);
+static void * worker(void * opv_Instance);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+int32_t watch_run(const char * const opc_Directory, const char * const opc_OutputDirectory, const char * const opc_OutputExtension,
+                  const uint32_t ou32_NumOfThreads, const uint32_t ou32_Debounce1ms, T_watch_convert opf_Convert, void * const opv_Context)
+{
+   T_watch_instance t_WatchInstance;
+   struct sigaction t_Action;
+   pthread_t * pat_Thread;
+   uint32_t u32_NumOfThreads;
+   uint32_t u32_Thread;
+   DIR * pv_Directory;
+   struct dirent * pt_Entry;
+   int s32_Inotify;
+   int s32_Stdout;
+   int s32_Null;
+
+   //------------------------------------------------------------//
+   // watch directory                                            //
+   //------------------------------------------------------------//
+   s32_Inotify = inotify_init1(IN_CLOEXEC);
+   if ((s32_Inotify < 0) || (inotify_add_watch(s32_Inotify, opc_Directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0))
+   {
+      printf("[E] Cannot watch directory %s!\n", opc_Directory);
+      if (s32_Inotify >= 0)
+      {
+         close(s32_Inotify);
+      }
+      return -1;
+   }
+   memset(&t_WatchInstance, 0, sizeof(t_WatchInstance));
+   t_WatchInstance.pc_Directory = opc_Directory;
+   t_WatchInstance.pc_OutputDirectory = opc_OutputDirectory;
+   t_WatchInstance.pc_OutputExtension = opc_OutputExtension;
+   t_WatchInstance.u32_Debounce1ms = ou32_Debounce1ms;
+   t_WatchInstance.pf_Convert = opf_Convert;
+   t_WatchInstance.pv_Context = opv_Context;
+   pthread_mutex_init(&t_WatchInstance.t_Mutex, NULL);
+   pthread_cond_init(&t_WatchInstance.t_Queued, NULL);
+   t_WatchInstance.s32_Wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+   //the conversions print their chunks and statistics to stdout, lines of parallel conversions would be mixed:
+   //those are discarded, each conversion is reported by one line (tagged with the file name) instead
+   fflush(stdout);
+   s32_Stdout = dup(STDOUT_FILENO);
+   s32_Null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+   t_WatchInstance.pv_Log = ((s32_Stdout >= 0) ? fdopen(s32_Stdout, "w") : NULL);
+   if ((t_WatchInstance.pv_Log != NULL) && (s32_Null >= 0))
+   {
+      dup2(s32_Null, STDOUT_FILENO);
+   }
+   else
+   {
+      t_WatchInstance.pv_Log = stdout;
+   }
+   if (s32_Null >= 0)
+   {
+      close(s32_Null);
+   }
+
+   //stop on SIGINT/SIGTERM (poll is interrupted, no restart)
+   ms32_Stop = 0;
+   memset(&t_Action, 0, sizeof(t_Action));
+   t_Action.sa_handler = handle_signal;
+   sigaction(SIGINT, &t_Action, NULL);
+   sigaction(SIGTERM, &t_Action, NULL);
+
+   //------------------------------------------------------------//
+   // convert all existing files                                 //
+   //------------------------------------------------------------//
+   pv_Directory = opendir(opc_Directory);
+   if (pv_Directory != NULL)
+   {
+      while ((pt_Entry = readdir(pv_Directory)) != NULL)
+      {
+         T_watch_file * pt_File;
+
+         if (is_midi_file(pt_Entry->d_name) != 0)
+         {
+            pt_File = get_file(&t_WatchInstance, pt_Entry->d_name);
+            if (pt_File != NULL)
+            {
+               pt_File->e_State = WATCH_STATE_QUEUED;
+               pt_File->u64_Changed1ms = get_time_1ms();
+            }
+         }
+      }
+      closedir(pv_Directory);
+   }
+
+   //------------------------------------------------------------//
+   // start workers                                              //
+   //------------------------------------------------------------//
+   u32_NumOfThreads = ou32_NumOfThreads;
+   if (u32_NumOfThreads == 0)
+   {
+      const long s32_Cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+      u32_NumOfThreads = ((s32_Cpus > 0) ? (uint32_t)s32_Cpus : 1);
+   }
+   fprintf(t_WatchInstance.pv_Log, "Watching %s (%d threads), press Ctrl+C to stop\n", opc_Directory, u32_NumOfThreads);
+   fflush(t_WatchInstance.pv_Log);
+   pat_Thread = calloc(u32_NumOfThreads, sizeof(pthread_t));
+   for (u32_Thread = 0; u32_Thread < u32_NumOfThreads; ++u32_Thread)
+   {
+      pthread_create(&pat_Thread[u32_Thread], NULL, worker, &t_WatchInstance);
+   }
+
+   //------------------------------------------------------------//
+   // event loop                                                 //
+   //------------------------------------------------------------//
+   while (ms32_Stop == 0)
+   {
+      union
+      {
+         struct inotify_event t_Event;
+         char acn_Buffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+      } u_Events;
+      struct pollfd at_Poll[2];
+      uint64_t u64_Now1ms;
+      uint64_t u64_Next1ms;
+      int s32_Timeout;
+      uint32_t u32_File;
+
+      //wait for an event or the end of the earliest debounce
+      u64_Now1ms = get_time_1ms();
+      u64_Next1ms = UINT64_MAX;
+      pthread_mutex_lock(&t_WatchInstance.t_Mutex);
+      for (u32_File = 0; u32_File < t_WatchInstance.u32_NumOfFiles; ++u32_File)
+      {
+         const T_watch_file * const pt_File = &t_WatchInstance.pat_File[u32_File];
+
+         if ((pt_File->e_State == WATCH_STATE_PENDING) && (pt_File->u64_Deadline1ms < u64_Next1ms))
+         {
+            u64_Next1ms = pt_File->u64_Deadline1ms;
+         }
+      }
+      pthread_mutex_unlock(&t_WatchInstance.t_Mutex);
+      s32_Timeout = ((u64_Next1ms == UINT64_MAX) ? -1 : ((u64_Next1ms > u64_Now1ms) ? (int)(u64_Next1ms - u64_Now1ms) : 0));
+      at_Poll[0].fd = s32_Inotify;
+      at_Poll[0].events = POLLIN;
+      at_Poll[1].fd = t_WatchInstance.s32_Wakeup;
+      at_Poll[1].events = POLLIN;
+      at_Poll[1].revents = 0;
+      if (poll(at_Poll, ((t_WatchInstance.s32_Wakeup >= 0) ? 2 : 1), s32_Timeout) < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+         break;
+      }
+
+      if ((at_Poll[1].revents & POLLIN) != 0)
+      {
+         uint64_t u64_Count;
+
+         (void)read(t_WatchInstance.s32_Wakeup, &u64_Count, sizeof(u64_Count));
+      }
+
+      //changed files -> (re)start debounce
+      u64_Now1ms = get_time_1ms();
+      pthread_mutex_lock(&t_WatchInstance.t_Mutex);
+      if ((at_Poll[0].revents & POLLIN) != 0)
+      {
+         const ssize_t s32_Size = read(s32_Inotify, u_Events.acn_Buffer, sizeof(u_Events.acn_Buffer));
+         ssize_t s32_Offset;
+
+         for (s32_Offset = 0; s32_Offset < s32_Size; )
+         {
+            const struct inotify_event * const pt_Event = (const struct inotify_event *)&u_Events.acn_Buffer[s32_Offset];
+            T_watch_file * pt_File;
+
+            s32_Offset += (ssize_t)(sizeof(struct inotify_event) + pt_Event->len);
+            if ((pt_Event->len == 0) || (is_midi_file(pt_Event->name) == 0))
+            {
+               continue;
+            }
+            pt_File = get_file(&t_WatchInstance, pt_Event->name);
+            if (pt_File == NULL)
+            {
+               continue;
+            }
+            if ((pt_File->e_State == WATCH_STATE_IDLE) || (pt_File->e_State == WATCH_STATE_PENDING))
+            {
+               if (pt_File->e_State == WATCH_STATE_IDLE)
+               {
+                  pt_File->u64_Changed1ms = u64_Now1ms;
+               }
+               pt_File->e_State = WATCH_STATE_PENDING;
+               pt_File->u64_Deadline1ms = u64_Now1ms + t_WatchInstance.u32_Debounce1ms;
+            }
+            else if (pt_File->e_State == WATCH_STATE_RUNNING)
+            {
+               //debounced after the conversion
+               if (pt_File->u8_Dirty == 0)
+               {
+                  pt_File->u64_Changed1ms = u64_Now1ms;
+               }
+               pt_File->u8_Dirty = 1;
+               pt_File->u64_Deadline1ms = u64_Now1ms + t_WatchInstance.u32_Debounce1ms;
+            }
+         }
+      }
+      //end of burst -> queue
+      for (u32_File = 0; u32_File < t_WatchInstance.u32_NumOfFiles; ++u32_File)
+      {
+         T_watch_file * const pt_File = &t_WatchInstance.pat_File[u32_File];
+
+         if ((pt_File->e_State == WATCH_STATE_PENDING) && (pt_File->u64_Deadline1ms <= u64_Now1ms))
+         {
+            pt_File->e_State = WATCH_STATE_QUEUED;
+            pthread_cond_signal(&t_WatchInstance.t_Queued);
+         }
+      }
+      pthread_mutex_unlock(&t_WatchInstance.t_Mutex);
+   }
+
+   //------------------------------------------------------------//
+   // stop workers (running conversions are completed)           //
+   //------------------------------------------------------------//
+   pthread_mutex_lock(&t_WatchInstance.t_Mutex);
+   t_WatchInstance.u8_Stop = 1;
+   pthread_cond_broadcast(&t_WatchInstance.t_Queued);
+   pthread_mutex_unlock(&t_WatchInstance.t_Mutex);
+   for (u32_Thread = 0; u32_Thread < u32_NumOfThreads; ++u32_Thread)
+   {
+      pthread_join(pat_Thread[u32_Thread], NULL);
+   }
+   free(pat_Thread);
+   free(t_WatchInstance.pat_File);
+   pthread_cond_destroy(&t_WatchInstance.t_Queued);
+   pthread_mutex_destroy(&t_WatchInstance.t_Mutex);
+   if (t_WatchInstance.s32_Wakeup >= 0)
+   {
+      close(t_WatchInstance.s32_Wakeup);
+   }
+   //restore stdout
+   if (t_WatchInstance.pv_Log != stdout)
+   {
+      fflush(stdout);
+      dup2(fileno(t_WatchInstance.pv_Log), STDOUT_FILENO);
+      fclose(t_WatchInstance.pv_Log);
+   }
+   close(s32_Inotify);
+   return 0;
+}
+
+
+
+
+
+
+
+
+
+static void handle_signal(int os32_Signal)
+{
+   (void)os32_Signal;
+   ms32_Stop = 1;
+}
+
+
+static uint64_t get_time_1ms(void)
+{
+   struct timespec t_Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &t_Now);
+   return ((uint64_t)t_Now.tv_sec * 1000u) + ((uint64_t)t_Now.tv_nsec / 1000000u);
+}
+
+
+//*.mid, *.midi (hidden files, e.g. temporary files of editors, are ignored)
+static int32_t is_midi_file(const char * const opc_Name)
+{
+   const char * const pc_Extension = strrchr(opc_Name, '.');
+
+   return ((opc_Name[0] != '.') && (pc_Extension != NULL) && (strlen(opc_Name) < WATCH_MAX_NAME) &&
+           ((strcasecmp(pc_Extension, ".mid") == 0) || (strcasecmp(pc_Extension, ".midi") == 0))) ? 1 : 0;
+}
+
+
+//file entry of the given name (added, if unknown); mutex must be locked
+static T_watch_file * get_file(T_watch_instance * const opt_WatchInstance, const char * const opc_Name)
+{
+   T_watch_file * pt_File;
+   uint32_t u32_File;
+
+   for (u32_File = 0; u32_File < opt_WatchInstance->u32_NumOfFiles; ++u32_File)
+   {
+      if (strcmp(opt_WatchInstance->pat_File[u32_File].acn_Name, opc_Name) == 0)
+      {
+         return &opt_WatchInstance->pat_File[u32_File];
+      }
+   }
+   if (opt_WatchInstance->u32_NumOfFiles >= opt_WatchInstance->u32_MaxFiles)
+   {
+      opt_WatchInstance->u32_MaxFiles = ((opt_WatchInstance->u32_MaxFiles > 0) ? (2 * opt_WatchInstance->u32_MaxFiles) : 64);
+      opt_WatchInstance->pat_File = realloc(opt_WatchInstance->pat_File, opt_WatchInstance->u32_MaxFiles * sizeof(T_watch_file));
+   }
+   pt_File = &opt_WatchInstance->pat_File[opt_WatchInstance->u32_NumOfFiles++];
+   memset(pt_File, 0, sizeof(T_watch_file));
+   snprintf(pt_File->acn_Name, sizeof(pt_File->acn_Name), "%s", opc_Name);
+   return pt_File;
+}
+
+
+static void * worker(void * opv_Instance)
+{
+   T_watch_instance * const pt_WatchInstance = (T_watch_instance *)opv_Instance;
+
+   pthread_mutex_lock(&pt_WatchInstance->t_Mutex);
+   while (pt_WatchInstance->u8_Stop == 0)
+   {
+      char acn_Name[WATCH_MAX_NAME];
+      char acn_BaseName[WATCH_MAX_NAME];
+      char acn_Input[2 * WATCH_MAX_NAME + 1024];
+      char acn_Output[2 * WATCH_MAX_NAME + 1024];
+      char acn_Temporary[2 * WATCH_MAX_NAME + 1024];
+      T_watch_file * pt_File;
+      uint64_t u64_Changed1ms;
+      uint32_t u32_File;
+      char * pc_Extension;
+      int32_t s32_Result;
+
+      //take next queued file
+      pt_File = NULL;
+      for (u32_File = 0; u32_File < pt_WatchInstance->u32_NumOfFiles; ++u32_File)
+      {
+         if (pt_WatchInstance->pat_File[u32_File].e_State == WATCH_STATE_QUEUED)
+         {
+            pt_File = &pt_WatchInstance->pat_File[u32_File];
+            break;
+         }
+      }
+      if (pt_File == NULL)
+      {
+         pthread_cond_wait(&pt_WatchInstance->t_Queued, &pt_WatchInstance->t_Mutex);
+         continue;
+      }
+      pt_File->e_State = WATCH_STATE_RUNNING;
+      pt_File->u8_Dirty = 0;
+      u64_Changed1ms = pt_File->u64_Changed1ms;
+      memcpy(acn_Name, pt_File->acn_Name, sizeof(acn_Name));
+      pthread_mutex_unlock(&pt_WatchInstance->t_Mutex);
+
+      //convert into temporary file, then replace output atomically
+      snprintf(acn_Input, sizeof(acn_Input), "%s/%s", pt_WatchInstance->pc_Directory, acn_Name);
+      memcpy(acn_BaseName, acn_Name, sizeof(acn_BaseName));
+      pc_Extension = strrchr(acn_BaseName, '.');
+      *pc_Extension = 0;
+      snprintf(acn_Output, sizeof(acn_Output), "%s/%s%s", pt_WatchInstance->pc_OutputDirectory, acn_BaseName, pt_WatchInstance->pc_OutputExtension);
+      snprintf(acn_Temporary, sizeof(acn_Temporary), "%s/.%s%s.tmp", pt_WatchInstance->pc_OutputDirectory, acn_BaseName, pt_WatchInstance->pc_OutputExtension);
+      s32_Result = pt_WatchInstance->pf_Convert(acn_Input, acn_Temporary, pt_WatchInstance->pv_Context);
+      if ((s32_Result == 0) && (rename(acn_Temporary, acn_Output) != 0))
+      {
+         s32_Result = -1;
+      }
+      if (s32_Result != 0)
+      {
+         remove(acn_Temporary);
+      }
+
+      //report (serialized by the mutex), then
+      //changed during conversion -> debounce once again (table may have been reallocated meanwhile)
+      pthread_mutex_lock(&pt_WatchInstance->t_Mutex);
+      if (s32_Result == 0)
+      {
+         fprintf(pt_WatchInstance->pv_Log, "[watch] %s -> %s (%d ms)\n", acn_Input, acn_Output, (int32_t)(get_time_1ms() - u64_Changed1ms));
+      }
+      else
+      {
+         fprintf(pt_WatchInstance->pv_Log, "[watch] %s: conversion failed, %s is unchanged\n", acn_Input, acn_Output);
+      }
+      fflush(pt_WatchInstance->pv_Log);
+      pt_File = get_file(pt_WatchInstance, acn_Name);
+      if (pt_File->u8_Dirty != 0)
+      {
+         const uint64_t u64_Wakeup = 1;
+
+         pt_File->e_State = ((pt_WatchInstance->s32_Wakeup >= 0) ? WATCH_STATE_PENDING : WATCH_STATE_QUEUED);
+         (void)write(pt_WatchInstance->s32_Wakeup, &u64_Wakeup, sizeof(u64_Wakeup));
+      }
+      else
+      {
+         pt_File->e_State = WATCH_STATE_IDLE;
+      }
+   }
+   pthread_mutex_unlock(&pt_WatchInstance->t_Mutex);
+   return NULL;
+}
@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     watch.h
+   \brief    Functions to reconvert midi files of a directory, whenever they change
+
+   The directory is watched by inotify (Linux). Bursts of events of a file are
+   combined (debounce), then the file is converted by a pool of worker threads.
+   The output is written to a temporary file and renamed, so readers never see
+   an incomplete output file.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _WATCH_H
+#define _WATCH_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+//convert one file (called by several worker threads in parallel); returns 0 if the output file was written
+typedef int32_t (*T_watch_convert)(const char * const opc_InputFile, const char * const opc_OutputFile, void * const opv_Context);
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//all midi files are converted at start, then on each change, until SIGINT/SIGTERM;
+//output: <opc_OutputDirectory>/<name of midi file without extension><opc_OutputExtension>
+//ou32_NumOfThreads: 0 -> number of online CPUs
+extern int32_t watch_run(const char * const opc_Directory, const char * const opc_OutputDirectory, const char * const opc_OutputExtension,
+                         const uint32_t ou32_NumOfThreads, const uint32_t ou32_Debounce1ms, T_watch_convert opf_Convert, void * const opv_Context);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
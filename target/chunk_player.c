@@ -0,0 +1,270 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     chunk_player.c
+   \brief    Target side player for block images in external flash
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "chunk_player.h"
+
+/* -- Defines ------------------------------------------------------------- */
+#define CHUNK_PLAYER_MAGIC          (0x43444E53u)  //"SNDC"
+#define CHUNK_PLAYER_VERSION        (1u)
+#define CHUNK_PLAYER_INDEX_HEADER   (16u)
+#define CHUNK_PLAYER_BLOCK_HEADER   (8u)
+#define CHUNK_PLAYER_FLAG_LAST      (0x0001u)
+
+/* -- Types --------------------------------------------------------------- */
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static uint16_t get_u16(const uint8_t * const opu8_Data);
+static uint32_t get_u32(const uint8_t * const opu8_Data);
+static void read_block(T_chunk_player * const opt_Player, const uint16_t ou16_Block, const uint8_t ou8_Buffer);
+static void wait_read(T_chunk_player * const opt_Player);
+static void read_index(T_chunk_player * const opt_Player, const uint16_t ou16_Block, uint8_t * const opu8_Buffer);
+static void load_block(T_chunk_player * const opt_Player, const uint16_t ou16_Block);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+int32_t chunk_player_init(T_chunk_player * const opt_Player, const T_chunk_read opf_Read, const uint32_t ou32_Address,
+                          uint8_t * const opu8_Buffer0, uint8_t * const opu8_Buffer1, const uint16_t ou16_BufferSize)
+{
+   uint8_t * const pu8_Header = opu8_Buffer0;
+
+   opt_Player->pf_Read = opf_Read;
+   opt_Player->u32_Address = ou32_Address;
+   opt_Player->apu8_Buffer[0] = opu8_Buffer0;
+   opt_Player->apu8_Buffer[1] = opu8_Buffer1;
+   opt_Player->u8_Current = 0;
+   opt_Player->u8_Reading = 0;
+
+   //index header
+   if (ou16_BufferSize < CHUNK_PLAYER_INDEX_HEADER)
+   {
+      return -1;
+   }
+   opt_Player->u8_Reading = 1;
+   opf_Read(ou32_Address, pu8_Header, CHUNK_PLAYER_INDEX_HEADER);
+   wait_read(opt_Player);
+   opt_Player->u16_BlockSize = get_u16(&pu8_Header[6]);
+   opt_Player->u16_IndexBlocks = get_u16(&pu8_Header[8]);
+   opt_Player->u16_NumOfBlocks = get_u16(&pu8_Header[10]);
+   opt_Player->u32_Duration1ms = get_u32(&pu8_Header[12]);
+   if ((get_u32(&pu8_Header[0]) != CHUNK_PLAYER_MAGIC) || (get_u16(&pu8_Header[4]) != CHUNK_PLAYER_VERSION) ||
+       (opt_Player->u16_BlockSize > ou16_BufferSize) || (opt_Player->u16_NumOfBlocks == 0))
+   {
+      return -1;
+   }
+
+   //first data block, prefetch of the second one
+   load_block(opt_Player, 0);
+   return 0;
+}
+
+
+void chunk_player_read_done(T_chunk_player * const opt_Player)
+{
+   opt_Player->u8_Reading = 0;
+}
+
+
+/*
+   The index is searched in RAM: a binary search over the index blocks by their first start
+   time reads whole index blocks into the current buffer (usually the index is a single
+   block, i.e. one read), then a binary search within that block finds the last data block,
+   that starts at or before the given time.
+   Within the data block, all signals ending before the time are skipped.
+*/
+void chunk_player_seek(T_chunk_player * const opt_Player, const uint32_t ou32_Time1ms)
+{
+   uint8_t * const pu8_Index = opt_Player->apu8_Buffer[opt_Player->u8_Current];
+   const uint32_t u32_BlockSize = opt_Player->u16_BlockSize;
+   const uint8_t * pu8_Block;
+   uint16_t u16_Low;
+   uint16_t u16_High;
+   uint16_t u16_Loaded;
+   uint16_t u16_First;
+   uint32_t u32_Time1ms;
+
+   //the other buffer may still be filled
+   wait_read(opt_Player);
+
+   //index block holding the entry (the first entry of each further index block is at its start)
+   u16_Low = 0;
+   u16_High = (uint16_t)((CHUNK_PLAYER_INDEX_HEADER + (4u * (opt_Player->u16_NumOfBlocks - 1u))) / u32_BlockSize);
+   u16_Loaded = 0xFFFFu;
+   while (u16_Low < u16_High)
+   {
+      const uint16_t u16_Middle = (uint16_t)(u16_Low + ((u16_High - u16_Low + 1u) / 2u));
+
+      read_index(opt_Player, u16_Middle, pu8_Index);
+      u16_Loaded = u16_Middle;
+      if (get_u32(pu8_Index) <= ou32_Time1ms)
+      {
+         u16_Low = u16_Middle;
+      }
+      else
+      {
+         u16_High = (uint16_t)(u16_Middle - 1u);
+      }
+   }
+   if (u16_Loaded != u16_Low)
+   {
+      read_index(opt_Player, u16_Low, pu8_Index);
+   }
+
+   //entries of this index block: u16_First..u16_High
+   u16_First = (uint16_t)((u16_Low == 0) ? 0u : (((u16_Low * u32_BlockSize) - CHUNK_PLAYER_INDEX_HEADER) / 4u));
+   u16_High = (uint16_t)(((((uint32_t)u16_Low + 1u) * u32_BlockSize) - CHUNK_PLAYER_INDEX_HEADER) / 4u - 1u);
+   if (u16_High >= opt_Player->u16_NumOfBlocks)
+   {
+      u16_High = (uint16_t)(opt_Player->u16_NumOfBlocks - 1u);
+   }
+   u16_Low = u16_First;
+   while (u16_Low < u16_High)
+   {
+      const uint16_t u16_Middle = (uint16_t)(u16_Low + ((u16_High - u16_Low + 1u) / 2u));
+      const uint32_t u32_Offset = (CHUNK_PLAYER_INDEX_HEADER + (4u * (uint32_t)u16_Middle)) % u32_BlockSize;
+
+      if (get_u32(&pu8_Index[u32_Offset]) <= ou32_Time1ms)
+      {
+         u16_Low = u16_Middle;
+      }
+      else
+      {
+         u16_High = (uint16_t)(u16_Middle - 1u);
+      }
+   }
+   load_block(opt_Player, u16_Low);
+
+   //skip the signals before the time
+   pu8_Block = opt_Player->apu8_Buffer[opt_Player->u8_Current];
+   u32_Time1ms = get_u32(&pu8_Block[0]);
+   while (opt_Player->u16_Signal < get_u16(&pu8_Block[4]))
+   {
+      const uint16_t u16_Duration1ms = get_u16(&pu8_Block[CHUNK_PLAYER_BLOCK_HEADER + (4u * opt_Player->u16_Signal)]);
+
+      if ((u32_Time1ms + u16_Duration1ms) > ou32_Time1ms)
+      {
+         opt_Player->u16_Skip1ms = (uint16_t)(ou32_Time1ms - u32_Time1ms);
+         break;
+      }
+      u32_Time1ms += u16_Duration1ms;
+      ++opt_Player->u16_Signal;
+   }
+}
+
+
+/*
+   Get next signal of the sequence. At the end of a block, the buffers are swapped and the
+   read of the following block into the released buffer is started.
+   Returns 1 if a signal was provided, 0 at the end of the sequence, -1 if the next block is still read.
+*/
+int32_t chunk_player_next(T_chunk_player * const opt_Player, uint16_t * const opu16_Duration1ms, uint16_t * const opu16_Frequency1Hz)
+{
+   const uint8_t * pu8_Block = opt_Player->apu8_Buffer[opt_Player->u8_Current];
+   const uint8_t * pu8_Signal;
+
+   //end of block
+   if (opt_Player->u16_Signal >= get_u16(&pu8_Block[4]))
+   {
+      if ((get_u16(&pu8_Block[6]) & CHUNK_PLAYER_FLAG_LAST) != 0)
+      {
+         return 0;
+      }
+      if (opt_Player->u8_Reading != 0)
+      {
+         return -1;
+      }
+      opt_Player->u8_Current ^= 1u;
+      ++opt_Player->u16_Block;
+      opt_Player->u16_Signal = 0;
+      if ((opt_Player->u16_Block + 1u) < opt_Player->u16_NumOfBlocks)
+      {
+         read_block(opt_Player, (uint16_t)(opt_Player->u16_Block + 1u), (uint8_t)(opt_Player->u8_Current ^ 1u));
+      }
+      pu8_Block = opt_Player->apu8_Buffer[opt_Player->u8_Current];
+      if (get_u16(&pu8_Block[4]) == 0)
+      {
+         return 0;
+      }
+   }
+
+   //signal (shortened after a seek)
+   pu8_Signal = &pu8_Block[CHUNK_PLAYER_BLOCK_HEADER + (4u * opt_Player->u16_Signal)];
+   *opu16_Duration1ms = (uint16_t)(get_u16(&pu8_Signal[0]) - opt_Player->u16_Skip1ms);
+   *opu16_Frequency1Hz = get_u16(&pu8_Signal[2]);
+   opt_Player->u16_Skip1ms = 0;
+   ++opt_Player->u16_Signal;
+   return 1;
+}
+
+
+
+
+
+
+
+
+
+//little endian
+static uint16_t get_u16(const uint8_t * const opu8_Data)
+{
+   return (uint16_t)(opu8_Data[0] | ((uint16_t)opu8_Data[1] << 8));
+}
+
+
+static uint32_t get_u32(const uint8_t * const opu8_Data)
+{
+   return (uint32_t)get_u16(&opu8_Data[0]) | ((uint32_t)get_u16(&opu8_Data[2]) << 16);
+}
+
+
+static void read_block(T_chunk_player * const opt_Player, const uint16_t ou16_Block, const uint8_t ou8_Buffer)
+{
+   opt_Player->u8_Reading = 1;
+   opt_Player->pf_Read(opt_Player->u32_Address + ((uint32_t)(opt_Player->u16_IndexBlocks + ou16_Block) * opt_Player->u16_BlockSize),
+                       opt_Player->apu8_Buffer[ou8_Buffer], opt_Player->u16_BlockSize);
+}
+
+
+static void wait_read(T_chunk_player * const opt_Player)
+{
+   while (opt_Player->u8_Reading != 0)
+   {
+   }
+}
+
+
+//read a whole index block (waiting)
+static void read_index(T_chunk_player * const opt_Player, const uint16_t ou16_Block, uint8_t * const opu8_Buffer)
+{
+   opt_Player->u8_Reading = 1;
+   opt_Player->pf_Read(opt_Player->u32_Address + ((uint32_t)ou16_Block * opt_Player->u16_BlockSize), opu8_Buffer, opt_Player->u16_BlockSize);
+   wait_read(opt_Player);
+}
+
+
+//read the block into the current buffer (waiting), then start the prefetch of the following one
+static void load_block(T_chunk_player * const opt_Player, const uint16_t ou16_Block)
+{
+   wait_read(opt_Player);
+   read_block(opt_Player, ou16_Block, opt_Player->u8_Current);
+   wait_read(opt_Player);
+   opt_Player->u16_Block = ou16_Block;
+   opt_Player->u16_Signal = 0;
+   opt_Player->u16_Skip1ms = 0;
+   if ((ou16_Block + 1u) < opt_Player->u16_NumOfBlocks)
+   {
+      read_block(opt_Player, (uint16_t)(ou16_Block + 1u), (uint8_t)(opt_Player->u8_Current ^ 1u));
+   }
+}
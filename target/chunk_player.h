@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     chunk_player.h
+   \brief    Target side player for block images in external flash
+
+   Plays the image written by midi_parser -f chunks (see src/chunk.h) from an
+   external (e.g. SPI NOR) flash through two RAM buffers of one block each:
+   while one block is played, the next one is read into the other buffer. The
+   read is started by a caller supplied function (e.g. SPI transfer by DMA), its
+   completion is signalled by chunk_player_read_done (e.g. from the DMA interrupt,
+   or directly within the read function for a blocking transfer).
+   Seeking reads whole index blocks into a buffer and searches the start times of
+   the data blocks in RAM (one read if the index is a single block), then reads
+   the block holding the time.
+   Does not allocate any memory; the state is held in a caller supplied struct.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _CHUNK_PLAYER_H
+#define _CHUNK_PLAYER_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+//start reading ou16_Size bytes at ou32_Address of the flash into opu8_Buffer
+typedef void (*T_chunk_read)(const uint32_t ou32_Address, uint8_t * const opu8_Buffer, const uint16_t ou16_Size);
+
+
+typedef struct
+{
+   T_chunk_read pf_Read;
+   uint32_t u32_Address;            //start of the image in the flash
+   uint8_t * apu8_Buffer[2];        //one block each
+   uint16_t u16_BlockSize;
+   uint16_t u16_IndexBlocks;
+   uint16_t u16_NumOfBlocks;
+   uint32_t u32_Duration1ms;        //length of the whole sequence
+   uint16_t u16_Block;              //data block in the current buffer
+   uint8_t u8_Current;              //buffer, that is played
+   volatile uint8_t u8_Reading;     //1: read into the other buffer in progress
+   uint16_t u16_Signal;             //next signal of the current block
+   uint16_t u16_Skip1ms;            //the next signal starts this long after its begin (seek)
+} T_chunk_player;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//reads the index header and the first data block; returns 0, -1: no valid image or buffers too small
+extern int32_t chunk_player_init(T_chunk_player * const opt_Player, const T_chunk_read opf_Read, const uint32_t ou32_Address,
+                                 uint8_t * const opu8_Buffer0, uint8_t * const opu8_Buffer1, const uint16_t ou16_BufferSize);
+extern void chunk_player_read_done(T_chunk_player * const opt_Player);
+//continue at the given time (from the start of the sequence); waits for the reads
+extern void chunk_player_seek(T_chunk_player * const opt_Player, const uint32_t ou32_Time1ms);
+//returns 1 if a signal was provided, 0 at the end of the sequence, -1 if the next block isn't read yet (try again)
+extern int32_t chunk_player_next(T_chunk_player * const opt_Player, uint16_t * const opu16_Duration1ms, uint16_t * const opu16_Frequency1Hz);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,327 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     midi_table.hpp
+   \brief    Compile time conversion of a midi file into a signal table (C++17)
+
+   Header only, constexpr implementation of the midi_parser table format: header
+   and track parsing (midi.c), note event extraction and removal of redundant
+   note events (midi_event.c) and signal generation (sound.c). The midi file is
+   embedded as byte array, e.g. by #embed or an include of "xxd -i" output:
+
+      static constexpr uint8_t gau8_Elise[] = {
+      #include "elise.mid.inc"
+      };
+      constexpr auto gat_Elise = midi_table_convert<midi_table_get_length(gau8_Elise)>(gau8_Elise);
+
+   The result is the same as gau16_SoundSequence of "midi_parser -i elise.mid",
+   as std::array of { duration [1ms], frequency [1Hz] } including the terminating
+   { 0, 0 }, except that the last note event does not produce a signal (there is
+   no subsequent event, that defines its duration).
+   Invalid midi data stops the compilation (length 0).
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _MIDI_TABLE_HPP
+#define _MIDI_TABLE_HPP
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+struct T_midi_table_signal
+{
+   uint16_t u16_Duration1ms;
+   uint16_t u16_Frequency1Hz;
+};
+
+
+struct T_midi_table_note
+{
+   uint32_t u32_DeltaTime;
+   uint8_t u8_OnOff;
+   uint8_t u8_Note;
+};
+
+
+//note events of a track, decoded one by one (midi_event.c, decode_note_events)
+struct T_midi_table_decoder
+{
+   const uint8_t * pu8_Chunk;
+   const uint8_t * pu8_ChunkEnd;
+   int32_t s32_Error;
+
+   //returns 1 if opt_NoteEvent is valid, 0 at the end of the track (or on invalid data)
+   constexpr int32_t next(T_midi_table_note & opt_NoteEvent)
+   {
+      while ((s32_Error == 0) && (pu8_Chunk < pu8_ChunkEnd))
+      {
+         uint32_t u32_DeltaTime = 0;
+         uint8_t u8_Command = 0;
+         uint8_t u8_MidiCommand = 0;
+
+         //delta time (variable length value)
+         do
+         {
+            if (pu8_Chunk >= pu8_ChunkEnd)
+            {
+               s32_Error = -1;
+               return 0;
+            }
+            u32_DeltaTime = (u32_DeltaTime << 7) | (*pu8_Chunk & 0x7Fu);
+         } while ((*pu8_Chunk++ & 0x80u) != 0);
+         if (pu8_Chunk >= pu8_ChunkEnd)
+         {
+            s32_Error = -1;
+            return 0;
+         }
+
+         //command
+         u8_Command = *pu8_Chunk;
+         u8_MidiCommand = u8_Command & 0xF0;
+         //running status is not supported (as midi_event_get_note_events)
+         if ((u8_MidiCommand < 0x80) ||
+             ((pu8_ChunkEnd - pu8_Chunk) < (((u8_MidiCommand == 0xC0) || (u8_MidiCommand == 0xD0)) ? 2 : ((u8_MidiCommand == 0xF0) && (u8_Command != 0xFF)) ? 1 : 3)))
+         {
+            s32_Error = -1;
+            return 0;
+         }
+         switch (u8_MidiCommand)
+         {
+         case 0x80: //Note off
+         case 0x90: //Note on
+            if (pu8_Chunk[1] > 0x7F)
+            {
+               s32_Error = -1;
+               return 0;
+            }
+            opt_NoteEvent.u32_DeltaTime = u32_DeltaTime;
+            opt_NoteEvent.u8_OnOff = (((u8_MidiCommand == 0x90) && (pu8_Chunk[2] != 0)) ? 1 : 0); //velocity == 0 is synoym for note off
+            opt_NoteEvent.u8_Note = pu8_Chunk[1];
+            pu8_Chunk = &pu8_Chunk[3];
+            return 1;
+
+         case 0xC0: //Program (patch) change
+         case 0xD0: //Channel after-touch
+            pu8_Chunk = &pu8_Chunk[2];
+            break;
+
+         case 0xF0: //Meta Event (length is a single byte, as midi_event.c)
+            if (u8_Command == 0xFF)
+            {
+               if ((uint32_t)(pu8_ChunkEnd - pu8_Chunk) < (3u + pu8_Chunk[2]))
+               {
+                  s32_Error = -1;
+                  return 0;
+               }
+               pu8_Chunk += (2 + pu8_Chunk[2]);
+            }
+            pu8_Chunk = &pu8_Chunk[1];
+            break;
+
+         default: //Key after-touch, Control Change, Pitch wheel change
+            pu8_Chunk = &pu8_Chunk[3];
+            break;
+         }
+      }
+      return 0;
+   }
+};
+
+
+/* -- Global Variables ---------------------------------------------------- */
+//sound_get_note_frequency() of each midi note
+static constexpr uint16_t gau16_MidiTableFrequency[128] =
+{
+   8, 8, 9, 9, 10, 10, 11, 12, 12, 13, 14, 15, 16, 17, 18, 19,
+   20, 21, 23, 24, 25, 27, 29, 30, 32, 34, 36, 38, 41, 43, 46, 48,
+   51, 55, 58, 61, 65, 69, 73, 77, 82, 87, 92, 97, 103, 110, 116, 123,
+   130, 138, 146, 155, 164, 174, 184, 195, 207, 220, 233, 246, 261, 277, 293, 311,
+   329, 349, 369, 391, 415, 440, 466, 493, 523, 554, 587, 622, 659, 698, 739, 783,
+   830, 880, 932, 987, 1046, 1108, 1174, 1244, 1318, 1396, 1479, 1567, 1661, 1760, 1864, 1975,
+   2093, 2217, 2349, 2489, 2637, 2793, 2959, 3135, 3322, 3520, 3729, 3951, 4186, 4434, 4698, 4978,
+   5274, 5587, 5919, 6271, 6644, 7040, 7458, 7902, 8372, 8869, 9397, 9956, 10548, 11175, 11839, 12543
+};
+
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+//big endian values of the header and track chunks
+constexpr uint32_t midi_table_get_u32(const uint8_t * const opu8_Data)
+{
+   return ((uint32_t)opu8_Data[0] << 24) | ((uint32_t)opu8_Data[1] << 16) | ((uint32_t)opu8_Data[2] << 8) | opu8_Data[3];
+}
+
+
+/*
+   Passes each signal of the given track to the functor (same steps as convert_file of main.c).
+   os32_MaxGapTicks: -1 -> 1/32 beat (respectively ~1/64 second for SMPTE time division).
+   Returns the number of signals (without terminating signal), -1 on invalid data.
+*/
+template <typename T_Sink>
+constexpr int32_t midi_table_get_signals(const uint8_t * const opu8_File, const size_t ou32_FileSize1By, const uint32_t ou32_Track,
+                                         const int32_t os32_MaxGapTicks, T_Sink && ot_Sink)
+{
+   const uint8_t * pu8_Track = opu8_File;
+   const uint8_t * const pu8_FileEnd = &opu8_File[ou32_FileSize1By];
+   uint32_t u32_ChunkSize = 0;
+   uint16_t u16_TimeDivision = 0;
+   uint32_t u32_MaxGapTicks = 0;
+   double f64_ScaleTicksToMs = 0.0;
+   T_midi_table_decoder t_Decoder = { nullptr, nullptr, 0 };
+   T_midi_table_note t_Read = { 0, 0, 0 };      //current note event (not yet stripped)
+   T_midi_table_note t_Next = { 0, 0, 0 };      //subsequent note event
+   T_midi_table_note t_Kept = { 0, 0, 0 };      //last note event, that remains after stripping (signal not yet known)
+   T_midi_table_signal t_Signal = { 0, 0 };     //last signal (not yet passed, may be extended)
+   uint32_t u32_Carry = 0;
+   int32_t s32_HasNext = 0;
+   int32_t s32_HasKept = 0;
+   int32_t s32_Signal = 0;
+
+   //------------------------------------------------------------//
+   // header and track chunk (midi.c)                            //
+   //------------------------------------------------------------//
+   if ((ou32_FileSize1By < 14) || (opu8_File[0] != 'M') || (opu8_File[1] != 'T') || (opu8_File[2] != 'h') || (opu8_File[3] != 'd') ||
+       (ou32_Track >= (((uint32_t)opu8_File[10] << 8) | opu8_File[11])))
+   {
+      return -1;
+   }
+   u16_TimeDivision = (uint16_t)((opu8_File[12] << 8) | opu8_File[13]);
+   pu8_Track = &opu8_File[14];
+   for (uint32_t u32_Track = 0; u32_Track <= ou32_Track; ++u32_Track)
+   {
+      if ((pu8_FileEnd - pu8_Track) < 8)
+      {
+         return -1;
+      }
+      u32_ChunkSize = midi_table_get_u32(&pu8_Track[4]);
+      pu8_Track = &pu8_Track[8];
+      if (u32_ChunkSize > (uint32_t)(pu8_FileEnd - pu8_Track))
+      {
+         return -1;
+      }
+      if (u32_Track < ou32_Track)
+      {
+         pu8_Track = &pu8_Track[u32_ChunkSize];
+      }
+   }
+   t_Decoder.pu8_Chunk = pu8_Track;
+   t_Decoder.pu8_ChunkEnd = &pu8_Track[u32_ChunkSize];
+
+   //------------------------------------------------------------//
+   // time scale (sound_get_ms_per_tick, main.c)                 //
+   //------------------------------------------------------------//
+   if (u16_TimeDivision <= 0x7FFFu)
+   {
+      f64_ScaleTicksToMs = 500.0 / u16_TimeDivision;
+      u32_MaxGapTicks = u16_TimeDivision / 32u;
+   }
+   else
+   {
+      f64_ScaleTicksToMs = (1000.0 / ((u16_TimeDivision & 0x7F00u) >> 8)) / (u16_TimeDivision & 0x00FFu);
+      u32_MaxGapTicks = ((u16_TimeDivision & 0x00FFu) * ((u16_TimeDivision & 0x7F00u) >> 8)) / 64u;
+   }
+   if (os32_MaxGapTicks >= 0)
+   {
+      u32_MaxGapTicks = (uint32_t)os32_MaxGapTicks;
+   }
+
+   //------------------------------------------------------------//
+   // strip redundant note events and generate signals           //
+   //------------------------------------------------------------//
+   //each note event is decided with one note event look-ahead (midi_event_strip_redundant_note_events),
+   //each remaining note event becomes a signal, once the subsequent remaining note event is known (sound_get_signal_sequence)
+   s32_HasNext = t_Decoder.next(t_Next);
+   while (s32_HasNext != 0)
+   {
+      t_Read = t_Next;
+      t_Read.u32_DeltaTime += u32_Carry;
+      u32_Carry = 0;
+      s32_HasNext = t_Decoder.next(t_Next);
+      if (s32_HasNext != 0)
+      {
+         //zero length segment; note off, immediately followed by note on
+         if ((t_Next.u32_DeltaTime == 0) ||
+             ((t_Read.u8_OnOff == 0) && (t_Next.u8_OnOff != 0) && (t_Next.u32_DeltaTime <= u32_MaxGapTicks)))
+         {
+            u32_Carry = t_Read.u32_DeltaTime;
+            continue;
+         }
+      }
+
+      //keep event -> signal of the previous kept event
+      if ((s32_HasKept != 0) && (t_Read.u32_DeltaTime != 0))
+      {
+         const double f64_Duration1ms = t_Read.u32_DeltaTime * f64_ScaleTicksToMs;
+         const uint16_t u16_Duration1ms = (uint16_t)(int32_t)f64_Duration1ms;
+         const uint16_t u16_Frequency1Hz = ((t_Kept.u8_OnOff != 0) ? gau16_MidiTableFrequency[t_Kept.u8_Note] : 0);
+
+         if ((s32_Signal > 0) && (u16_Frequency1Hz == t_Signal.u16_Frequency1Hz))
+         {
+            t_Signal.u16_Duration1ms = (uint16_t)(t_Signal.u16_Duration1ms + u16_Duration1ms);
+         }
+         else
+         {
+            if (s32_Signal > 0)
+            {
+               ot_Sink(s32_Signal - 1, t_Signal);
+            }
+            t_Signal.u16_Duration1ms = u16_Duration1ms;
+            t_Signal.u16_Frequency1Hz = u16_Frequency1Hz;
+            ++s32_Signal;
+         }
+      }
+      t_Kept = t_Read;
+      s32_HasKept = 1;
+   }
+   if (t_Decoder.s32_Error != 0)
+   {
+      return -1;
+   }
+   if (s32_Signal > 0)
+   {
+      ot_Sink(s32_Signal - 1, t_Signal);
+   }
+   return s32_Signal;
+}
+
+
+//number of signals of the table (including the terminating signal), 0 on invalid data
+template <size_t N>
+constexpr size_t midi_table_get_length(const uint8_t (&oau8_File)[N], const uint32_t ou32_Track = 0, const int32_t os32_MaxGapTicks = -1)
+{
+   const int32_t s32_Signals = midi_table_get_signals(oau8_File, N, ou32_Track, os32_MaxGapTicks, [](int32_t, const T_midi_table_signal &) {});
+
+   return ((s32_Signals < 0) ? 0 : ((size_t)s32_Signals + 1));
+}
+
+
+//signal table of the track, terminated by { 0, 0 }; ou32_Length: see midi_table_get_length
+template <size_t ou32_Length, size_t N>
+constexpr std::array<T_midi_table_signal, ou32_Length> midi_table_convert(const uint8_t (&oau8_File)[N], const uint32_t ou32_Track = 0,
+                                                                          const int32_t os32_MaxGapTicks = -1)
+{
+   static_assert(ou32_Length > 0, "invalid midi file");
+   std::array<T_midi_table_signal, ou32_Length> at_Table = {};
+
+   midi_table_get_signals(oau8_File, N, ou32_Track, os32_MaxGapTicks,
+                          [&at_Table](int32_t os32_Signal, const T_midi_table_signal & ot_Signal)
+                          {
+                             if ((size_t)os32_Signal < (ou32_Length - 1))
+                             {
+                                at_Table[(size_t)os32_Signal] = ot_Signal;
+                             }
+                          });
+   return at_Table;
+}
+
+
+#endif
+
+
@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     motif_player.c
+   \brief    Target side player for motif compressed sound sequences
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "motif_player.h"
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+void motif_player_init(T_motif_player * const opt_Player, const uint16_t * const opu16_Pool, const uint16_t * const opu16_PlayList)
+{
+   opt_Player->pu16_Pool = opu16_Pool;
+   opt_Player->pu16_PlayList = opu16_PlayList;
+   opt_Player->u16_Signal = 0;
+   opt_Player->u16_Loop = 0;
+}
+
+
+/*
+   Get next signal of the sequence.
+   Returns 1 if a signal was provided, 0 at the end of the sequence.
+*/
+int32_t motif_player_next(T_motif_player * const opt_Player, uint16_t * const opu16_Duration1ms, uint16_t * const opu16_Frequency1Hz)
+{
+   const uint16_t * pu16_Entry = opt_Player->pu16_PlayList;
+   const uint16_t * pu16_Signal;
+
+   //end of play list
+   if (pu16_Entry[1] == 0)
+   {
+      return 0;
+   }
+
+   //current signal: pool[offset + signal]
+   pu16_Signal = &opt_Player->pu16_Pool[2u * ((uint32_t)pu16_Entry[0] + opt_Player->u16_Signal)];
+   *opu16_Duration1ms = pu16_Signal[0];
+   *opu16_Frequency1Hz = pu16_Signal[1];
+
+   //advance: signal -> loop -> entry
+   if (++opt_Player->u16_Signal >= pu16_Entry[1])
+   {
+      opt_Player->u16_Signal = 0;
+      if (++opt_Player->u16_Loop >= pu16_Entry[2])
+      {
+         opt_Player->u16_Loop = 0;
+         opt_Player->pu16_PlayList = &pu16_Entry[3];
+      }
+   }
+   return 1;
+}
@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     motif_player.h
+   \brief    Target side player for motif compressed sound sequences
+
+   Walks through the play list (gau16_SoundPlayList) and the motif pool
+   (gau16_SoundMotifPool), as generated by midi_parser -f motif.
+   Does not allocate any memory; the state is held in a caller supplied struct.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _MOTIF_PLAYER_H
+#define _MOTIF_PLAYER_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   const uint16_t * pu16_Pool;      //2x16-bit: duration [1ms], frequency [1Hz]
+   const uint16_t * pu16_PlayList;  //3x16-bit: offset, length, loops; terminated by 0, 0, 0
+   uint16_t u16_Signal;             //signal within current entry
+   uint16_t u16_Loop;               //loop of current entry
+} T_motif_player;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+extern void motif_player_init(T_motif_player * const opt_Player, const uint16_t * const opu16_Pool, const uint16_t * const opu16_PlayList);
+extern int32_t motif_player_next(T_motif_player * const opt_Player, uint16_t * const opu16_Duration1ms, uint16_t * const opu16_Frequency1Hz);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
+
+
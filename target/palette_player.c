@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     palette_player.c
+   \brief    Target side player for palette encoded sound sequences
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "palette_player.h"
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+void palette_player_init(T_palette_player * const opt_Player, const uint16_t * const opu16_Frequency, const uint16_t * const opu16_Duration,
+                         const uint16_t * const opu16_Grid, const uint8_t ou8_BytesPerSignal, const uint8_t * const opu8_Sequence)
+{
+   opt_Player->pu16_Frequency = opu16_Frequency;
+   opt_Player->pu16_Duration = opu16_Duration;
+   opt_Player->pu8_Sequence = opu8_Sequence;
+   opt_Player->u8_BytesPerSignal = ou8_BytesPerSignal;
+   opt_Player->u16_GridNumerator = opu16_Grid[0];
+   opt_Player->u16_GridDenominator = opu16_Grid[1];
+   opt_Player->u32_Time = 0;
+   opt_Player->u32_Time1ms = 0;
+}
+
+
+/*
+   Get next signal of the sequence.
+   Returns 1 if a signal was provided, 0 at the end of the sequence.
+*/
+int32_t palette_player_next(T_palette_player * const opt_Player, uint16_t * const opu16_Duration1ms, uint16_t * const opu16_Frequency1Hz)
+{
+   uint8_t u8_Frequency;
+   uint8_t u8_Duration;
+   uint16_t u16_Duration;
+   uint32_t u32_End1ms;
+
+   //palette indices
+   if (opt_Player->u8_BytesPerSignal == 1)
+   {
+      u8_Frequency = opt_Player->pu8_Sequence[0] >> 4;
+      u8_Duration = opt_Player->pu8_Sequence[0] & 0x0Fu;
+   }
+   else
+   {
+      u8_Frequency = opt_Player->pu8_Sequence[0];
+      u8_Duration = opt_Player->pu8_Sequence[1];
+   }
+
+   //end of sequence
+   u16_Duration = opt_Player->pu16_Duration[u8_Duration];
+   if (u16_Duration == 0)
+   {
+      return 0;
+   }
+   opt_Player->pu8_Sequence = &opt_Player->pu8_Sequence[opt_Player->u8_BytesPerSignal];
+
+   //grid -> 1ms (rounded end of signal)
+   opt_Player->u32_Time += (uint32_t)u16_Duration * opt_Player->u16_GridNumerator;
+   u32_End1ms = (opt_Player->u32_Time + (opt_Player->u16_GridDenominator / 2)) / opt_Player->u16_GridDenominator;
+   *opu16_Duration1ms = (uint16_t)(u32_End1ms - opt_Player->u32_Time1ms);
+   *opu16_Frequency1Hz = opt_Player->pu16_Frequency[u8_Frequency];
+   opt_Player->u32_Time1ms = u32_End1ms;
+   return 1;
+}
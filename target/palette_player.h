@@ -0,0 +1,58 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     palette_player.h
+   \brief    Target side player for palette encoded sound sequences
+
+   Looks up the frequency and duration of each signal of gau8_SoundPaletteSequence
+   in gau16_SoundPaletteFrequency and gau16_SoundPaletteDuration, as generated by
+   midi_parser -f palette. Durations are converted from grid units to milliseconds
+   based on the absolute time, so rounding errors don't accumulate.
+   Does not allocate any memory; the state is held in a caller supplied struct.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _PALETTE_PLAYER_H
+#define _PALETTE_PLAYER_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   const uint16_t * pu16_Frequency; //frequency palette [1Hz]
+   const uint16_t * pu16_Duration;  //duration palette [grid]
+   const uint8_t * pu8_Sequence;    //next signal
+   uint8_t u8_BytesPerSignal;       //1: frequency index (high nibble), duration index (low nibble); 2: frequency index, duration index
+   uint16_t u16_GridNumerator;      //grid [1ms] = numerator / denominator
+   uint16_t u16_GridDenominator;
+   uint32_t u32_Time;               //end of the previous signal [1ms / denominator]
+   uint32_t u32_Time1ms;            //end of the previous signal [1ms]
+} T_palette_player;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//opu16_Grid: numerator, denominator (gau16_SoundPaletteGrid); opu8_Sequence: first signal of the song (gau32_SoundPaletteIndex)
+extern void palette_player_init(T_palette_player * const opt_Player, const uint16_t * const opu16_Frequency, const uint16_t * const opu16_Duration,
+                                const uint16_t * const opu16_Grid, const uint8_t ou8_BytesPerSignal, const uint8_t * const opu8_Sequence);
+extern int32_t palette_player_next(T_palette_player * const opt_Player, uint16_t * const opu16_Duration1ms, uint16_t * const opu16_Frequency1Hz);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     tick_player.c
+   \brief    Target side player for tick based sound sequences
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+#include "tick_player.h"
+
+/* -- Defines ------------------------------------------------------------- */
+
+/* -- Types --------------------------------------------------------------- */
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Module Global Variables --------------------------------------------- */
+
+/* -- Module Global Function Prototypes ----------------------------------- */
+static void update_periods_per_tick(T_tick_player * const opt_Player);
+static void apply_tempo_changes(T_tick_player * const opt_Player);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+void tick_player_init(T_tick_player * const opt_Player, const uint16_t * const opu16_Sequence, const uint32_t * const opu32_TempoMap,
+                      const uint16_t ou16_TicksPerBeat, const uint32_t ou32_Clock1Hz, const uint16_t ou16_Speed)
+{
+   opt_Player->pu16_Sequence = opu16_Sequence;
+   opt_Player->pu32_TempoMap = opu32_TempoMap;
+   opt_Player->u32_Tick = 0;
+   opt_Player->u32_TempoUs = 500000u;
+   opt_Player->u16_TicksPerBeat = ((ou16_TicksPerBeat > 0) ? ou16_TicksPerBeat : 1u);
+   opt_Player->u16_Speed = ((ou16_Speed > 0) ? ou16_Speed : 1u);
+   opt_Player->u32_Clock1Hz = ou32_Clock1Hz;
+   opt_Player->u32_Fraction = 0;
+   apply_tempo_changes(opt_Player);
+   update_periods_per_tick(opt_Player);
+}
+
+
+void tick_player_set_speed(T_tick_player * const opt_Player, const uint16_t ou16_Speed)
+{
+   opt_Player->u16_Speed = ((ou16_Speed > 0) ? ou16_Speed : 1u);
+   update_periods_per_tick(opt_Player);
+}
+
+
+/*
+   Get next signal of the sequence, its duration in timer periods.
+   A signal, that spans a tempo change, is split into the parts before and after it.
+   Returns 1 if a signal was provided, 0 at the end of the sequence.
+*/
+int32_t tick_player_next(T_tick_player * const opt_Player, uint32_t * const opu32_Periods, uint16_t * const opu16_Frequency1Hz)
+{
+   uint32_t u32_Ticks;
+   uint64_t u64_Periods;
+
+   //end of sequence
+   u32_Ticks = opt_Player->pu16_Sequence[0];
+   if (u32_Ticks == 0)
+   {
+      return 0;
+   }
+   *opu16_Frequency1Hz = opt_Player->pu16_Sequence[1];
+   opt_Player->pu16_Sequence = &opt_Player->pu16_Sequence[2];
+
+   //ticks -> periods (16.16), piecewise between the tempo changes
+   u64_Periods = opt_Player->u32_Fraction;
+   while (u32_Ticks > 0)
+   {
+      uint32_t u32_Part;
+
+      u32_Part = u32_Ticks;
+      if ((opt_Player->pu32_TempoMap[0] - opt_Player->u32_Tick) < u32_Part)
+      {
+         u32_Part = opt_Player->pu32_TempoMap[0] - opt_Player->u32_Tick;
+      }
+      u64_Periods += (uint64_t)u32_Part * opt_Player->u64_PeriodsPerTick;
+      opt_Player->u32_Tick += u32_Part;
+      u32_Ticks -= u32_Part;
+      if (opt_Player->u32_Tick == opt_Player->pu32_TempoMap[0])
+      {
+         apply_tempo_changes(opt_Player);
+         update_periods_per_tick(opt_Player);
+      }
+   }
+   *opu32_Periods = (uint32_t)(u64_Periods >> 16);
+   opt_Player->u32_Fraction = (uint32_t)(u64_Periods & 0xFFFFu);
+   return 1;
+}
+
+
+
+
+
+
+
+
+
+/*
+   periods per tick = clock [1Hz] * tempo [1us] * 256 / (1000000 * ticks per beat * speed), 16.16 fixed point:
+   (clock * tempo / (ticks per beat * speed)) * 2^24 / 1000000 = (...) * 2^18 / 15625
+*/
+static void update_periods_per_tick(T_tick_player * const opt_Player)
+{
+   const uint64_t u64_Product = (uint64_t)opt_Player->u32_Clock1Hz * opt_Player->u32_TempoUs;
+   const uint32_t u32_Divisor = (uint32_t)opt_Player->u16_TicksPerBeat * opt_Player->u16_Speed;
+   uint64_t u64_Periods;
+
+   //quotient and remainder separately (slow timer clocks)
+   u64_Periods = ((u64_Product / u32_Divisor) << 18) + (((u64_Product % u32_Divisor) << 18) / u32_Divisor);
+   opt_Player->u64_PeriodsPerTick = u64_Periods / 15625u;
+}
+
+
+//tempo changes at the current time (the map ends with tick 0xFFFFFFFF)
+static void apply_tempo_changes(T_tick_player * const opt_Player)
+{
+   while ((opt_Player->pu32_TempoMap[0] != 0xFFFFFFFFu) && (opt_Player->pu32_TempoMap[0] <= opt_Player->u32_Tick))
+   {
+      opt_Player->u32_TempoUs = opt_Player->pu32_TempoMap[1];
+      opt_Player->pu32_TempoMap = &opt_Player->pu32_TempoMap[2];
+   }
+}
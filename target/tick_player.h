@@ -0,0 +1,64 @@
+//-----------------------------------------------------------------------------
+/*!
+   \file     tick_player.h
+   \brief    Target side player for tick based sound sequences
+
+   Converts the durations of gau16_SoundTickSequence (ticks) into periods of a
+   timer, based on gau32_SoundTempoMap and gu16_SoundTicksPerBeat, as generated
+   by midi_parser -f ticks. The speed factor may be changed at any time, so one
+   table serves every tempo. Fixed point only; a division is required only when
+   the tempo or the speed changes. The fraction of a period is carried to the
+   next signal, so the timing doesn't drift.
+   Does not allocate any memory; the state is held in a caller supplied struct.
+
+   \author   M.Heiss
+*/
+//-----------------------------------------------------------------------------
+
+#ifndef _TICK_PLAYER_H
+#define _TICK_PLAYER_H
+
+/* -- Includes ------------------------------------------------------------ */
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- Defines ------------------------------------------------------------- */
+#define TICK_PLAYER_SPEED_NORMAL    (256u)  //speed factor 1.0 (8.8 fixed point)
+
+/* -- Types --------------------------------------------------------------- */
+typedef struct
+{
+   const uint16_t * pu16_Sequence;  //next signal (duration [ticks], frequency [1Hz])
+   const uint32_t * pu32_TempoMap;  //next tempo change (tick, tempo [1us per beat])
+   uint32_t u32_Tick;               //start of the next signal [ticks]
+   uint32_t u32_TempoUs;            //current tempo [1us per beat]
+   uint16_t u16_TicksPerBeat;
+   uint16_t u16_Speed;              //8.8 fixed point, TICK_PLAYER_SPEED_NORMAL: original tempo
+   uint32_t u32_Clock1Hz;           //timer clock
+   uint64_t u64_PeriodsPerTick;     //16.16 fixed point (current tempo and speed)
+   uint32_t u32_Fraction;           //fraction of a period, carried to the next signal (16 bit)
+} T_tick_player;
+
+
+/* -- Global Variables ---------------------------------------------------- */
+
+/* -- Function Prototypes ------------------------------------------------- */
+//ou32_Clock1Hz: clock of the timer, that measures the durations (e.g. 1000000 -> periods of 1us)
+extern void tick_player_init(T_tick_player * const opt_Player, const uint16_t * const opu16_Sequence, const uint32_t * const opu32_TempoMap,
+                             const uint16_t ou16_TicksPerBeat, const uint32_t ou32_Clock1Hz, const uint16_t ou16_Speed);
+//e.g. 512: twice as fast, 128: half speed (0 is treated as 1)
+extern void tick_player_set_speed(T_tick_player * const opt_Player, const uint16_t ou16_Speed);
+extern int32_t tick_player_next(T_tick_player * const opt_Player, uint32_t * const opu32_Periods, uint16_t * const opu16_Frequency1Hz);
+
+/* -- Implementation ------------------------------------------------------ */
+
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif